@@ -0,0 +1,252 @@
+#!/usr/bin/env python
+
+'''Generate C++ source with the runtime data tables compiled in.
+
+The data files are parsed here with the same rules as the loaders in
+scatteringfactordata.cpp and BVParametersTable.cpp.  The output defines
+the record arrays declared in diffpy/srreal/embeddeddata.hpp.
+
+usage: embeddeddata.py RUNTIMEDIR [OUTPUT.cpp]
+'''
+
+import os
+import re
+
+DATAFILES = ('f0_WaasKirf.dat', 'ionlist.dat', 'nsftable.dat',
+             'bvparm2011sel.cif')
+
+HEADER = '''\
+// Generated by site_scons/embeddeddata.py from the runtime data files.
+// Do not edit.
+
+#include <diffpy/srreal/embeddeddata.hpp>
+
+namespace diffpy {
+namespace srreal {
+namespace embeddeddata {
+'''
+
+FOOTER = '''
+}   // namespace embeddeddata
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
+'''
+
+# leading number parsed the same way as by the C++ stream extraction
+_rx_float = re.compile(r'[+-]?(\d+\.?\d*|\.\d+)([eE][+-]?\d+)?')
+
+
+class DataFormatError(ValueError):
+    pass
+
+
+def _error(filename, lineno, detail):
+    emsg = 'Invalid data format in {} line {}.\n{}'.format(
+        filename, lineno, detail)
+    return DataFormatError(emsg)
+
+
+def _lines(filename):
+    with open(filename) as fp:
+        for lineno, line in enumerate(fp, 1):
+            yield lineno, line.rstrip('\r\n')
+
+
+def readWKFormulas(filename):
+    'Return list of (symbol, a[5], c, b[5]) from f0_WaasKirf.dat.'
+    rv = []
+    seen = set()
+    symbol = None
+    lines = _lines(filename)
+    for lineno, line in lines:
+        words = line.split()
+        if not words:
+            continue
+        if words[0].startswith('#S'):
+            if len(words) < 3:
+                raise _error(filename, lineno,
+                             'Expected at least 3 columns of data.')
+            symbol = words[2]
+            continue
+        if not words[0].startswith('#L'):
+            continue
+        if not symbol:
+            raise _error(filename, lineno,
+                         'Missing "#S" line with atom symbol definition.')
+        lineno, line = next(lines)
+        values = [float(w) for w in line.split()]
+        if len(values) != 11:
+            raise _error(filename, lineno, 'Expected 11 values.')
+        if symbol in seen:
+            raise _error(filename, lineno,
+                         'Duplicate atom symbol "{}".'.format(symbol))
+        seen.add(symbol)
+        rv.append((symbol, values[:5], values[5], values[6:]))
+        symbol = None
+    return rv
+
+
+def readElectronNumbers(filename):
+    'Return list of (symbol, electron number) from ionlist.dat.'
+    table = {}
+    rv = []
+
+    def insert(smbl, value):
+        if smbl not in table:
+            table[smbl] = value
+            rv.append((smbl, value))
+        return
+
+    for lineno, line in _lines(filename):
+        words = line.split()
+        if not words or words[0].startswith('#'):
+            continue
+        if len(words) < 2:
+            raise _error(filename, lineno,
+                         'Expected at least 2 columns for (symbol, Z).')
+        element = words[0]
+        z = int(words[1])
+        insert(element, z)
+        for v in map(int, words[2:]):
+            smbl = '{}{}{}'.format(element, abs(v), '+' if v > 0 else '-')
+            insert(smbl, z - v)
+    return rv
+
+
+def readNeutronBC(filename):
+    'Return list of (symbol, b_c) from nsftable.dat.'
+    table = {}
+    rv = []
+
+    def insert(smbl, value):
+        table[smbl] = value
+        rv.append((smbl, value))
+        return
+
+    for lineno, line in _lines(filename):
+        words = line.split(',') if line else []
+        # std::getline does not produce the last empty field
+        if words and not words[-1]:
+            words.pop()
+        if not words or words[0].startswith('#'):
+            continue
+        if len(words) != 11:
+            raise _error(filename, lineno,
+                         'Expected 11 comma-separated items.')
+        if not words[3]:
+            continue
+        smbl = words[0].lstrip('0123456789-')
+        if not smbl:
+            raise _error(filename, lineno, 'Missing or invalid atom symbol.')
+        p1 = smbl.rfind('-')
+        if p1 >= 0:
+            smbl = smbl[p1 + 1:] + '-' + smbl[:p1]
+        mx = _rx_float.match(words[3])
+        if not mx:
+            raise _error(filename, lineno, 'Invalid b_c value.')
+        bc = float(mx.group())
+        if smbl in table:
+            emsg = 'Duplicate atom symbol "{}".'.format(smbl)
+            raise _error(filename, lineno, emsg)
+        insert(smbl, bc)
+        # elements are not explicitly included if there is just one
+        # isotope or if all isotopes are unstable
+        p2 = smbl.find('-')
+        if p2 >= 0:
+            el = smbl[p2 + 1:]
+            chlf = words[1]
+            addel = (chlf == '100') or (
+                el not in table and chlf.endswith('Y'))
+            if addel:
+                if el in table:
+                    emsg = 'Duplicate element entry for "{}".'.format(el)
+                    raise _error(filename, lineno, emsg)
+                insert(el, bc)
+    # define aliases for neutron, deuterium and tritium
+    insert('n', table['1-n'])
+    insert('D', table['2-H'])
+    insert('T', table['3-H'])
+    return rv
+
+
+def readBVParams(filename):
+    'Return list of (atom0, valence0, atom1, valence1, Ro, B, ref_id).'
+    rv = []
+    lines = _lines(filename)
+    # skip the header up to _valence_param_B and then up to an empty line
+    for lineno, line in lines:
+        words = line.split()
+        if words and words[0] == '_valence_param_B':
+            break
+    for lineno, line in lines:
+        if not line.split():
+            break
+    for lineno, line in lines:
+        words = line.split()
+        if not words or words[0].startswith('#'):
+            continue
+        try:
+            a0, v0, a1, v1, ro, b, ref = words[:7]
+            rv.append((a0, int(v0), a1, int(v1), float(ro), float(b), ref))
+        except ValueError:
+            raise _error(filename, lineno, 'Cannot parse cif line.')
+    return rv
+
+
+def _cstr(s):
+    return '"' + s.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+
+def _cdbl(x):
+    return repr(float(x))
+
+
+def _carray(rtype, name, rows):
+    body = ',\n'.join('    {' + ', '.join(r) + '}' for r in rows)
+    lines = [
+        '',
+        'extern constexpr {} {}[] = {{'.format(rtype, name),
+        body,
+        '};',
+        '',
+        'extern constexpr size_t {0}_size = sizeof({0}) / sizeof({0}[0]);'
+        .format(name),
+    ]
+    return '\n'.join(lines) + '\n'
+
+
+def generateCode(runtimedir):
+    'Return C++ source with the tables parsed from runtimedir.'
+    p = lambda f: os.path.join(runtimedir, f)
+    wkrows = [(_cstr(s), '{' + ', '.join(map(_cdbl, a)) + '}', _cdbl(c),
+               '{' + ', '.join(map(_cdbl, b)) + '}')
+              for s, a, c, b in readWKFormulas(p('f0_WaasKirf.dat'))]
+    enrows = [(_cstr(s), str(n))
+              for s, n in readElectronNumbers(p('ionlist.dat'))]
+    bcrows = [(_cstr(s), _cdbl(bc))
+              for s, bc in readNeutronBC(p('nsftable.dat'))]
+    bvrows = [(_cstr(a0), str(v0), _cstr(a1), str(v1),
+               _cdbl(ro), _cdbl(b), _cstr(ref))
+              for a0, v0, a1, v1, ro, b, ref in
+              readBVParams(p('bvparm2011sel.cif'))]
+    code = HEADER
+    code += _carray('WKFormulaRecord', 'wkformulas', wkrows)
+    code += _carray('ElectronNumberRecord', 'electronnumbers', enrows)
+    code += _carray('NeutronBCRecord', 'neutronbc', bcrows)
+    code += _carray('BVParamRecord', 'bvparams', bvrows)
+    code += FOOTER
+    return code
+
+
+if __name__ == '__main__':
+    import sys
+    if len(sys.argv) not in (2, 3):
+        sys.exit(__doc__.split('\n\n')[-1])
+    code = generateCode(sys.argv[1])
+    if len(sys.argv) == 2:
+        sys.stdout.write(code)
+    else:
+        with open(sys.argv[2], 'w') as fp:
+            fp.write(code)
@@ -0,0 +1,293 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class BenchmarkHarness -- registry and driver of the benchmark workloads
+*     with the JSON output of the timing results.
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <sys/utsname.h>
+
+#include <diffpy/version.hpp>
+
+#include "bench_harness.hpp"
+
+using namespace std;
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+const int DEFAULT_REPEATS = 5;
+const long DEFAULT_MAX_ATOMS = 1000;
+
+
+double wallclock()
+{
+    using namespace std::chrono;
+    duration<double> t = steady_clock::now().time_since_epoch();
+    return t.count();
+}
+
+
+string jsonString(const string& s)
+{
+    ostringstream rv;
+    rv << '"';
+    for (string::const_iterator c = s.begin(); c != s.end(); ++c)
+    {
+        switch (*c)
+        {
+            case '"':   rv << "\\\""; break;
+            case '\\':  rv << "\\\\"; break;
+            case '\n':  rv << "\\n"; break;
+            case '\t':  rv << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(*c) < 0x20)
+                {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", int(*c));
+                    rv << buf;
+                }
+                else  rv << *c;
+        }
+    }
+    rv << '"';
+    return rv.str();
+}
+
+
+string cpuModel()
+{
+    ifstream fp("/proc/cpuinfo");
+    string line;
+    while (getline(fp, line))
+    {
+        if (line.compare(0, 10, "model name"))  continue;
+        string::size_type pos = line.find(':');
+        if (pos == string::npos)  break;
+        pos = line.find_first_not_of(" \t", pos + 1);
+        return (pos == string::npos) ? string() : line.substr(pos);
+    }
+    return string();
+}
+
+
+string utcDate()
+{
+    time_t now = time(NULL);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    return buf;
+}
+
+}   // namespace
+
+// class BenchmarkOptions ----------------------------------------------------
+
+BenchmarkOptions::BenchmarkOptions() :
+    repeats(DEFAULT_REPEATS),
+    maxatoms(DEFAULT_MAX_ATOMS),
+    listonly(false)
+{ }
+
+// class BenchmarkResult -----------------------------------------------------
+
+double BenchmarkResult::minTime() const
+{
+    return times.empty() ? 0.0 : *min_element(times.begin(), times.end());
+}
+
+
+double BenchmarkResult::medianTime() const
+{
+    if (times.empty())  return 0.0;
+    vector<double> t(times);
+    sort(t.begin(), t.end());
+    const size_t n = t.size();
+    double rv = (n % 2) ? t[n / 2] : 0.5 * (t[n / 2 - 1] + t[n / 2]);
+    return rv;
+}
+
+
+double BenchmarkResult::meanTime() const
+{
+    if (times.empty())  return 0.0;
+    double rv = accumulate(times.begin(), times.end(), 0.0) / times.size();
+    return rv;
+}
+
+// class BenchmarkHarness ----------------------------------------------------
+
+void BenchmarkHarness::add(const string& name, long atoms, Setup setup)
+{
+    Entry e = {name, atoms, setup};
+    mentries.push_back(e);
+}
+
+
+void BenchmarkHarness::run(const BenchmarkOptions& opts, ostream& log)
+{
+    mresults.clear();
+    vector<Entry>::const_iterator e = mentries.begin();
+    for (; e != mentries.end(); ++e)
+    {
+        if (!this->isSelected(*e, opts))  continue;
+        if (opts.listonly)
+        {
+            log << e->name << '\n';
+            continue;
+        }
+        log << left << setw(40) << e->name << flush;
+        BenchmarkResult res;
+        res.name = e->name;
+        res.atoms = e->atoms;
+        Workload work = e->setup();
+        // warm up caches and lazily initialized data
+        work();
+        for (int i = 0; i < opts.repeats; ++i)
+        {
+            double t0 = wallclock();
+            work();
+            res.times.push_back(wallclock() - t0);
+        }
+        log << right << setw(12) << scientific << setprecision(3) <<
+            res.minTime() << " s" << endl;
+        mresults.push_back(res);
+    }
+}
+
+
+void BenchmarkHarness::writeJSON(ostream& out) const
+{
+    struct utsname uts;
+    const bool hasuts = (0 == uname(&uts));
+    out << "{\n";
+    out << "  \"date\": " << jsonString(utcDate()) << ",\n";
+    out << "  \"library\": {\n";
+    out << "    \"version\": " <<
+        jsonString(libdiffpy_version_info::version_str) << ",\n";
+    out << "    \"git_sha\": " <<
+        jsonString(libdiffpy_version_info::git_sha) << "\n";
+    out << "  },\n";
+    out << "  \"host\": {\n";
+    out << "    \"system\": " << jsonString(hasuts ? uts.sysname : "") << ",\n";
+    out << "    \"release\": " <<
+        jsonString(hasuts ? uts.release : "") << ",\n";
+    out << "    \"machine\": " <<
+        jsonString(hasuts ? uts.machine : "") << ",\n";
+    out << "    \"hostname\": " <<
+        jsonString(hasuts ? uts.nodename : "") << ",\n";
+    out << "    \"cpu_model\": " << jsonString(cpuModel()) << ",\n";
+    out << "    \"cpu_count\": " << thread::hardware_concurrency() << ",\n";
+    out << "    \"compiler\": " << jsonString(__VERSION__) << "\n";
+    out << "  },\n";
+    out << "  \"benchmarks\": [";
+    out << setprecision(6) << scientific;
+    vector<BenchmarkResult>::const_iterator r = mresults.begin();
+    for (; r != mresults.end(); ++r)
+    {
+        out << ((r == mresults.begin()) ? "\n" : ",\n");
+        out << "    {\"name\": " << jsonString(r->name) <<
+            ", \"atoms\": " << r->atoms <<
+            ", \"repeats\": " << r->times.size() <<
+            ", \"min_s\": " << r->minTime() <<
+            ", \"median_s\": " << r->medianTime() <<
+            ", \"mean_s\": " << r->meanTime() << "}";
+    }
+    out << "\n  ]\n";
+    out << "}\n";
+}
+
+
+const vector<BenchmarkResult>& BenchmarkHarness::results() const
+{
+    return mresults;
+}
+
+
+bool BenchmarkHarness::isSelected(
+        const Entry& e, const BenchmarkOptions& opts) const
+{
+    if (e.atoms > opts.maxatoms)  return false;
+    if (opts.patterns.empty())  return true;
+    vector<string>::const_iterator p = opts.patterns.begin();
+    for (; p != opts.patterns.end(); ++p)
+    {
+        if (e.name.find(*p) != string::npos)  return true;
+    }
+    return false;
+}
+
+// Command line processing ---------------------------------------------------
+
+BenchmarkOptions parseBenchmarkOptions(int argc, char* argv[])
+{
+    BenchmarkOptions opts;
+    for (int i = 1; i < argc; ++i)
+    {
+        const string a = argv[i];
+        const bool hasvalue = (i + 1 < argc);
+        if (a == "--list")  opts.listonly = true;
+        else if (a == "--json" && hasvalue)  opts.jsonpath = argv[++i];
+        else if (a == "--repeat" && hasvalue)  opts.repeats = atoi(argv[++i]);
+        else if (a == "--max-atoms" && hasvalue)
+        {
+            opts.maxatoms = atol(argv[++i]);
+        }
+        else if (a.empty() || a[0] == '-')
+        {
+            string emsg = "Invalid option '" + a + "'.";
+            throw invalid_argument(emsg);
+        }
+        else  opts.patterns.push_back(a);
+    }
+    if (opts.repeats < 1)
+    {
+        const char* emsg = "Number of repeats must be at least 1.";
+        throw invalid_argument(emsg);
+    }
+    return opts;
+}
+
+
+string benchmarkUsage(const string& progname)
+{
+    ostringstream rv;
+    rv <<
+        "usage: " << progname << " [options] [pattern ...]\n"
+        "Run libdiffpy benchmarks with names that contain any pattern.\n"
+        "\n"
+        "Options:\n"
+        "  --json FILE       write results and host information to FILE\n"
+        "  --repeat N        number of timed runs per benchmark [" <<
+        DEFAULT_REPEATS << "]\n"
+        "  --max-atoms N     skip benchmarks with more than N atoms [" <<
+        DEFAULT_MAX_ATOMS << "]\n"
+        "  --list            list the selected benchmarks and exit\n";
+    return rv.str();
+}
+
+// End of file
@@ -0,0 +1,101 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class BenchmarkHarness -- registry and driver of the benchmark workloads
+*     with the JSON output of the timing results.
+*
+* Each benchmark is defined by a setup function, which prepares the input
+* data and returns the workload function to be timed.  The setup time is
+* not included in the results.
+*
+*****************************************************************************/
+
+#ifndef BENCH_HARNESS_HPP_INCLUDED
+#define BENCH_HARNESS_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+
+struct BenchmarkOptions
+{
+    BenchmarkOptions();
+
+    /// fixed-string patterns for selecting benchmarks, all when empty
+    std::vector<std::string> patterns;
+    /// number of timed repetitions of each workload
+    int repeats;
+    /// skip workloads with more atoms than this
+    long maxatoms;
+    /// path to the JSON output file, no output when empty
+    std::string jsonpath;
+    /// only list the selected benchmarks
+    bool listonly;
+};
+
+
+struct BenchmarkResult
+{
+    std::string name;
+    long atoms;
+    std::vector<double> times;
+
+    double minTime() const;
+    double medianTime() const;
+    double meanTime() const;
+};
+
+
+class BenchmarkHarness
+{
+    public:
+
+        typedef std::function<void()> Workload;
+        typedef std::function<Workload()> Setup;
+
+        // methods
+        /// register benchmark of the specified name and number of atoms
+        void add(const std::string& name, long atoms, Setup setup);
+        /// run benchmarks selected by options and report progress to log
+        void run(const BenchmarkOptions& opts, std::ostream& log);
+        /// write results and host information in JSON format
+        void writeJSON(std::ostream& out) const;
+        const std::vector<BenchmarkResult>& results() const;
+
+    private:
+
+        // types
+        struct Entry
+        {
+            std::string name;
+            long atoms;
+            Setup setup;
+        };
+
+        // methods
+        bool isSelected(const Entry& e, const BenchmarkOptions& opts) const;
+
+        // data
+        std::vector<Entry> mentries;
+        std::vector<BenchmarkResult> mresults;
+};
+
+/// parse command line arguments, throw invalid_argument for bad input
+BenchmarkOptions parseBenchmarkOptions(int argc, char* argv[]);
+
+/// usage message for the benchmark program
+std::string benchmarkUsage(const std::string& progname);
+
+#endif  // BENCH_HARNESS_HPP_INCLUDED
@@ -0,0 +1,177 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* Synthetic structures for the benchmarks.
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <boost/make_shared.hpp>
+
+#include <diffpy/srreal/PointsInSphere.hpp>
+
+#include "bench_structures.hpp"
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// fixed seed so that all runs use the same structures
+const unsigned RANDOM_SEED = 20160401;
+/// isotropic displacement parameter for atoms without one
+const double DEFAULT_UISO = 0.005;
+
+bool closerToOrigin(const Atom& a0, const Atom& a1)
+{
+    return R3::norm(a0.xyz_cartn) < R3::norm(a1.xyz_cartn);
+}
+
+}   // namespace
+
+// Structure constructors ----------------------------------------------------
+
+PeriodicStructureAdapterPtr loadBenchmarkCell(const string& tailname)
+{
+    PeriodicStructureAdapterPtr rv =
+        boost::dynamic_pointer_cast<PeriodicStructureAdapter>(
+                loadTestPeriodicStructure(tailname));
+    // use finite peak widths for atoms without displacement parameters
+    PeriodicStructureAdapter::iterator ai = rv->begin();
+    for (; ai != rv->end(); ++ai)
+    {
+        if (ai->uij_cartn != R3::zeromatrix())  continue;
+        ai->uij_cartn = R3::identity();
+        ai->uij_cartn *= DEFAULT_UISO;
+    }
+    return rv;
+}
+
+
+PeriodicStructureAdapterPtr
+makeSupercell(const PeriodicStructureAdapter& cell, int n)
+{
+    const Lattice& L = cell.getLattice();
+    PeriodicStructureAdapterPtr rv =
+        boost::make_shared<PeriodicStructureAdapter>();
+    rv->setLatPar(n * L.a(), n * L.b(), n * L.c(),
+            L.alpha(), L.beta(), L.gamma());
+    rv->reserve(n * n * n * cell.countSites());
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            for (int k = 0; k < n; ++k)
+            {
+                const R3::Vector dxyz = L.cartesian(R3::Vector(i, j, k));
+                PeriodicStructureAdapter::const_iterator ai = cell.begin();
+                for (; ai != cell.end(); ++ai)
+                {
+                    Atom a = *ai;
+                    a.xyz_cartn += dxyz;
+                    rv->append(a);
+                }
+            }
+        }
+    }
+    return rv;
+}
+
+
+AtomicStructureAdapterPtr
+makeNanoparticle(const PeriodicStructureAdapter& cell, long natoms)
+{
+    const Lattice& L = cell.getLattice();
+    const double density = cell.countSites() / L.volume();
+    double radius = cbrt(3.0 * natoms / (4 * M_PI * density));
+    AtomicStructureAdapter::AtomVector atoms;
+    while (long(atoms.size()) < natoms)
+    {
+        atoms.clear();
+        radius *= 1.1;
+        const double rmax = radius + L.ucMaxDiagonalLength();
+        PointsInSphere sph(0.0, rmax, L);
+        for (sph.rewind(); !sph.finished(); sph.next())
+        {
+            const R3::Vector mno(sph.m(), sph.n(), sph.o());
+            const R3::Vector dxyz = L.cartesian(mno);
+            PeriodicStructureAdapter::const_iterator ai = cell.begin();
+            for (; ai != cell.end(); ++ai)
+            {
+                Atom a = *ai;
+                a.xyz_cartn += dxyz;
+                if (R3::norm(a.xyz_cartn) <= radius)  atoms.push_back(a);
+            }
+        }
+    }
+    partial_sort(atoms.begin(), atoms.begin() + natoms, atoms.end(),
+            closerToOrigin);
+    AtomicStructureAdapterPtr rv =
+        boost::make_shared<AtomicStructureAdapter>();
+    rv->assign(atoms.begin(), atoms.begin() + natoms);
+    return rv;
+}
+
+
+CrystalStructureAdapterPtr makeCubicCrystal(long natoms)
+{
+    CrystalStructureAdapterPtr rv =
+        boost::make_shared<CrystalStructureAdapter>();
+    rv->setLatPar(10, 10, 10, 90, 90, 90);
+    // point group m -3 m as signed permutation matrices
+    const int perms[6][3] = {
+        {0, 1, 2}, {1, 2, 0}, {2, 0, 1}, {0, 2, 1}, {2, 1, 0}, {1, 0, 2}};
+    for (int ic = 0; ic < 4; ++ic)
+    {
+        // F centering translations
+        R3::Vector t(0.0, 0.0, 0.0);
+        if (ic)  t = R3::Vector(0.5, 0.5, 0.5);
+        if (ic)  t[ic - 1] = 0.0;
+        for (int ip = 0; ip < 6; ++ip)
+        {
+            for (int signs = 0; signs < 8; ++signs)
+            {
+                R3::Matrix R = R3::zeromatrix();
+                for (int i = 0; i < R3::Ndim; ++i)
+                {
+                    R(i, perms[ip][i]) = (signs & (1 << i)) ? -1 : 1;
+                }
+                rv->addSymOp(R, t);
+            }
+        }
+    }
+    mt19937 rng(RANDOM_SEED);
+    uniform_real_distribution<double> xyzdist(0.0, 1.0);
+    Atom a;
+    a.atomtype = "Ni";
+    a.uij_cartn = R3::identity();
+    a.uij_cartn *= DEFAULT_UISO;
+    for (long i = 0; i < natoms; ++i)
+    {
+        const double x = xyzdist(rng);
+        const double y = xyzdist(rng);
+        const double z = xyzdist(rng);
+        a.xyz_cartn = R3::Vector(x, y, z);
+        rv->toCartesian(a);
+        rv->append(a);
+    }
+    return rv;
+}
+
+// End of file
@@ -0,0 +1,42 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* Synthetic structures for the benchmarks.
+*
+*****************************************************************************/
+
+#ifndef BENCH_STRUCTURES_HPP_INCLUDED
+#define BENCH_STRUCTURES_HPP_INCLUDED
+
+#include <diffpy/srreal/PeriodicStructureAdapter.hpp>
+#include <diffpy/srreal/CrystalStructureAdapter.hpp>
+
+/// periodic unit cell loaded from the test data directory
+diffpy::srreal::PeriodicStructureAdapterPtr
+    loadBenchmarkCell(const std::string& tailname);
+
+/// periodic supercell with n x n x n copies of the unit cell
+diffpy::srreal::PeriodicStructureAdapterPtr
+    makeSupercell(const diffpy::srreal::PeriodicStructureAdapter& cell, int n);
+
+/// spherical cluster of natoms atoms nearest to the origin of the cell
+diffpy::srreal::AtomicStructureAdapterPtr
+    makeNanoparticle(const diffpy::srreal::PeriodicStructureAdapter& cell,
+            long natoms);
+
+/// cubic F m -3 m crystal with natoms atoms at random general positions
+diffpy::srreal::CrystalStructureAdapterPtr
+    makeCubicCrystal(long natoms);
+
+#endif  // BENCH_STRUCTURES_HPP_INCLUDED
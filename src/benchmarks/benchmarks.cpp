@@ -0,0 +1,321 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* Benchmark program for the main libdiffpy workloads.
+*
+* Benchmark names are formatted as "workload/structure[-natoms]".  Use
+* the --max-atoms option to include the large synthetic structures.
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <boost/make_shared.hpp>
+
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/srreal/DebyePDFCalculator.hpp>
+#include <diffpy/srreal/BondCalculator.hpp>
+#include <diffpy/srreal/BVSCalculator.hpp>
+#include <diffpy/srreal/OverlapCalculator.hpp>
+#include <diffpy/srreal/ConstantRadiiTable.hpp>
+#include <diffpy/srreal/PDFUtils.hpp>
+
+#include "bench_harness.hpp"
+#include "bench_structures.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+// Local Constants and Helpers -----------------------------------------------
+
+namespace {
+
+typedef BenchmarkHarness::Workload Workload;
+
+/// unit cells of the test data structures
+const char* TEST_CELLS[] = {
+    "Ni", "CaTiO3", "alpha_K2Bi8Se13", "PbScW25TiO3", NULL};
+
+/// sizes of the synthetic structures
+const long SYNTHETIC_SIZES[] = {1000, 10000, 100000, 1000000, 0};
+
+/// number of the single-atom updates per PQEvaluatorOptimized workload
+const int OPTIMIZED_UPDATES = 10;
+
+
+string sizedName(const string& prefix, long natoms)
+{
+    ostringstream rv;
+    rv << prefix << '-' << natoms;
+    return rv.str();
+}
+
+
+/// supercell edge in unit cells for about natoms atoms
+int supercellSize(const PeriodicStructureAdapter& cell, long natoms)
+{
+    double n = cbrt(double(natoms) / cell.countSites());
+    return max(1, int(round(n)));
+}
+
+
+/// full evaluation of calc for the structure
+template <class T>
+Workload evalWorkload(boost::shared_ptr<T> calc, StructureAdapterPtr stru)
+{
+    // OPTIMIZED evaluator would skip all work for an unchanged structure
+    calc->setEvaluatorType(BASIC);
+    return [calc, stru]() { calc->eval(stru); };
+}
+
+
+boost::shared_ptr<PDFCalculator> makePDFCalculator()
+{
+    boost::shared_ptr<PDFCalculator> pc =
+        boost::make_shared<PDFCalculator>();
+    pc->setRmax(20.0);
+    pc->setQmax(25.0);
+    return pc;
+}
+
+
+boost::shared_ptr<DebyePDFCalculator> makeDebyePDFCalculator(double rmax)
+{
+    boost::shared_ptr<DebyePDFCalculator> pc =
+        boost::make_shared<DebyePDFCalculator>();
+    pc->setRmax(rmax);
+    pc->setQmax(25.0);
+    return pc;
+}
+
+
+boost::shared_ptr<BVSCalculator> makeBVSCalculator()
+{
+    boost::shared_ptr<BVSCalculator> bvc =
+        boost::make_shared<BVSCalculator>();
+    BVParametersTablePtr bvtb = bvc->getBVParamTable();
+    bvtb->setAtomValence("Ca", +2);
+    bvtb->setAtomValence("Ti", +4);
+    bvtb->setAtomValence("O", -2);
+    return bvc;
+}
+
+
+boost::shared_ptr<OverlapCalculator> makeOverlapCalculator()
+{
+    boost::shared_ptr<OverlapCalculator> olc =
+        boost::make_shared<OverlapCalculator>();
+    boost::shared_ptr<ConstantRadiiTable> radii =
+        boost::make_shared<ConstantRadiiTable>();
+    radii->setDefault(1.4);
+    olc->setAtomRadiiTable(radii);
+    return olc;
+}
+
+// Benchmark definitions -----------------------------------------------------
+
+void addTestStructureBenchmarks(BenchmarkHarness& bh)
+{
+    for (const char** nm = TEST_CELLS; *nm; ++nm)
+    {
+        const string name = *nm;
+        const string path = name + ".stru";
+        long natoms = loadBenchmarkCell(path)->countSites();
+        bh.add("pdf/" + name, natoms, [path]() {
+                return evalWorkload(makePDFCalculator(),
+                        loadBenchmarkCell(path));
+                });
+        bh.add("debyepdf/" + name, natoms, [path]() {
+                return evalWorkload(makeDebyePDFCalculator(10.0),
+                        loadBenchmarkCell(path));
+                });
+        bh.add("bonds/" + name, natoms, [path]() {
+                boost::shared_ptr<BondCalculator> bc =
+                    boost::make_shared<BondCalculator>();
+                bc->setRmax(5.0);
+                return evalWorkload(bc, loadBenchmarkCell(path));
+                });
+        bh.add("overlap/" + name, natoms, [path]() {
+                return evalWorkload(makeOverlapCalculator(),
+                        loadBenchmarkCell(path));
+                });
+    }
+    const long ctoatoms = loadBenchmarkCell("CaTiO3.stru")->countSites();
+    bh.add("bvs/CaTiO3", ctoatoms, []() {
+            return evalWorkload(makeBVSCalculator(),
+                    loadBenchmarkCell("CaTiO3.stru"));
+            });
+}
+
+
+void addSyntheticBenchmarks(BenchmarkHarness& bh)
+{
+    for (const long* sz = SYNTHETIC_SIZES; *sz; ++sz)
+    {
+        const long natoms = *sz;
+        bh.add(sizedName("pdf/supercell-Ni", natoms), natoms, [natoms]() {
+                PeriodicStructureAdapterPtr ni =
+                    loadBenchmarkCell("Ni.stru");
+                StructureAdapterPtr stru =
+                    makeSupercell(*ni, supercellSize(*ni, natoms));
+                return evalWorkload(makePDFCalculator(), stru);
+                });
+        bh.add(sizedName("pdf/nanoparticle-Ni", natoms), natoms,
+                [natoms]() {
+                StructureAdapterPtr stru =
+                    makeNanoparticle(*loadBenchmarkCell("Ni.stru"), natoms);
+                return evalWorkload(makePDFCalculator(), stru);
+                });
+        bh.add(sizedName("debyepdf/nanoparticle-Ni", natoms), natoms,
+                [natoms]() {
+                AtomicStructureAdapterPtr stru =
+                    makeNanoparticle(*loadBenchmarkCell("Ni.stru"), natoms);
+                // include all pairs in the Debye summation
+                const Atom& aout = stru->at(natoms - 1);
+                const double rmax = 2 * R3::norm(aout.xyz_cartn) + 1.0;
+                return evalWorkload(makeDebyePDFCalculator(rmax), stru);
+                });
+        bh.add(sizedName("bonds/nanoparticle-Ni", natoms), natoms,
+                [natoms]() {
+                boost::shared_ptr<BondCalculator> bc =
+                    boost::make_shared<BondCalculator>();
+                bc->setRmax(3.0);
+                StructureAdapterPtr stru =
+                    makeNanoparticle(*loadBenchmarkCell("Ni.stru"), natoms);
+                return evalWorkload(bc, stru);
+                });
+        bh.add(sizedName("bvs/supercell-CaTiO3", natoms), natoms,
+                [natoms]() {
+                PeriodicStructureAdapterPtr cto =
+                    loadBenchmarkCell("CaTiO3.stru");
+                StructureAdapterPtr stru =
+                    makeSupercell(*cto, supercellSize(*cto, natoms));
+                return evalWorkload(makeBVSCalculator(), stru);
+                });
+        bh.add(sizedName("overlap/nanoparticle-Ni", natoms), natoms,
+                [natoms]() {
+                StructureAdapterPtr stru =
+                    makeNanoparticle(*loadBenchmarkCell("Ni.stru"), natoms);
+                return evalWorkload(makeOverlapCalculator(), stru);
+                });
+        bh.add(sizedName("pqoptimized/nanoparticle-Ni", natoms), natoms,
+                [natoms]() {
+                AtomicStructureAdapterPtr stru =
+                    makeNanoparticle(*loadBenchmarkCell("Ni.stru"), natoms);
+                boost::shared_ptr<PDFCalculator> pc = makePDFCalculator();
+                pc->setEvaluatorType(OPTIMIZED);
+                pc->eval(stru);
+                // shift one atom at a time back and forth
+                auto counter = boost::make_shared<long>(0);
+                return [pc, stru, counter]() {
+                    for (int i = 0; i < OPTIMIZED_UPDATES; ++i, ++*counter)
+                    {
+                        const int idx = *counter % stru->countSites();
+                        const double dx = (*counter % 2) ? -0.01 : 0.01;
+                        stru->at(idx).xyz_cartn[0] += dx;
+                        pc->eval(stru);
+                    }
+                };
+                });
+        bh.add(sizedName("symmetry/cubic", natoms / 100), natoms,
+                [natoms]() {
+                CrystalStructureAdapterPtr stru =
+                    makeCubicCrystal(natoms / 100);
+                // lattice change forces expansion of all sites
+                auto counter = boost::make_shared<long>(0);
+                return [stru, counter]() {
+                    const double a = (++*counter % 2) ? 10.001 : 10.0;
+                    stru->setLatPar(a, a, a, 90, 90, 90);
+                    stru->updateSymmetryPositions();
+                };
+                });
+        bh.add(sizedName("symmetrysite/cubic", natoms / 100), natoms,
+                [natoms]() {
+                CrystalStructureAdapterPtr stru =
+                    makeCubicCrystal(natoms / 100);
+                // expand one moved site of the cached structure
+                auto counter = boost::make_shared<long>(0);
+                return [stru, counter]() {
+                    const int idx = *counter % stru->countSites();
+                    const double dx = (++*counter % 2) ? 0.01 : -0.01;
+                    stru->at(idx).xyz_cartn[0] += dx;
+                    stru->updateSymmetryPositions();
+                };
+                });
+    }
+    // fftgtof for arrays of 2**12, 2**16 and 2**20 points
+    for (int p = 12; p <= 20; p += 4)
+    {
+        const int npts = 1 << p;
+        bh.add(sizedName("fftgtof/points", npts), 0, [npts]() {
+                const double rstep = 0.01;
+                QuantityType g(npts);
+                for (int i = 0; i < npts; ++i)
+                {
+                    const double r = i * rstep;
+                    g[i] = sin(2 * r) * exp(-0.01 * r);
+                }
+                return [g, rstep]() { fftgtof(g, rstep); };
+                });
+    }
+}
+
+}   // namespace
+
+// Main program --------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const string progname = argv[0];
+    BenchmarkOptions opts;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const string a = argv[i];
+            if (a == "-h" || a == "--help")
+            {
+                cout << benchmarkUsage(progname);
+                return 0;
+            }
+        }
+        opts = parseBenchmarkOptions(argc, argv);
+    }
+    catch (const invalid_argument& e)
+    {
+        cerr << e.what() << '\n' << benchmarkUsage(progname);
+        return 2;
+    }
+    BenchmarkHarness bh;
+    addTestStructureBenchmarks(bh);
+    addSyntheticBenchmarks(bh);
+    bh.run(opts, cout);
+    if (!opts.jsonpath.empty() && !opts.listonly)
+    {
+        ofstream out(opts.jsonpath.c_str());
+        bh.writeJSON(out);
+        if (!out)
+        {
+            cerr << "Cannot write " << opts.jsonpath << '\n';
+            return 1;
+        }
+        cout << "Results written to " << opts.jsonpath << '\n';
+    }
+    return 0;
+}
+
+// End of file
@@ -20,12 +20,46 @@
 *
 *****************************************************************************/
 
+#include <atomic>
+#include <limits>
+
 #include <diffpy/EventTicker.hpp>
 #include <diffpy/serialization.ipp>
 
 namespace diffpy {
 namespace eventticker {
 
+namespace {
+
+typedef long long TickCount;
+
+/// number of ticks a thread reserves from the global counter at once
+const TickCount TICK_BATCH_SIZE = 256;
+
+/// the last tick reserved by any thread, kept on its own cache line
+alignas(64) std::atomic<TickCount> greserved(0);
+
+/// ticks reserved by this thread in the (next, end] range
+struct TickBatch {
+    TickCount next;
+    TickCount end;
+};
+
+thread_local TickBatch gbatch = {0, 0};
+
+/// tickers are serialized as zeros when set
+thread_local bool gvaluesmasked = false;
+
+/// convert the tick count to the serialized (long, long) value
+EventTicker::value_type tickValue(TickCount n)
+{
+    const TickCount lmax = std::numeric_limits<long>::max();
+    EventTicker::value_type rv(long(n / lmax), long(n % lmax));
+    return rv;
+}
+
+}   // namespace
+
 //////////////////////////////////////////////////////////////////////////////
 // class EventTicker
 //////////////////////////////////////////////////////////////////////////////
@@ -39,13 +73,15 @@ EventTicker::EventTicker() : mtick(0, 0)
 
 void EventTicker::click()
 {
-    ++gtick.second;
-    if (0 >= gtick.second)
+    TickBatch& tb = gbatch;
+    // make new reservation if the batch is used up or if there is
+    // a newer batch in another thread
+    if (tb.next == tb.end || greserved.load() != tb.end)
     {
-        ++gtick.first;
-        gtick.second = 0;
+        tb.next = greserved.fetch_add(TICK_BATCH_SIZE);
+        tb.end = tb.next + TICK_BATCH_SIZE;
     }
-    mtick = gtick;
+    mtick = tickValue(++tb.next);
 }
 
 
@@ -97,9 +133,33 @@ bool EventTicker::operator!=(const EventTicker& other) const
 }
 
 
-// Static Global Data --------------------------------------------------------
+// Private Static Methods ----------------------------------------------------
+
+EventTicker::value_type EventTicker::globalTick()
+{
+    return tickValue(greserved.load());
+}
+
+
+bool EventTicker::valuesMasked()
+{
+    return gvaluesmasked;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// class EventTicker::MaskedValues
+//////////////////////////////////////////////////////////////////////////////
+
+EventTicker::MaskedValues::MaskedValues() : mprevious(gvaluesmasked)
+{
+    gvaluesmasked = true;
+}
 
-EventTicker::value_type EventTicker::gtick(0, 0);
+
+EventTicker::MaskedValues::~MaskedValues()
+{
+    gvaluesmasked = mprevious;
+}
 
 }   // namespace eventticker
 }   // namespace diffpy
@@ -18,6 +18,11 @@
 * of their dependencies.  The EventTicker class is inspired by the
 * ObjCryst::RefinableObjClock class.
 *
+* The global counter is a lock-free 64-bit atomic.  Threads reserve ticks
+* from it in batches and use a batch only while no other thread made
+* a newer reservation, so that a click is always newer than any click
+* that happened before it in another thread.
+*
 *****************************************************************************/
 
 #ifndef EVENTTICKER_HPP_INCLUDED
@@ -55,10 +60,30 @@ class EventTicker
         bool operator==(const EventTicker&) const;
         bool operator!=(const EventTicker&) const;
 
+        /// Tickers in this thread are serialized as zeros while an instance
+        /// exists.  Archives then compare by the content of the objects.
+        class MaskedValues
+        {
+            public:
+
+                MaskedValues();
+                ~MaskedValues();
+
+            private:
+
+                bool mprevious;
+
+                // non-copyable
+                MaskedValues(const MaskedValues&);
+                MaskedValues& operator=(const MaskedValues&);
+        };
+
     private:
 
-        // global counter
-        static value_type gtick;
+        // current value of the global counter
+        static value_type globalTick();
+        // true within the scope of MaskedValues in this thread
+        static bool valuesMasked();
 
         // data
         value_type mtick;
@@ -68,7 +93,14 @@ class EventTicker
         template<class Archive>
             void save(Archive& ar, const unsigned int version) const
         {
-            ar << mtick << gtick;
+            if (EventTicker::valuesMasked())
+            {
+                const value_type zero(0, 0);
+                ar << zero << zero;
+                return;
+            }
+            value_type ga = EventTicker::globalTick();
+            ar << mtick << ga;
         }
 
         template<class Archive>
@@ -76,10 +108,11 @@ class EventTicker
         {
             value_type ga;
             ar >> mtick >> ga;
-            if (ga > gtick)
+            const value_type gt = EventTicker::globalTick();
+            if (ga > gt)
             {
-                if (ga.first != gtick.first)  mtick.first = mtick.second = 0;
-                else  mtick.second += gtick.second - ga.second;
+                if (ga.first != gt.first)  mtick.first = mtick.second = 0;
+                else  mtick.second += gt.second - ga.second;
             }
         }
 
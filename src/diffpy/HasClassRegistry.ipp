@@ -163,11 +163,9 @@ template <class TBase>
 typename HasClassRegistry<TBase>::RegistryStorage&
 HasClassRegistry<TBase>::getRegistry()
 {
-    static std::unique_ptr<RegistryStorage> the_registry;
-    if (!the_registry.get())
-    {
-        the_registry.reset(new RegistryStorage());
-    }
+    // static initialization is thread safe
+    static std::unique_ptr<RegistryStorage>
+        the_registry(new RegistryStorage());
     return *the_registry;
 }
 
@@ -25,6 +25,10 @@
 # define DIFFPY_HAS_OBJCRYST
 #endif
 
+#if ${DIFFPY_HAS_EMBEDDED_DATA}
+# define DIFFPY_HAS_EMBEDDED_DATA
+#endif
+
 #endif  // FEATURES_HPP_INCLUDED
 
 // vim:ft=cpp:
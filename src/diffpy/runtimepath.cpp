@@ -22,6 +22,7 @@
 #include <cassert>
 #include <sstream>
 #include <stdexcept>
+#include <mutex>
 #include <sys/stat.h>
 #include <dlfcn.h>
 #include <libgen.h>
@@ -65,8 +66,11 @@ void ensureIsDir(const std::string& d)
 }
 
 
-const string& diffpyruntime()
+string diffpyruntime()
 {
+    // the cached paths are shared by all threads
+    static mutex runtime_mutex;
+    lock_guard<mutex> lock(runtime_mutex);
     char fpb[PATH_MAX];
     static string librt;
     static bool did_librt = false;
@@ -18,12 +18,14 @@
 
 #include <cassert>
 #include <fstream>
+#include <sstream>
 
 #include <diffpy/serialization.ipp>
 #include <diffpy/runtimepath.hpp>
 #include <diffpy/validators.hpp>
 #include <diffpy/srreal/AtomUtils.hpp>
 #include <diffpy/srreal/BVParametersTable.hpp>
+#include <diffpy/srreal/embeddeddata.hpp>
 
 using namespace std;
 
@@ -157,42 +159,97 @@ BVParametersTable::getAll() const
     return rv;
 }
 
-// Private Methods -----------------------------------------------------------
+// Local Helpers -------------------------------------------------------------
 
-const BVParametersTable::SetOfBVParam&
-BVParametersTable::getStandardSetOfBVParam() const
+namespace {
+
+/// load the standard bond valence parameters from the runtime data file
+BVParametersTable::SetOfBVParam* loadStandardSetOfBVParam()
 {
     using namespace diffpy::runtimepath;
     using diffpy::validators::ensureFileOK;
-    static unique_ptr<SetOfBVParam> the_set;
-    if (!the_set)
+    typedef BVParametersTable::SetOfBVParam SetOfBVParam;
+    unique_ptr<SetOfBVParam> the_set(new SetOfBVParam);
+    string bvparmfile = datapath("bvparm2011sel.cif");
+    ifstream fp(bvparmfile.c_str());
+    ensureFileOK(bvparmfile, fp);
+    // read the header up to _valence_param_B and then up to an empty line.
+    LineReader lnrd;
+    lnrd.commentmark = '#';
+    while (fp >> lnrd)
     {
-        the_set.reset(new SetOfBVParam);
-        string bvparmfile = datapath("bvparm2011sel.cif");
-        ifstream fp(bvparmfile.c_str());
-        ensureFileOK(bvparmfile, fp);
-        // read the header up to _valence_param_B and then up to an empty line.
-        LineReader lnrd;
-        lnrd.commentmark = '#';
-        while (fp >> lnrd)
-        {
-            if (lnrd.wcount() && lnrd.words[0] == "_valence_param_B")  break;
-        }
-        // skip to an empty line
-        while (fp >> lnrd && !lnrd.isblank())  { }
-        // load data lines skipping the empty or commented entries
-        while (fp >> lnrd)
-        {
-            if (lnrd.isignored())  continue;
-            BVParam bp;
-            bp.setFromCifLine(lnrd.line);
-            assert(!the_set->count(bp));
-            the_set->insert(bp);
-        }
+        if (lnrd.wcount() && lnrd.words[0] == "_valence_param_B")  break;
     }
+    // skip to an empty line
+    while (fp >> lnrd && !lnrd.isblank())  { }
+    // load data lines skipping the empty or commented entries
+    while (fp >> lnrd)
+    {
+        if (lnrd.isignored())  continue;
+        BVParam bp;
+        bp.setFromCifLine(lnrd.line);
+        assert(!the_set->count(bp));
+        the_set->insert(bp);
+    }
+    return the_set.release();
+}
+
+
+/// bond valence parameters compiled into the library
+BVParametersTable::SetOfBVParam* embeddedSetOfBVParam()
+{
+    typedef BVParametersTable::SetOfBVParam SetOfBVParam;
+    unique_ptr<SetOfBVParam> the_set(new SetOfBVParam);
+#ifdef DIFFPY_HAS_EMBEDDED_DATA
+    using embeddeddata::bvparams;
+    for (size_t i = 0; i < embeddeddata::bvparams_size; ++i)
+    {
+        const embeddeddata::BVParamRecord& r = bvparams[i];
+        BVParam bp(r.atom0, r.valence0, r.atom1, r.valence1,
+                r.Ro, r.B, r.ref_id);
+        assert(!the_set->count(bp));
+        the_set->insert(bp);
+    }
+#endif
+    return the_set.release();
+}
+
+}   // namespace
+
+// Private Methods -----------------------------------------------------------
+
+const BVParametersTable::SetOfBVParam&
+BVParametersTable::getStandardSetOfBVParam() const
+{
+    static unique_ptr<SetOfBVParam> the_set(embeddeddata::enabled() ?
+            embeddedSetOfBVParam() : loadStandardSetOfBVParam());
     return *the_set;
 }
 
+// Comparison of the data sources --------------------------------------------
+
+namespace embeddeddata {
+
+TableValues bvParamTable(bool embedded)
+{
+    typedef BVParametersTable::SetOfBVParam SetOfBVParam;
+    unique_ptr<SetOfBVParam> bpset(embedded ?
+            embeddedSetOfBVParam() : loadStandardSetOfBVParam());
+    TableValues rv;
+    for (const BVParam& bp : *bpset)
+    {
+        ostringstream key;
+        key << bp.matom0 << ' ' << bp.mvalence0 << ' ' <<
+            bp.matom1 << ' ' << bp.mvalence1 << ' ' << bp.mref_id;
+        vector<double>& v = rv[key.str()];
+        v.push_back(bp.mRo);
+        v.push_back(bp.mB);
+    }
+    return rv;
+}
+
+}   // namespace embeddeddata
+
 }   // namespace srreal
 }   // namespace diffpy
 
@@ -34,11 +34,14 @@ BaseBondGenerator::BaseBondGenerator(StructureAdapterConstPtr stru) :
     msite_anchor(0),
     mrmin(0.0),
     mrmax(DEFAULT_BONDGENERATOR_RMAX),
+    morbitreduction(false),
     mstructure(stru),
     mr0(R3::zerovector),
     mr1(R3::zerovector),
     mr01(R3::zerovector),
-    mdistance(0.0)
+    mdistance(0.0),
+    mbondsgenerated(0),
+    mbondsrejected(0)
 {
     int cnt = stru->countSites();
     msite_all.resize(cnt);
@@ -127,6 +130,19 @@ void BaseBondGenerator::setRmax(double rmax)
     mrmax = rmax;
 }
 
+
+void BaseBondGenerator::setOrbitReduction(bool flag)
+{
+    if (flag != morbitreduction)  this->setFinishedFlag();
+    morbitreduction = flag;
+}
+
+
+bool BaseBondGenerator::getOrbitReduction() const
+{
+    return morbitreduction;
+}
+
 // data query
 
 const double& BaseBondGenerator::getRmin() const
@@ -197,8 +213,7 @@ const R3::Matrix& BaseBondGenerator::Ucartesian1() const
 
 double BaseBondGenerator::msd() const
 {
-    static R3::Vector s;
-    s = this->r01();
+    const R3::Vector& s = this->r01();
     double msd0 = meanSquareDisplacement(this->Ucartesian0(), s,
             mstructure->siteAnisotropy(this->site0()));
     double msd1 = meanSquareDisplacement(this->Ucartesian1(), s,
@@ -207,6 +222,18 @@ double BaseBondGenerator::msd() const
     return rv;
 }
 
+
+long BaseBondGenerator::countGeneratedBonds() const
+{
+    return mbondsgenerated;
+}
+
+
+long BaseBondGenerator::countRejectedBonds() const
+{
+    return mbondsrejected;
+}
+
 // Protected Methods ---------------------------------------------------------
 
 bool BaseBondGenerator::iterateSymmetry()
@@ -243,10 +270,11 @@ void BaseBondGenerator::updateDistance()
 
 void BaseBondGenerator::advanceWhileInvalid()
 {
-    while (!this->finished() &&
-            (this->bondOutOfRange() || this->atSelfPair()))
+    for (; !this->finished(); this->getNextBond())
     {
-        this->getNextBond();
+        ++mbondsgenerated;
+        if (this->bondOutOfRange())  ++mbondsrejected;
+        else if (!this->atSelfPair())  break;
     }
 }
 
@@ -52,13 +52,18 @@ class BaseBondGenerator
                 SiteIndices::const_iterator last);
         virtual void setRmin(double);
         virtual void setRmax(double);
+        /// allow generation of symmetry-unique bonds only, which are
+        /// weighted by multiplicity().  Suitable only for quantities that
+        /// depend on the bond length and mean square displacement.
+        void setOrbitReduction(bool);
+        bool getOrbitReduction() const;
 
         // get data
         const double& getRmin() const;
         const double& getRmax() const;
         int site0() const;
         int site1() const;
-        int multiplicity() const;
+        virtual int multiplicity() const;
         const R3::Vector& r0() const;
         const R3::Vector& r1() const;
         const double& distance() const;
@@ -66,6 +71,10 @@ class BaseBondGenerator
         virtual const R3::Matrix& Ucartesian0() const;
         virtual const R3::Matrix& Ucartesian1() const;
         double msd() const;
+        /// number of bond candidates visited since construction
+        long countGeneratedBonds() const;
+        /// number of bond candidates outside of the rmin, rmax range
+        long countRejectedBonds() const;
 
     protected:
 
@@ -76,6 +85,7 @@ class BaseBondGenerator
         SiteIndices::const_iterator msite_current;
         double mrmin;
         double mrmax;
+        bool morbitreduction;
         StructureAdapterConstPtr mstructure;
         R3::Vector mr0;
         R3::Vector mr1;
@@ -92,6 +102,10 @@ class BaseBondGenerator
 
     private:
 
+        // data
+        long mbondsgenerated;
+        long mbondsrejected;
+
         // methods
         void advanceWhileInvalid();
         bool bondOutOfRange() const;
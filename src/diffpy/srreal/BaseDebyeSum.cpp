@@ -16,6 +16,7 @@
 *
 *****************************************************************************/
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 #include <stdexcept>
@@ -76,6 +77,10 @@ eventticker::EventTicker& BaseDebyeSum::ticker() const
 
 QuantityType BaseDebyeSum::getF() const
 {
+    eventticker::EventTicker tic = this->ticker();
+    tic.updateFrom(this->valueTicker());
+    const QuantityType* cached = mf_cache.find(0, tic);
+    if (cached)  return *cached;
     QuantityType rv = this->value();
     const double& totocc = mstructure_cache.totaloccupancy;
     const int npts = pdfutils_qmaxSteps(this);
@@ -86,7 +91,7 @@ QuantityType BaseDebyeSum::getF() const
             1.0 / (sfavg * sfavg * totocc);
         rv[kq] *= fscale;
     }
-    return rv;
+    return mf_cache.store(0, rv, tic);
 }
 
 // Q-range methods
@@ -176,7 +181,9 @@ void BaseDebyeSum::addPairContribution(const BaseBondGenerator& bnds,
     const int nqpts = pdfutils_qmaxSteps(this);
     const int smscale = summationscale * bnds.multiplicity();
     const double& sineprec = this->getDebyePrecision();
-    for (int kq = pdfutils_qminSteps(this); kq < nqpts; ++kq)
+    const int kqlo = pdfutils_qminSteps(this);
+    int kq = kqlo;
+    for (; kq < nqpts; ++kq)
     {
         const double q = kq * this->getQstep();
         const double dwscale = exp(-0.5 * pow(dwsigma * q, 2));
@@ -186,6 +193,12 @@ void BaseDebyeSum::addPairContribution(const BaseBondGenerator& bnds,
         if (eps_eq(0.0, sinescale, sineprec))   break;
         mvalue[kq] += sinescale * sin(q * dist);
     }
+    PQStatistics* stats = this->activeStatistics();
+    if (stats && kqlo < nqpts)
+    {
+        stats->qpointsevaluated += kq - kqlo;
+        stats->qpointstruncated += nqpts - kq;
+    }
 }
 
 
@@ -208,6 +221,17 @@ double BaseDebyeSum::sfSiteAtQ(int siteidx, const double& q) const
     return 1.0;
 }
 
+
+QuantityType BaseDebyeSum::sfSiteAtQGrid(int siteidx, int n) const
+{
+    QuantityType rv(n);
+    for (int kq = 0; kq < n; ++kq)
+    {
+        rv[kq] = this->sfSiteAtQ(siteidx, kq * this->getQstep());
+    }
+    return rv;
+}
+
 // Private Methods -----------------------------------------------------------
 
 double BaseDebyeSum::sfSiteAtkQ(int siteidx, int kq) const
@@ -252,13 +276,11 @@ void BaseDebyeSum::cacheStructureData()
         if (tpidx < int(mstructure_cache.sftypeatkq.size()))  continue;
         assert(tpidx == int(mstructure_cache.sftypeatkq.size()));
         // here we need to build a new array
-        mstructure_cache.sftypeatkq.push_back(zeros);
+        mstructure_cache.sftypeatkq.push_back(
+                this->sfSiteAtQGrid(siteidx, nqpts));
         QuantityType& sfarray = mstructure_cache.sftypeatkq.back();
-        for (int kq = pdfutils_qminSteps(this); kq < nqpts; ++kq)
-        {
-            double q = this->getQstep() * kq;
-            sfarray[kq] = this->sfSiteAtQ(siteidx, q);
-        }
+        const int kqlo = min(pdfutils_qminSteps(this), nqpts);
+        fill(sfarray.begin(), sfarray.begin() + kqlo, 0.0);
     }
     assert(cntsites == int(mstructure_cache.typeofsite.size()));
     assert(atomtypeidx.size() == mstructure_cache.sftypeatkq.size());
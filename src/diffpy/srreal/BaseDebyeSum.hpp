@@ -22,6 +22,7 @@
 #include <diffpy/srreal/PairQuantity.hpp>
 #include <diffpy/srreal/PeakWidthModel.hpp>
 #include <diffpy/srreal/PDFUtils.hpp>
+#include <diffpy/srreal/QuantityCache.hpp>
 
 namespace diffpy {
 namespace srreal {
@@ -70,6 +71,8 @@ class BaseDebyeSum :
 
         // own methods
         virtual double sfSiteAtQ(int, const double& Q) const;
+        /// site scattering factors at Q = kq * qstep for kq in [0, n)
+        virtual QuantityType sfSiteAtQGrid(int, int n) const;
 
     private:
 
@@ -92,6 +95,8 @@ class BaseDebyeSum :
             double totaloccupancy;
         } mstructure_cache;
         QuantityType mdbsumstash;
+        // cache of the normalized F values
+        mutable QuantityCache mf_cache;
 
         // serialization
         friend class boost::serialization::access;
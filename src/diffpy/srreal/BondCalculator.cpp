@@ -95,6 +95,62 @@ class BondOp {
         }
 
 
+        // flat array layout of BondEntry for the shared memory merge
+        static const int ENTRY_SIZE = 6;
+
+        static double* toArray(
+                const BondCalculator::BondDataStorage& bonds, double* pdata)
+        {
+            BondCalculator::BondDataStorage::const_iterator bi;
+            for (bi = bonds.begin(); bi != bonds.end(); ++bi)
+            {
+                *(pdata++) = bi->distance;
+                *(pdata++) = bi->site0;
+                *(pdata++) = bi->site1;
+                *(pdata++) = bi->direction0;
+                *(pdata++) = bi->direction1;
+                *(pdata++) = bi->direction2;
+            }
+            return pdata;
+        }
+
+
+        static BondCalculator::BondEntry entryAt(const double* pdata)
+        {
+            BondCalculator::BondEntry rv;
+            rv.distance = pdata[0];
+            rv.site0 = int(pdata[1]);
+            rv.site1 = int(pdata[2]);
+            rv.direction0 = pdata[3];
+            rv.direction1 = pdata[4];
+            rv.direction2 = pdata[5];
+            return rv;
+        }
+
+
+        // merge sorted flat array entries from the back, same as bmerge
+        static void bmergeArray(
+                BondCalculator::BondDataStorage& dstbonds,
+                const double* pdata, size_t cnt)
+        {
+            size_t i = dstbonds.size();
+            size_t k = i + cnt;
+            dstbonds.resize(k);
+            const double* pj = pdata + ENTRY_SIZE * cnt;
+            while (pj != pdata)
+            {
+                BondCalculator::BondEntry be = entryAt(pj - ENTRY_SIZE);
+                if (i && !compare(dstbonds[i - 1], be))
+                {
+                    dstbonds[--k] = dstbonds[--i];
+                    continue;
+                }
+                dstbonds[--k] = be;
+                pj -= ENTRY_SIZE;
+            }
+        }
+
+
 };  // class BondOp
 
 // Constructor ---------------------------------------------------------------
@@ -211,9 +267,8 @@ void BondCalculator::addPairContribution(
         int summationscale)
 {
     assert(summationscale == +1 || summationscale == -1);
-    static R3::Vector ru01;
     const R3::Vector& r01 = bnds.r01();
-    ru01 = r01 / bnds.distance();
+    const R3::Vector ru01 = r01 / bnds.distance();
     if (!(this->checkConeFilters(ru01)))  return;
     BondDataStorage& bes = (summationscale > 0) ? maddbonds : mpopbonds;
     bes.push_back(BondOp::entryFrom(bnds));
@@ -231,6 +286,39 @@ void BondCalculator::executeParallelMerge(const std::string& pdata)
 }
 
 
+size_t BondCalculator::countParallelArray() const
+{
+    // array starts with the counts of popped and added bonds
+    size_t rv = 2 + BondOp::ENTRY_SIZE * (mpopbonds.size() + maddbonds.size());
+    return rv;
+}
+
+
+void BondCalculator::copyParallelArray(double* pdata) const
+{
+    *(pdata++) = mpopbonds.size();
+    *(pdata++) = maddbonds.size();
+    pdata = BondOp::toArray(mpopbonds, pdata);
+    BondOp::toArray(maddbonds, pdata);
+}
+
+
+void BondCalculator::executeParallelArrayMerge(const double* pdata, size_t n)
+{
+    const size_t npop = (n >= 2) ? size_t(pdata[0]) : 0;
+    const size_t nadd = (n >= 2) ? size_t(pdata[1]) : 0;
+    if (n < 2 || n != 2 + BondOp::ENTRY_SIZE * (npop + nadd))
+    {
+        throw invalid_argument("Invalid size of the merged bonds array.");
+    }
+    // entries are sorted by finishValue in the worker
+    pdata += 2;
+    BondOp::bmergeArray(mpopbonds, pdata, npop);
+    pdata += BondOp::ENTRY_SIZE * npop;
+    BondOp::bmergeArray(maddbonds, pdata, nadd);
+}
+
+
 void BondCalculator::finishValue()
 {
     // filter-out entries marked for removal
@@ -51,6 +51,9 @@ class BondCalculator : public PairQuantity
         virtual void resetValue();
         virtual void addPairContribution(const BaseBondGenerator&, int);
         virtual void executeParallelMerge(const std::string& pdata);
+        virtual size_t countParallelArray() const;
+        virtual void copyParallelArray(double* pdata) const;
+        virtual void executeParallelArrayMerge(const double* pdata, size_t n);
         virtual void finishValue();
 
         // support for PQEvaluatorOptimized
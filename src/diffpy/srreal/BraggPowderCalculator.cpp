@@ -0,0 +1,410 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class BraggPowderCalculator -- powder-averaged Bragg intensities and F(Q)
+*     of a periodic structure evaluated from the structure factors of
+*     reflections in the Q-range.
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <diffpy/srreal/BraggPowderCalculator.hpp>
+#include <diffpy/srreal/CrystalStructureAdapter.hpp>
+#include <diffpy/srreal/PointsInSphere.hpp>
+#include <diffpy/srreal/PDFUtils.hpp>
+#include <diffpy/validators.hpp>
+#include <diffpy/serialization.ipp>
+
+using namespace std;
+using namespace diffpy::validators;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// Default FWHM of the Bragg peaks in 1/A.
+const double DEFAULT_BRAGG_PEAKWIDTH = 0.05;
+
+/// Peak tails are neglected where the Gaussian drops below this fraction
+/// of its maximum.
+const double BRAGG_PEAK_PRECISION = 1e-6;
+
+/// Integer key of the Miller indices for the set of visited reflections.
+inline long long hklKey(int h, int k, int l)
+{
+    const long long offset = 1 << 20;
+    return ((h + offset) << 42) + ((k + offset) << 21) + (l + offset);
+}
+
+
+const PeriodicStructureAdapter* periodicStructure(
+        const StructureAdapterPtr& stru)
+{
+    const PeriodicStructureAdapter* rv =
+        dynamic_cast<const PeriodicStructureAdapter*>(stru.get());
+    if (!rv && stru->countSites())
+    {
+        const char* emsg =
+            "BraggPowderCalculator requires periodic structure.";
+        throw invalid_argument(emsg);
+    }
+    return rv;
+}
+
+}   // namespace
+
+// Constructor ---------------------------------------------------------------
+
+BraggPowderCalculator::BraggPowderCalculator() :
+    mqmin(0.0),
+    mqmax(DEFAULT_QGRID_QMAX),
+    mqstep(DEFAULT_QGRID_QSTEP),
+    mpeakwidth(DEFAULT_BRAGG_PEAKWIDTH)
+{
+    // default configuration
+    this->setScatteringFactorTableByType("xray");
+    // structure factors are evaluated in finishValue, the pair loop is idle
+    this->setEvaluatorType(BASIC);
+    this->setStructure(mstructure);
+    // attributes
+    this->registerDoubleAttribute("qmin", this,
+            &BraggPowderCalculator::getQmin, &BraggPowderCalculator::setQmin);
+    this->registerDoubleAttribute("qmax", this,
+            &BraggPowderCalculator::getQmax, &BraggPowderCalculator::setQmax);
+    this->registerDoubleAttribute("qstep", this,
+            &BraggPowderCalculator::getQstep,
+            &BraggPowderCalculator::setQstep);
+    this->registerDoubleAttribute("peakwidth", this,
+            &BraggPowderCalculator::getPeakWidth,
+            &BraggPowderCalculator::setPeakWidth);
+}
+
+// Public Methods ------------------------------------------------------------
+
+// PairQuantity overloads
+
+eventticker::EventTicker& BraggPowderCalculator::ticker() const
+{
+    mticker.updateFrom(this->ScatteringFactorTableOwner::ticker());
+    return mticker;
+}
+
+// results
+
+QuantityType BraggPowderCalculator::getIntensity() const
+{
+    return this->value();
+}
+
+
+QuantityType BraggPowderCalculator::getF() const
+{
+    QuantityType rv = this->value();
+    CellAtomVector atoms;
+    vector<string> atomtypes;
+    this->cacheCellAtoms(atoms, atomtypes);
+    const double totocc = mstructure->totalOccupancy();
+    const ScatteringFactorTablePtr& sftable = this->getScatteringFactorTable();
+    vector<double> sftype(atomtypes.size());
+    const int npts = min(int(rv.size()), pdfutils_qmaxSteps(this));
+    for (int kq = pdfutils_qminSteps(this); kq < npts; ++kq)
+    {
+        const double q = kq * this->getQstep();
+        for (size_t i = 0; i < atomtypes.size(); ++i)
+        {
+            sftype[i] = sftable->lookup(atomtypes[i], q);
+        }
+        double sfsum = 0.0;
+        double sfselfsum = 0.0;
+        CellAtomVector::const_iterator ai = atoms.begin();
+        for (; ai != atoms.end(); ++ai)
+        {
+            const double sfa = ai->occupancy * sftype[ai->typeidx];
+            sfsum += sfa;
+            sfselfsum += sfa * sfa * exp(-q * q * ai->uiso);
+        }
+        const double sfavg = (totocc == 0.0) ? 0.0 : sfsum / totocc;
+        rv[kq] = (sfavg == 0.0) ? 0.0 :
+            q * (rv[kq] - sfselfsum / totocc) / (sfavg * sfavg);
+    }
+    return rv;
+}
+
+// Q-range methods
+
+QuantityType BraggPowderCalculator::getQgrid() const
+{
+    return pdfutils_getQgrid(this);
+}
+
+// Q-range configuration
+
+void BraggPowderCalculator::setQmin(double qmin)
+{
+    ensureNonNegative("Qmin", qmin);
+    if (mqmin != qmin)  mticker.click();
+    mqmin = qmin;
+}
+
+
+const double& BraggPowderCalculator::getQmin() const
+{
+    return mqmin;
+}
+
+
+void BraggPowderCalculator::setQmax(double qmax)
+{
+    ensureNonNegative("Qmax", qmax);
+    if (mqmax != qmax)  mticker.click();
+    mqmax = qmax;
+}
+
+
+const double& BraggPowderCalculator::getQmax() const
+{
+    return mqmax;
+}
+
+
+void BraggPowderCalculator::setQstep(double qstep)
+{
+    ensureEpsilonPositive("Qstep", qstep);
+    if (mqstep != qstep)  mticker.click();
+    mqstep = qstep;
+}
+
+
+const double& BraggPowderCalculator::getQstep() const
+{
+    return mqstep;
+}
+
+
+void BraggPowderCalculator::setPeakWidth(double fwhm)
+{
+    ensureNonNegative("peakwidth", fwhm);
+    if (mpeakwidth != fwhm)  mticker.click();
+    mpeakwidth = fwhm;
+}
+
+
+const double& BraggPowderCalculator::getPeakWidth() const
+{
+    return mpeakwidth;
+}
+
+// Protected Methods ---------------------------------------------------------
+
+// PairQuantity overloads
+
+void BraggPowderCalculator::resetValue()
+{
+    this->resizeValue(pdfutils_qmaxSteps(this));
+    this->PairQuantity::resetValue();
+}
+
+
+void BraggPowderCalculator::configureBondGenerator(
+        BaseBondGenerator& bnds) const
+{
+    bnds.setRmin(0.0);
+    bnds.setRmax(0.0);
+}
+
+
+void BraggPowderCalculator::finishValue()
+{
+    // always evaluated from scratch, which is also correct after
+    // a merge of parallel results
+    this->resizeValue(pdfutils_qmaxSteps(this));
+    fill(mvalue.begin(), mvalue.end(), 0.0);
+    const PeriodicStructureAdapter* pstru = periodicStructure(mstructure);
+    if (!pstru)  return;
+    CellAtomVector atoms;
+    vector<string> atomtypes;
+    this->cacheCellAtoms(atoms, atomtypes);
+    const double totocc = mstructure->totalOccupancy();
+    if (atoms.empty() || totocc == 0.0)  return;
+    const Lattice& L = pstru->getLattice();
+    const R3::PODMatrix recbase = R3::toPOD(L.recbase());
+    const double wscale = 2 * M_PI * M_PI / (L.volume() * totocc);
+    const vector<R3::Matrix> rotations = this->uniqueRotations();
+    const ScatteringFactorTablePtr& sftable = this->getScatteringFactorTable();
+    vector<double> sftype(atomtypes.size());
+    // include reflections with tails reaching to the Q-range
+    const double fwhmtosigma = 1.0 / (2 * sqrt(2 * M_LN2));
+    const double qext = fwhmtosigma * this->getPeakWidth() *
+        sqrt(-2 * log(BRAGG_PEAK_PRECISION));
+    const double qlo = max(0.0, this->getQmin() - qext);
+    const double qhi = this->getQmax() + qext;
+    unordered_set<long long> visited;
+    ReflectionsInQminQmax refl(qlo, qhi, L);
+    for (refl.rewind(); !refl.finished(); refl.next())
+    {
+        const int* hkl = refl.hkl();
+        if (!hkl[0] && !hkl[1] && !hkl[2])  continue;
+        if (visited.count(hklKey(hkl[0], hkl[1], hkl[2])))  continue;
+        // mark all equivalent reflections including the Friedel pairs
+        int multiplicity = 0;
+        vector<R3::Matrix>::const_iterator Ri = rotations.begin();
+        for (; Ri != rotations.end(); ++Ri)
+        {
+            int hr[R3::Ndim];
+            for (int j = 0; j < R3::Ndim; ++j)
+            {
+                double hj = 0.0;
+                for (int i = 0; i < R3::Ndim; ++i)  hj += hkl[i] * (*Ri)(i, j);
+                hr[j] = int(round(hj));
+            }
+            multiplicity += visited.insert(hklKey(hr[0], hr[1], hr[2])).second;
+            multiplicity += visited.insert(
+                    hklKey(-hr[0], -hr[1], -hr[2])).second;
+        }
+        const R3::PODVector h = R3::podvector(hkl[0], hkl[1], hkl[2]);
+        const R3::PODVector G = 2 * M_PI * R3::mxvecproduct(recbase, h);
+        const double q = sqrt(R3::dot(G, G));
+        for (size_t i = 0; i < atomtypes.size(); ++i)
+        {
+            sftype[i] = sftable->lookup(atomtypes[i], q);
+        }
+        double fre = 0.0;
+        double fim = 0.0;
+        CellAtomVector::const_iterator ai = atoms.begin();
+        for (; ai != atoms.end(); ++ai)
+        {
+            const double phase = 2 * M_PI * R3::dot(h, ai->xyz);
+            const double sfa = ai->occupancy * sftype[ai->typeidx] *
+                exp(-0.5 * R3::quadform(ai->uij, G));
+            fre += sfa * cos(phase);
+            fim += sfa * sin(phase);
+        }
+        const double weight =
+            wscale * multiplicity * (fre * fre + fim * fim) / (q * q);
+        this->addPeak(q, weight);
+    }
+    // clear contributions below Qmin
+    const int kqlo = min(pdfutils_qminSteps(this), int(mvalue.size()));
+    fill(mvalue.begin(), mvalue.begin() + kqlo, 0.0);
+}
+
+// Private Methods -----------------------------------------------------------
+
+void BraggPowderCalculator::cacheCellAtoms(CellAtomVector& atoms,
+        vector<string>& atomtypes) const
+{
+    atoms.clear();
+    atomtypes.clear();
+    const PeriodicStructureAdapter* pstru = periodicStructure(mstructure);
+    if (!pstru)  return;
+    const CrystalStructureAdapter* cstru =
+        dynamic_cast<const CrystalStructureAdapter*>(pstru);
+    const Lattice& L = pstru->getLattice();
+    unordered_map<string, int> typeindex;
+    auto appendatom = [&](const Atom& a) {
+        CellAtom ca;
+        ca.xyz = R3::toPOD(L.fractional(a.xyz_cartn));
+        ca.uij = R3::toPOD(a.uij_cartn);
+        const R3::Matrix& U = a.uij_cartn;
+        ca.uiso = (U(0, 0) + U(1, 1) + U(2, 2)) / 3.0;
+        ca.occupancy = a.occupancy;
+        auto tpi = typeindex.insert(make_pair(a.atomtype, typeindex.size()));
+        if (tpi.second)  atomtypes.push_back(a.atomtype);
+        ca.typeidx = tpi.first->second;
+        atoms.push_back(ca);
+    };
+    const int cntsites = pstru->countSites();
+    for (int i = 0; i < cntsites; ++i)
+    {
+        if (!cstru)
+        {
+            appendatom(pstru->at(i));
+            continue;
+        }
+        const CrystalStructureAdapter::AtomVector& eqatoms =
+            cstru->getEquivalentAtoms(i);
+        for (const Atom& a : eqatoms)  appendatom(a);
+    }
+}
+
+
+vector<R3::Matrix> BraggPowderCalculator::uniqueRotations() const
+{
+    vector<R3::Matrix> rv(1, R3::identity());
+    const CrystalStructureAdapter* cstru =
+        dynamic_cast<const CrystalStructureAdapter*>(mstructure.get());
+    const int nops = cstru ? cstru->countSymOps() : 0;
+    // rotations from centering or glide operations repeat
+    set< vector<int> > visited;
+    for (int n = -1; n < nops; ++n)
+    {
+        const R3::Matrix& R = (n < 0) ? rv.front() : cstru->getSymOp(n).R;
+        vector<int> key;
+        for (int i = 0; i < R3::Ndim; ++i)
+        {
+            for (int j = 0; j < R3::Ndim; ++j)  key.push_back(round(R(i, j)));
+        }
+        if (visited.insert(key).second && n >= 0)  rv.push_back(R);
+    }
+    return rv;
+}
+
+
+void BraggPowderCalculator::addPeak(double q, double weight)
+{
+    const double dq = this->getQstep();
+    const double sigma = this->getPeakWidth() / (2 * sqrt(2 * M_LN2));
+    const double qext = sigma * sqrt(-2 * log(BRAGG_PEAK_PRECISION));
+    int klo = int(ceil((q - qext) / dq));
+    int khi = int(floor((q + qext) / dq));
+    // narrow peak contributes to the nearest grid point
+    if (klo > khi || sigma == 0.0)  klo = khi = int(round(q / dq));
+    // normalize the sampled profile so that it sums to the weight
+    QuantityType profile(khi - klo + 1, 1.0);
+    double profilesum = 1.0;
+    if (khi > klo)
+    {
+        profilesum = 0.0;
+        for (int kq = klo; kq <= khi; ++kq)
+        {
+            const double x = (kq * dq - q) / sigma;
+            profile[kq - klo] = exp(-0.5 * x * x);
+            profilesum += profile[kq - klo];
+        }
+    }
+    const double scale = weight / (profilesum * dq);
+    const int npts = mvalue.size();
+    for (int kq = max(0, klo); kq <= khi && kq < npts; ++kq)
+    {
+        mvalue[kq] += scale * profile[kq - klo];
+    }
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+DIFFPY_INSTANTIATE_SERIALIZATION(diffpy::srreal::BraggPowderCalculator)
+BOOST_CLASS_EXPORT_IMPLEMENT(diffpy::srreal::BraggPowderCalculator)
+
+// End of file
@@ -0,0 +1,143 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class BraggPowderCalculator -- powder-averaged Bragg intensities and F(Q)
+*     of a periodic structure evaluated from the structure factors of
+*     reflections in the Q-range.
+*
+*****************************************************************************/
+
+// The powder average of the scattering from an infinite crystal per one
+// atom consists of delta peaks at the reciprocal lattice vectors G
+//
+// I(Q) = 2 pi^2 / (V N Q^2) sum_G |F(G)|^2 delta(Q - |G|)
+// F(G) = sum_j f_j exp(-0.5 G.U_j.G) exp(i G.r_j)
+//
+// where V is the unit cell volume and N the total occupancy of the cell.
+// The peaks are broadened with a Gaussian of constant FWHM.  The reduced
+// structure function is the same as from the Debye sum over distinct atom
+// pairs, therefore the self-scattering term is removed from the Bragg sum
+//
+// F(Q) = Q (I(Q) - 1/N sum_j f_j^2 exp(-Q^2 Uiso_j)) / <f>^2
+//
+// The cost scales with the number of reflections times the number of atoms
+// in the unit cell.  Structure factors for crystals are evaluated once per
+// set of symmetry-equivalent reflections.
+
+#ifndef BRAGGPOWDERCALCULATOR_HPP_INCLUDED
+#define BRAGGPOWDERCALCULATOR_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include <diffpy/srreal/PairQuantity.hpp>
+#include <diffpy/srreal/ScatteringFactorTable.hpp>
+#include <diffpy/srreal/R3linalg.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class BraggPowderCalculator :
+    public PairQuantity,
+    public ScatteringFactorTableOwner
+{
+    public:
+
+        // constructor
+        BraggPowderCalculator();
+
+        // PairQuantity overloads
+        virtual eventticker::EventTicker& ticker() const;
+
+        // results
+        /// powder-averaged Bragg intensity per atom on the full Q-grid
+        QuantityType getIntensity() const;
+        /// reduced structure function F(Q) on the full Q-grid
+        QuantityType getF() const;
+
+        // Q-range methods
+        /// Full Q-grid starting at 0
+        QuantityType getQgrid() const;
+        // Q-range configuration
+        void setQmin(double);
+        const double& getQmin() const;
+        void setQmax(double);
+        const double& getQmax() const;
+        void setQstep(double);
+        const double& getQstep() const;
+        /// FWHM of the Gaussian profile of Bragg peaks in Q
+        void setPeakWidth(double);
+        const double& getPeakWidth() const;
+
+    protected:
+
+        // PairQuantity overloads
+        virtual void resetValue();
+        virtual void configureBondGenerator(BaseBondGenerator&) const;
+        virtual void finishValue();
+
+    private:
+
+        // types
+        struct CellAtom
+        {
+            R3::PODVector xyz;
+            R3::PODMatrix uij;
+            double uiso;
+            double occupancy;
+            int typeidx;
+        };
+        typedef std::vector<CellAtom,
+                boost::alignment::aligned_allocator<CellAtom, 32> >
+                    CellAtomVector;
+
+        // methods
+        /// atoms of the full unit cell in fractional coordinates
+        void cacheCellAtoms(CellAtomVector& atoms,
+                std::vector<std::string>& atomtypes) const;
+        /// rotation parts of the symmetry operations in fractional basis
+        std::vector<R3::Matrix> uniqueRotations() const;
+        /// add Gaussian peak of integrated intensity weight at q
+        void addPeak(double q, double weight);
+
+        // data
+        double mqmin;
+        double mqmax;
+        double mqstep;
+        double mpeakwidth;
+
+        // serialization
+        friend class boost::serialization::access;
+        template<class Archive>
+            void serialize(Archive& ar, const unsigned int version)
+        {
+            using boost::serialization::base_object;
+            ar & base_object<PairQuantity>(*this);
+            ar & base_object<ScatteringFactorTableOwner>(*this);
+            ar & mqmin;
+            ar & mqmax;
+            ar & mqstep;
+            ar & mpeakwidth;
+        }
+
+};  // class BraggPowderCalculator
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+BOOST_CLASS_EXPORT_KEY(diffpy::srreal::BraggPowderCalculator)
+
+#endif  // BRAGGPOWDERCALCULATOR_HPP_INCLUDED
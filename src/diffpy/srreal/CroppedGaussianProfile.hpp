@@ -26,6 +26,8 @@
 namespace diffpy {
 namespace srreal {
 
+template <class TProfile> class PeakShape;
+
 class CroppedGaussianProfile : public GaussianProfile
 {
     public:
@@ -45,6 +47,9 @@ class CroppedGaussianProfile : public GaussianProfile
         // data
         double mscale;
 
+        // fast evaluation in PDFKernel
+        friend class PeakShape<CroppedGaussianProfile>;
+
         // serialization
         friend class boost::serialization::access;
 
@@ -21,10 +21,14 @@
 *****************************************************************************/
 
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <unordered_map>
 
 #include <diffpy/serialization.ipp>
 #include <diffpy/validators.hpp>
-#include <diffpy/srreal/PointsInSphere.hpp>
 #include <diffpy/srreal/StructureDifference.hpp>
 #include <diffpy/srreal/CrystalStructureAdapter.hpp>
 
@@ -37,6 +41,140 @@ namespace srreal {
 
 const double DEFAULT_SYMMETRY_PRECISION = 5e-5;
 
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// minimum number of symmetry images per thread in updateSymmetryPositions
+const long MIN_IMAGES_PER_THREAD = 16384;
+
+/// Spatial hash of fractional positions for detecting symmetry duplicates.
+/// The grid cells are at least as wide as the symmetry precision so that
+/// equal positions are found in the same or in the adjacent cells.
+
+class EqualPositionGrid
+{
+    public:
+
+        // constructor
+        EqualPositionGrid(const Lattice& L, double symeps) :
+            mlattice(L), msymeps(symeps)
+        {
+            const double rlengths[3] = {L.ar(), L.br(), L.cr()};
+            // limit grid size so that the cell key does not overflow
+            const double maxcells = 1 << 20;
+            for (int i = 0; i < R3::Ndim; ++i)
+            {
+                mhalo[i] = symeps * rlengths[i];
+                double n = floor(1.0 / mhalo[i]);
+                mncells[i] = int(max(1.0, min(maxcells, n)));
+            }
+        }
+
+        // methods
+        /// return index of the first position equal to xyz or -1
+        int find(const R3::Vector& xyz) const
+        {
+            int cells[3][3];
+            int ncells[3];
+            for (int i = 0; i < R3::Ndim; ++i)
+            {
+                const int& n = mncells[i];
+                const double f = (xyz[i] - floor(xyz[i])) * n;
+                const int c = this->cellIndex(i, xyz[i]);
+                ncells[i] = 0;
+                cells[i][ncells[i]++] = c;
+                if (n == 1)  continue;
+                const double slack = 1e-6 * mhalo[i] * n;
+                // adjacent cells are the same for the 2-cell grid
+                if (f - c < mhalo[i] * n + slack)
+                {
+                    cells[i][ncells[i]++] = (c + n - 1) % n;
+                }
+                if (c + 1 - f < mhalo[i] * n + slack &&
+                        (n > 2 || ncells[i] == 1))
+                {
+                    cells[i][ncells[i]++] = (c + 1) % n;
+                }
+            }
+            int rv = -1;
+            for (int i0 = 0; i0 < ncells[0]; ++i0)
+            {
+                for (int i1 = 0; i1 < ncells[1]; ++i1)
+                {
+                    for (int i2 = 0; i2 < ncells[2]; ++i2)
+                    {
+                        uint64_t key = this->cellKey(
+                                cells[0][i0], cells[1][i1], cells[2][i2]);
+                        int idx = this->findInCell(key, xyz);
+                        if (idx >= 0 && (rv < 0 || idx < rv))  rv = idx;
+                    }
+                }
+            }
+            return rv;
+        }
+
+
+        /// store position xyz with the next integer index
+        void add(const R3::Vector& xyz)
+        {
+            uint64_t key = this->cellKey(this->cellIndex(0, xyz[0]),
+                    this->cellIndex(1, xyz[1]), this->cellIndex(2, xyz[2]));
+            int idx = mpositions.size();
+            mpositions.push_back(xyz);
+            std::unordered_map<uint64_t, int>::iterator hh;
+            hh = mhead.emplace(key, -1).first;
+            mnext.push_back(hh->second);
+            hh->second = idx;
+        }
+
+    private:
+
+        // methods
+        int cellIndex(int i, double x) const
+        {
+            const int& n = mncells[i];
+            int c = int((x - floor(x)) * n);
+            return min(max(c, 0), n - 1);
+        }
+
+
+        uint64_t cellKey(int c0, int c1, int c2) const
+        {
+            return (uint64_t(c0) << 42) | (uint64_t(c1) << 21) | uint64_t(c2);
+        }
+
+
+        /// smallest index of equal position in the cell or -1
+        int findInCell(uint64_t key, const R3::Vector& xyz) const
+        {
+            std::unordered_map<uint64_t, int>::const_iterator hh;
+            hh = mhead.find(key);
+            if (hh == mhead.end())  return -1;
+            int rv = -1;
+            for (int idx = hh->second; idx >= 0; idx = mnext[idx])
+            {
+                R3::Vector dxyz = mpositions[idx] - xyz;
+                dxyz[0] -= round(dxyz[0]);
+                dxyz[1] -= round(dxyz[1]);
+                dxyz[2] -= round(dxyz[2]);
+                if (mlattice.norm(dxyz) <= msymeps)  rv = idx;
+            }
+            return rv;
+        }
+
+        // data
+        const Lattice& mlattice;
+        double msymeps;
+        double mhalo[3];
+        int mncells[3];
+        std::vector<R3::Vector> mpositions;
+        std::vector<int> mnext;
+        std::unordered_map<uint64_t, int> mhead;
+};
+
+}   // namespace
+
 //////////////////////////////////////////////////////////////////////////////
 // class CrystalStructureAdapter
 //////////////////////////////////////////////////////////////////////////////
@@ -69,7 +207,7 @@ BaseBondGeneratorPtr CrystalStructureAdapter::createBondGenerator() const
 
 int CrystalStructureAdapter::siteMultiplicity(int idx) const
 {
-    if (!this->isSymmetryCached())  this->updateSymmetryPositions();
+    if (!this->isSymmetryCached(idx))  this->updateSymmetryPositions();
     int rv = msymatoms[idx].size();
     return rv;
 }
@@ -147,7 +285,7 @@ const CrystalStructureAdapter::AtomVector&
 CrystalStructureAdapter::getEquivalentAtoms(int idx) const
 {
     assert(0 <= idx && idx < this->countSites());
-    if (!this->isSymmetryCached())  this->updateSymmetryPositions();
+    if (!this->isSymmetryCached(idx))  this->updateSymmetryPositions();
     return msymatoms[idx];
 }
 
@@ -162,6 +300,7 @@ CrystalStructureAdapter::expandLatticeAtom(const Atom& a0) const
     eqsumpos.reserve(this->countSymOps());
     eqduplicity.reserve(this->countSymOps());
     const Lattice& L = this->getLattice();
+    EqualPositionGrid eqgrid(L, this->getSymmetryPrecision());
     SymOpVector::const_iterator op = msymops.begin();
     Atom a1 = a0;
     for (; op != msymops.end(); ++op)
@@ -170,12 +309,13 @@ CrystalStructureAdapter::expandLatticeAtom(const Atom& a0) const
         a1.xyz_cartn = R3::mxvecproduct(op->R, a0.xyz_cartn);
         a1.xyz_cartn += op->t;
         // check if a1 is a duplicate of an existing symmetry site
-        int ieq = this->findEqualPosition(eqsites, a1);
+        int ieq = eqgrid.find(a1.xyz_cartn);
         if (ieq < 0)
         {
             // a1 is a new symmetry site
             R3::Matrix utmp = R3::prod(a0.uij_cartn, R3::trans(op->R));
             a1.uij_cartn = R3::prod(op->R, utmp);
+            eqgrid.add(a1.xyz_cartn);
             eqsites.push_back(a1);
             eqsumpos.push_back(R3::zerovector);
             eqduplicity.push_back(0);
@@ -210,49 +350,86 @@ CrystalStructureAdapter::expandLatticeAtom(const Atom& a0) const
 
 void CrystalStructureAdapter::updateSymmetryPositions() const
 {
-    // build asymmetric unit in lattice coordinates
-    AtomVector lcatoms(this->begin(), this->end());
-    AtomVector::iterator lcai = lcatoms.begin();
-    for (; lcai != lcatoms.end(); ++lcai)  this->toFractional(*lcai);
-    // build symmetry positions for all atoms in the asymmetric unit
-    msymatoms.resize(this->countSites());
-    assert(lcatoms.size() == msymatoms.size());
-    lcai = lcatoms.begin();
-    std::vector<AtomVector>::iterator saii = msymatoms.begin();
-    for (; lcai != lcatoms.end(); ++lcai, ++saii)
+    // find the asymmetric unit sites that need to be expanded
+    const int nsites = this->countSites();
+    const bool expandall = !msymmetry_cached ||
+        int(msymsources.size()) != nsites ||
+        msymlattice != this->getLattice();
+    vector<int> dirtysites;
+    for (int i = 0; i < nsites; ++i)
+    {
+        if (expandall || msymsources[i] != (*this)[i])  dirtysites.push_back(i);
+    }
+    if (!expandall && dirtysites.empty())  return;
+    // invalidate the cache in case the expansion throws
+    msymmetry_cached = false;
+    msymatoms.resize(nsites);
+    msymsources.resize(nsites);
+    msymlattice = this->getLattice();
+    // split large updates between threads
+    const int ndirty = dirtysites.size();
+    const long nimages = long(ndirty) * max(1, this->countSymOps());
+    long nthreads = min(long(thread::hardware_concurrency()),
+            nimages / MIN_IMAGES_PER_THREAD);
+    nthreads = max(1L, min(nthreads, long(ndirty)));
+    if (nthreads == 1)
+    {
+        this->expandSitesRange(dirtysites, 0, ndirty);
+        msymmetry_cached = true;
+        return;
+    }
+    vector<thread> workers;
+    vector<exception_ptr> errors(nthreads);
+    for (int k = 0; k < nthreads; ++k)
+    {
+        const int lo = ndirty * k / nthreads;
+        const int hi = ndirty * (k + 1) / nthreads;
+        exception_ptr& e = errors[k];
+        workers.push_back(thread([this, &dirtysites, lo, hi, &e]() {
+                    try {
+                        this->expandSitesRange(dirtysites, lo, hi);
+                    }
+                    catch (...) {
+                        e = current_exception();
+                    }
+                }));
+    }
+    for (thread& w : workers)  w.join();
+    for (const exception_ptr& e : errors)
     {
-        *saii = this->expandLatticeAtom(*lcai);
-        iterator ai = saii->begin();
-        for (; ai != saii->end(); ++ai)  this->toCartesian(*ai);
+        if (e)  rethrow_exception(e);
     }
     msymmetry_cached = true;
 }
 
 // Private Methods -----------------------------------------------------------
 
-int CrystalStructureAdapter::findEqualPosition(
-        const AtomVector& eqsites, const Atom& a0) const
+void CrystalStructureAdapter::expandSitesRange(
+        const vector<int>& sites, int lo, int hi) const
 {
-    const double symeps = this->getSymmetryPrecision();
-    const Lattice& L = this->getLattice();
-    R3::Vector dxyz;
-    const_iterator ai = eqsites.begin();
-    for (; ai != eqsites.end(); ++ai)
+    for (int k = lo; k < hi; ++k)
     {
-        dxyz = ai->xyz_cartn - a0.xyz_cartn;
-        dxyz[0] -= round(dxyz[0]);
-        dxyz[1] -= round(dxyz[1]);
-        dxyz[2] -= round(dxyz[2]);
-        if (L.norm(dxyz) <= symeps)  return (ai - eqsites.begin());
+        const int i = sites[k];
+        const Atom& a = (*this)[i];
+        Atom lca = a;
+        this->toFractional(lca);
+        AtomVector& eqatoms = msymatoms[i];
+        eqatoms = this->expandLatticeAtom(lca);
+        iterator ai = eqatoms.begin();
+        for (; ai != eqatoms.end(); ++ai)  this->toCartesian(*ai);
+        msymsources[i] = a;
     }
-    return -1;
 }
 
-bool CrystalStructureAdapter::isSymmetryCached() const
+
+bool CrystalStructureAdapter::isSymmetryCached(int idx) const
 {
-    msymmetry_cached = msymmetry_cached &&
-        (int(msymatoms.size()) == this->countSites());
-    return msymmetry_cached;
+    const int nsites = this->countSites();
+    bool rv = msymmetry_cached &&
+        (int(msymsources.size()) == nsites) &&
+        (msymsources[idx] == (*this)[idx]) &&
+        (msymlattice == this->getLattice());
+    return rv;
 }
 
 // Comparison functions ------------------------------------------------------
@@ -290,6 +467,8 @@ CrystalStructureBondGenerator::CrystalStructureBondGenerator(
     assert(mcstructure);
     msymidx = 0;
     mpuc1 = &(R3::zeromatrix());
+    mporbitweights1 = NULL;
+    mstabilizer_anchor = -1;
 }
 
 // Public Methods ------------------------------------------------------------
@@ -302,6 +481,14 @@ void CrystalStructureBondGenerator::selectAnchorSite(int anchor)
 }
 
 
+int CrystalStructureBondGenerator::multiplicity() const
+{
+    int rv = this->BaseBondGenerator::multiplicity();
+    if (mporbitweights1)  rv *= (*mporbitweights1)[msymidx];
+    return rv;
+}
+
+
 const R3::Matrix& CrystalStructureBondGenerator::Ucartesian1() const
 {
     return *mpuc1;
@@ -321,10 +508,16 @@ bool CrystalStructureBondGenerator::iterateSymmetry()
     // were all already used.
     const AtomVector& sa = this->symatoms(this->site1());
     ++msymidx;
+    // skip images that are symmetry equivalent to an earlier one
+    if (mporbitweights1)
+    {
+        const std::vector<int>& w = *mporbitweights1;
+        while (msymidx < sa.size() && !w[msymidx])  ++msymidx;
+    }
     if (msymidx >= sa.size())  return false;
-    // rewind the sphere for the new symmetry position.
-    // this calls CrystalStructureBondGenerator::updater1()
-    this->PeriodicStructureBondGenerator::rewindSymmetry();
+    // rewind the lattice vectors for the new symmetry position.
+    this->rewindShell(R3::toPOD(sa[msymidx].xyz_cartn));
+    this->updater1();
     return true;
 }
 
@@ -332,8 +525,10 @@ bool CrystalStructureBondGenerator::iterateSymmetry()
 void CrystalStructureBondGenerator::rewindSymmetry()
 {
     msymidx = 0;
-    // this calls CrystalStructureBondGenerator::updater1()
-    this->PeriodicStructureBondGenerator::rewindSymmetry();
+    mporbitweights1 = this->orbitWeights(this->site1());
+    const AtomVector& sa = this->symatoms(this->site1());
+    this->rewindShell(R3::toPOD(sa[0].xyz_cartn));
+    this->updater1();
 }
 
 
@@ -347,7 +542,7 @@ void CrystalStructureBondGenerator::updater1()
 {
     const AtomVector& sa = this->symatoms(this->site1());
     assert(msymidx < sa.size());
-    mr1 = mrcsphere + sa[msymidx].xyz_cartn;
+    R3::assign(mr1, *mprcsphere + R3::toPOD(sa[msymidx].xyz_cartn));
     mpuc1 = &(sa[msymidx].uij_cartn);
     this->updateDistance();
 }
@@ -361,6 +556,84 @@ CrystalStructureBondGenerator::symatoms(int idx)
     return mcstructure->msymatoms[idx];
 }
 
+
+const vector<int>* CrystalStructureBondGenerator::orbitWeights(int idx)
+{
+    if (!this->getOrbitReduction())  return NULL;
+    if (mstabilizer_anchor != this->site0())  this->updateStabilizer();
+    if (mstabilizer.size() <= 1)  return NULL;
+    vector<int>& rv = morbitweights[idx];
+    if (!rv.empty())  return &rv;
+    // find orbits of the site images under the stabilizer operations
+    const Lattice& L = mcstructure->getLattice();
+    const AtomVector& sa = this->symatoms(idx);
+    const int m = sa.size();
+    vector<R3::Vector> fxyz(m);
+    EqualPositionGrid eqgrid(L, mcstructure->getSymmetryPrecision());
+    for (int j = 0; j < m; ++j)
+    {
+        fxyz[j] = L.fractional(sa[j].xyz_cartn);
+        eqgrid.add(fxyz[j]);
+    }
+    // orbit label is the smallest image index in the orbit
+    vector<int> orbit(m);
+    for (int j = 0; j < m; ++j)  orbit[j] = j;
+    vector<int>::const_iterator si = mstabilizer.begin();
+    for (; si != mstabilizer.end(); ++si)
+    {
+        const SymOpRotTrans& op = mcstructure->msymops[*si];
+        for (int j = 0; j < m; ++j)
+        {
+            R3::Vector gxyz = R3::mxvecproduct(op.R, fxyz[j]);
+            gxyz += op.t;
+            int k = eqgrid.find(gxyz);
+            // use all images if symmetry operations are not consistent
+            if (k < 0)
+            {
+                rv.assign(m, 1);
+                return &rv;
+            }
+            // merge the orbits of j and k
+            int oj = orbit[j];
+            int ok = orbit[k];
+            while (oj != orbit[oj])  oj = orbit[oj];
+            while (ok != orbit[ok])  ok = orbit[ok];
+            orbit[max(oj, ok)] = min(oj, ok);
+        }
+    }
+    rv.assign(m, 0);
+    for (int j = 0; j < m; ++j)
+    {
+        int oj = orbit[j];
+        while (oj != orbit[oj])  oj = orbit[oj];
+        rv[oj] += 1;
+    }
+    return &rv;
+}
+
+
+void CrystalStructureBondGenerator::updateStabilizer()
+{
+    const Lattice& L = mcstructure->getLattice();
+    const double symeps = mcstructure->getSymmetryPrecision();
+    const Atom& a0 = this->symatoms(this->site0())[0];
+    const R3::Vector x0 = L.fractional(a0.xyz_cartn);
+    mstabilizer.clear();
+    const CrystalStructureAdapter::SymOpVector& ops = mcstructure->msymops;
+    for (int i = 0; i < int(ops.size()); ++i)
+    {
+        R3::Vector dxyz = R3::mxvecproduct(ops[i].R, x0);
+        dxyz += ops[i].t;
+        dxyz -= x0;
+        dxyz[0] -= round(dxyz[0]);
+        dxyz[1] -= round(dxyz[1]);
+        dxyz[2] -= round(dxyz[2]);
+        if (L.norm(dxyz) <= symeps)  mstabilizer.push_back(i);
+    }
+    morbitweights.assign(mcstructure->countSites(), vector<int>());
+    mstabilizer_anchor = this->site0();
+}
+
 }   // namespace srreal
 }   // namespace diffpy
 
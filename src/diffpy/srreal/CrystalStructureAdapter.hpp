@@ -100,15 +100,18 @@ class CrystalStructureAdapter : public PeriodicStructureAdapter
         SymOpVector msymops;
         double msymmetry_precision;
         mutable std::vector<AtomVector> msymatoms;
+        /// asymmetric unit atoms and lattice that were used for msymatoms
+        mutable AtomVector msymsources;
+        mutable Lattice msymlattice;
+        /// false when symmetry operations or precision changed
         mutable bool msymmetry_cached;
 
         // symmetry helpers
-        /// return index of AtomVector atom at an equal position or -1
-        int findEqualPosition(const AtomVector&, const Atom&) const;
-        /// fuzzy check if symmetry positions are up to date
-        /// this only detects addition or removal of atom in the asymmetric
-        /// unit, but does not check for changes in atom positions.
-        bool isSymmetryCached() const;
+        /// expand asymmetric unit sites[lo:hi] to msymatoms
+        void expandSitesRange(const std::vector<int>& sites,
+                int lo, int hi) const;
+        /// check if symmetry positions of site idx are up to date
+        bool isSymmetryCached(int idx) const;
 
         // comparison
         friend bool operator==(
@@ -148,6 +151,7 @@ class CrystalStructureBondGenerator : public PeriodicStructureBondGenerator
         virtual void selectAnchorSite(int);
 
         // data access
+        virtual int multiplicity() const;
         virtual const R3::Matrix& Ucartesian1() const;
 
     protected:
@@ -162,13 +166,26 @@ class CrystalStructureBondGenerator : public PeriodicStructureBondGenerator
         const CrystalStructureAdapter* mcstructure;
         size_t msymidx;
         const R3::Matrix* mpuc1;
+        /// orbit sizes for symmetry images of site1 or NULL
+        const std::vector<int>* mporbitweights1;
 
     private:
 
         typedef CrystalStructureAdapter::AtomVector AtomVector;
 
+        // data
+        /// anchor site for which the stabilizer data were evaluated
+        int mstabilizer_anchor;
+        /// indices of symmetry operations that keep the anchor in place
+        std::vector<int> mstabilizer;
+        /// per-site sizes of symmetry image orbits under the stabilizer.
+        /// Only the first image in each orbit has nonzero value.
+        std::vector< std::vector<int> > morbitweights;
+
         // methods
         const AtomVector& symatoms(int idx);
+        const std::vector<int>* orbitWeights(int idx);
+        void updateStabilizer();
 
 };
 
@@ -0,0 +1,445 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class CrystalliteStructureAdapter -- finite crystallite composed of
+*     selected unit cells of a periodic structure.
+*
+* class CrystalliteBondGenerator -- bond generator that combines pairs
+*     of unit cell atoms with lattice difference vectors weighted by the
+*     number of cell pairs in the crystallite.
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
+
+#include <diffpy/serialization.ipp>
+#include <diffpy/srreal/CrystalliteStructureAdapter.hpp>
+#include <diffpy/srreal/CrystalStructureAdapter.hpp>
+#include <diffpy/srreal/PointsInSphere.hpp>
+#include <diffpy/srreal/StructureDifference.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// Lattice difference vector d is stored if it is lexicographically
+/// positive, -d is then implied.
+inline bool isPositiveHalf(int d0, int d1, int d2)
+{
+    return (d0 > 0) || (d0 == 0 && (d1 > 0 || (d1 == 0 && d2 > 0)));
+}
+
+
+typedef CrystalliteStructureAdapter::CellIndex CellIndex;
+typedef CrystalliteStructureAdapter::CellDifferences CellDifferences;
+
+
+/// Minimum fraction of the bounding box filled with cells for counting
+/// the differences on a dense grid
+const double DENSE_CELLS_FILL = 0.125;
+
+
+/// Count cell pairs per positive difference vector in a hash table.
+/// Used for sparse cells where the dense grid would be too large.
+void countSparseCellDifferences(const set<CellIndex>& cells,
+        vector<int>& diffs, vector<int>& counts)
+{
+    typedef array<int, R3::Ndim> Difference;
+    typedef unordered_map<Difference, int,
+            boost::hash<Difference> > DifferenceCounts;
+    DifferenceCounts dcounts;
+    set<CellIndex>::const_iterator c0, c1;
+    for (c0 = cells.begin(); c0 != cells.end(); ++c0)
+    {
+        for (c1 = c0, ++c1; c1 != cells.end(); ++c1)
+        {
+            Difference d = {{
+                (*c1)[0] - (*c0)[0], (*c1)[1] - (*c0)[1],
+                (*c1)[2] - (*c0)[2]}};
+            if (!isPositiveHalf(d[0], d[1], d[2]))
+            {
+                d[0] = -d[0];  d[1] = -d[1];  d[2] = -d[2];
+            }
+            ++dcounts[d];
+        }
+    }
+    // use the lexicographic order as for the dense grid
+    vector< pair<Difference, int> > dsorted(dcounts.begin(), dcounts.end());
+    sort(dsorted.begin(), dsorted.end());
+    for (const pair<Difference, int>& dc : dsorted)
+    {
+        diffs.insert(diffs.end(), dc.first.begin(), dc.first.end());
+        counts.push_back(dc.second);
+    }
+}
+
+
+/// Count ordered cell pairs per lattice difference vector.
+/// Return arrays of the difference vectors and their counts.
+void countCellDifferences(const set<CellIndex>& cells,
+        vector<int>& diffs, vector<int>& counts)
+{
+    diffs.clear();
+    counts.clear();
+    if (cells.empty())  return;
+    const int ncells = cells.size();
+    int lo[R3::Ndim], hi[R3::Ndim];
+    copy(cells.begin()->begin(), cells.begin()->end(), lo);
+    copy(cells.begin()->begin(), cells.begin()->end(), hi);
+    for (const CellIndex& c : cells)
+    {
+        for (int i = 0; i < R3::Ndim; ++i)
+        {
+            lo[i] = min(lo[i], c[i]);
+            hi[i] = max(hi[i], c[i]);
+        }
+    }
+    const int span[R3::Ndim] = {
+        hi[0] - lo[0] + 1, hi[1] - lo[1] + 1, hi[2] - lo[2] + 1};
+    const double volume = double(span[0]) * span[1] * span[2];
+    const bool isbox = (ncells == volume);
+    diffs.insert(diffs.end(), R3::Ndim, 0);
+    counts.push_back(ncells);
+    if (ncells < DENSE_CELLS_FILL * volume)
+    {
+        countSparseCellDifferences(cells, diffs, counts);
+        return;
+    }
+    // differences range in (-span, span) along each axis
+    const int nd[R3::Ndim] = {
+        2 * span[0] - 1, 2 * span[1] - 1, 2 * span[2] - 1};
+    vector<int> grid;
+    if (!isbox)
+    {
+        grid.assign(size_t(nd[0]) * nd[1] * nd[2], 0);
+        vector<int> flat;
+        flat.reserve(R3::Ndim * ncells);
+        for (const CellIndex& c : cells)
+        {
+            for (int i = 0; i < R3::Ndim; ++i)  flat.push_back(c[i] - lo[i]);
+        }
+        const int* c0 = flat.data();
+        const int* clast = c0 + flat.size();
+        for (; c0 != clast; c0 += R3::Ndim)
+        {
+            for (const int* c1 = c0 + R3::Ndim; c1 != clast; c1 += R3::Ndim)
+            {
+                int d0 = c1[0] - c0[0];
+                int d1 = c1[1] - c0[1];
+                int d2 = c1[2] - c0[2];
+                if (!isPositiveHalf(d0, d1, d2))
+                {
+                    d0 = -d0;  d1 = -d1;  d2 = -d2;
+                }
+                const size_t idx = (size_t(d0 + span[0] - 1) * nd[1] +
+                        (d1 + span[1] - 1)) * nd[2] + (d2 + span[2] - 1);
+                ++grid[idx];
+            }
+        }
+    }
+    size_t idx = 0;
+    for (int d0 = 1 - span[0]; d0 < span[0]; ++d0)
+    {
+        for (int d1 = 1 - span[1]; d1 < span[1]; ++d1)
+        {
+            for (int d2 = 1 - span[2]; d2 < span[2]; ++d2, ++idx)
+            {
+                if (!isPositiveHalf(d0, d1, d2))  continue;
+                // block of cells has analytical overlap count
+                const int cnt = !isbox ? grid[idx] :
+                    (span[0] - abs(d0)) * (span[1] - abs(d1)) *
+                    (span[2] - abs(d2));
+                if (!cnt)  continue;
+                diffs.push_back(d0);
+                diffs.push_back(d1);
+                diffs.push_back(d2);
+                counts.push_back(cnt);
+            }
+        }
+    }
+}
+
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// class CrystalliteStructureAdapter
+//////////////////////////////////////////////////////////////////////////////
+
+// Constructor ---------------------------------------------------------------
+
+CrystalliteStructureAdapter::CrystalliteStructureAdapter(
+        StructureAdapterConstPtr srcstructure)
+{
+    const PeriodicStructureAdapter* pstru =
+        dynamic_cast<const PeriodicStructureAdapter*>(srcstructure.get());
+    if (!pstru)
+    {
+        const char* emsg = "Crystallite requires periodic structure.";
+        throw invalid_argument(emsg);
+    }
+    mlattice = pstru->getLattice();
+    const CrystalStructureAdapter* cstru =
+        dynamic_cast<const CrystalStructureAdapter*>(pstru);
+    const int cntsites = pstru->countSites();
+    for (int i = 0; i < cntsites; ++i)
+    {
+        if (!cstru)
+        {
+            this->append(pstru->at(i));
+            continue;
+        }
+        const CrystalStructureAdapter::AtomVector& eqatoms =
+            cstru->getEquivalentAtoms(i);
+        this->insert(this->end(), eqatoms.begin(), eqatoms.end());
+    }
+}
+
+// Public Methods ------------------------------------------------------------
+
+StructureAdapterPtr CrystalliteStructureAdapter::clone() const
+{
+    StructureAdapterPtr rv(new CrystalliteStructureAdapter(*this));
+    return rv;
+}
+
+
+BaseBondGeneratorPtr CrystalliteStructureAdapter::createBondGenerator() const
+{
+    BaseBondGeneratorPtr bnds(
+            new CrystalliteBondGenerator(shared_from_this()));
+    return bnds;
+}
+
+
+int CrystalliteStructureAdapter::siteMultiplicity(int idx) const
+{
+    return this->countCells();
+}
+
+
+StructureDifference
+CrystalliteStructureAdapter::diff(StructureAdapterConstPtr other) const
+{
+    StructureDifference sd = this->StructureAdapter::diff(other);
+    if (sd.stru0 == sd.stru1)  return sd;
+    typedef boost::shared_ptr<const class CrystalliteStructureAdapter> CPtr;
+    CPtr cother = boost::dynamic_pointer_cast<CPtr::element_type>(other);
+    if (!cother)  return sd;
+    assert(cother == sd.stru1);
+    if (this->getLattice() != cother->getLattice())  return sd;
+    if (mcells != cother->mcells)  return sd;
+    sd = this->AtomicStructureAdapter::diff(other);
+    return sd;
+}
+
+
+const Lattice& CrystalliteStructureAdapter::getLattice() const
+{
+    return mlattice;
+}
+
+
+int CrystalliteStructureAdapter::countCells() const
+{
+    return mcells.size();
+}
+
+
+const set<CrystalliteStructureAdapter::CellIndex>&
+CrystalliteStructureAdapter::getCells() const
+{
+    return mcells;
+}
+
+
+void CrystalliteStructureAdapter::clearCells()
+{
+    mcells.clear();
+    mcelldiffs.reset();
+}
+
+
+void CrystalliteStructureAdapter::addCell(int na, int nb, int nc)
+{
+    CellIndex c(R3::Ndim);
+    c[0] = na;  c[1] = nb;  c[2] = nc;
+    if (mcells.insert(c).second)  mcelldiffs.reset();
+}
+
+
+void CrystalliteStructureAdapter::setBoxShape(int na, int nb, int nc)
+{
+    this->clearCells();
+    for (int i = 0; i < na; ++i)
+    {
+        for (int j = 0; j < nb; ++j)
+        {
+            for (int k = 0; k < nc; ++k)  this->addCell(i, j, k);
+        }
+    }
+}
+
+
+void CrystalliteStructureAdapter::setSphereShape(double diameter)
+{
+    this->clearCells();
+    const double radius = diameter / 2.0;
+    // cell centers are offset by a half diagonal from the lattice points
+    const R3::Vector halfdiagonal = mlattice.cartesian(
+            R3::Vector(0.5, 0.5, 0.5));
+    const double rmax = radius + R3::norm(halfdiagonal);
+    PointsInSphere sph(0.0, rmax, mlattice);
+    for (sph.rewind(); !sph.finished(); sph.next())
+    {
+        const int* n = sph.mno();
+        R3::Vector center = mlattice.cartesian(
+                R3::Vector(n[0] + 0.5, n[1] + 0.5, n[2] + 0.5));
+        if (R3::norm(center) > radius)  continue;
+        this->addCell(n[0], n[1], n[2]);
+    }
+}
+
+
+CrystalliteStructureAdapter::CellDifferencesConstPtr
+CrystalliteStructureAdapter::getCellDifferences() const
+{
+    if (mcelldiffs)  return mcelldiffs;
+    vector<int> diffs;
+    vector<int> counts;
+    countCellDifferences(mcells, diffs, counts);
+    // sort by the difference vector length
+    vector< pair<double, int> > lengthindex;
+    R3::PODVectorArray cartesian;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        const int* d = &(diffs[R3::Ndim * i]);
+        R3::Vector dc = mlattice.cartesian(R3::Vector(d[0], d[1], d[2]));
+        lengthindex.push_back(make_pair(R3::norm(dc), int(i)));
+        cartesian.push_back(R3::toPOD(dc));
+    }
+    sort(lengthindex.begin(), lengthindex.end());
+    boost::shared_ptr<CellDifferences> cdiffs(new CellDifferences);
+    cdiffs->cartesian.reserve(counts.size());
+    cdiffs->length.reserve(counts.size());
+    cdiffs->count.reserve(counts.size());
+    vector< pair<double, int> >::const_iterator li = lengthindex.begin();
+    for (; li != lengthindex.end(); ++li)
+    {
+        cdiffs->length.push_back(li->first);
+        cdiffs->cartesian.push_back(cartesian[li->second]);
+        cdiffs->count.push_back(counts[li->second]);
+    }
+    mcelldiffs = cdiffs;
+    return mcelldiffs;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// class CrystalliteBondGenerator
+//////////////////////////////////////////////////////////////////////////////
+
+// Constructor ---------------------------------------------------------------
+
+CrystalliteBondGenerator::CrystalliteBondGenerator(
+        StructureAdapterConstPtr adpt) :
+    BaseBondGenerator(adpt),
+    mr1uc(R3::zerovector),
+    mdidx(0),
+    mdend(0),
+    mnegative(false),
+    mfolded(false)
+{
+    const CrystalliteStructureAdapter& cstru =
+        dynamic_cast<const CrystalliteStructureAdapter&>(*adpt);
+    mcelldiffs = cstru.getCellDifferences();
+}
+
+// Public Methods ------------------------------------------------------------
+
+int CrystalliteBondGenerator::multiplicity() const
+{
+    const int cnt = mcelldiffs->count[mdidx];
+    // difference vector at index 0 can be only zero, d = -d
+    return (mfolded && mdidx > 0) ? (2 * cnt) : cnt;
+}
+
+// Protected Methods ---------------------------------------------------------
+
+bool CrystalliteBondGenerator::iterateSymmetry()
+{
+    if (mdidx >= mdend)  return false;
+    if (!mnegative && !mfolded && mdidx > 0)
+    {
+        mnegative = true;
+        this->updater1();
+        return true;
+    }
+    mnegative = false;
+    if (++mdidx >= mdend)  return false;
+    this->updater1();
+    return true;
+}
+
+
+void CrystalliteBondGenerator::rewindSymmetry()
+{
+    mr1uc = mstructure->siteCartesianPosition(this->site1());
+    mfolded = this->getOrbitReduction() && (this->site0() == this->site1());
+    mnegative = false;
+    // only difference vectors within the offset from the r-range
+    const double dr = R3::distance(mr1uc, mr0);
+    const vector<double>& length = mcelldiffs->length;
+    mdidx = lower_bound(length.begin(), length.end(),
+            this->getRmin() - dr) - length.begin();
+    mdend = upper_bound(length.begin(), length.end(),
+            this->getRmax() + dr) - length.begin();
+    if (mdidx < mdend)
+    {
+        this->updater1();
+        return;
+    }
+    // no bonds for this site
+    mr1 = mr1uc;
+    mdistance = numeric_limits<double>::max();
+}
+
+// Private Methods -----------------------------------------------------------
+
+void CrystalliteBondGenerator::updater1()
+{
+    const R3::PODVector& dc = mcelldiffs->cartesian[mdidx];
+    const double sgn = mnegative ? -1.0 : 1.0;
+    for (int i = 0; i < R3::Ndim; ++i)  mr1[i] = mr1uc[i] + sgn * dc[i];
+    this->updateDistance();
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+DIFFPY_INSTANTIATE_SERIALIZATION(diffpy::srreal::CrystalliteStructureAdapter)
+BOOST_CLASS_EXPORT_IMPLEMENT(diffpy::srreal::CrystalliteStructureAdapter)
+
+// End of file
@@ -0,0 +1,152 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class CrystalliteStructureAdapter -- finite crystallite composed of
+*     selected unit cells of a periodic structure.
+*
+* class CrystalliteBondGenerator -- bond generator that combines pairs
+*     of unit cell atoms with lattice difference vectors weighted by the
+*     number of cell pairs in the crystallite.
+*
+*****************************************************************************/
+
+// Atom pairs in a crystallite factorize into pairs of atoms in the unit cell
+// and lattice difference vectors d = n1 - n0 between the included cells.
+// Each difference vector contributes with the number of cell pairs w(d),
+// hence Debye sums run over (cell atom pairs) x (distinct d) instead of
+// all atom pairs in the crystallite.  The shape of the crystallite is
+// defined on the level of unit cells, the cell atoms are not cut.
+
+#ifndef CRYSTALLITESTRUCTUREADAPTER_HPP_INCLUDED
+#define CRYSTALLITESTRUCTUREADAPTER_HPP_INCLUDED
+
+#include <set>
+#include <vector>
+#include <boost/serialization/set.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <diffpy/srreal/AtomicStructureAdapter.hpp>
+#include <diffpy/srreal/BaseBondGenerator.hpp>
+#include <diffpy/srreal/Lattice.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class CrystalliteStructureAdapter : public AtomicStructureAdapter
+{
+    public:
+
+        // types
+        /// fractional indices of a unit cell in the crystallite
+        typedef std::vector<int> CellIndex;
+        /// distinct lattice difference vectors between the included cells
+        /// sorted by length.  Only one of the d, -d vectors is stored.
+        struct CellDifferences
+        {
+            R3::PODVectorArray cartesian;
+            std::vector<double> length;
+            std::vector<int> count;
+        };
+        typedef boost::shared_ptr<const CellDifferences>
+            CellDifferencesConstPtr;
+
+        // constructors
+        CrystalliteStructureAdapter()  { }
+        /// use unit cell atoms of a PeriodicStructureAdapter or
+        /// CrystalStructureAdapter.  The crystallite has no cells.
+        CrystalliteStructureAdapter(StructureAdapterConstPtr);
+
+        // methods - overloaded
+        virtual StructureAdapterPtr clone() const;
+        virtual BaseBondGeneratorPtr createBondGenerator() const;
+        // reusing StructureAdapter::numberDensity()
+        virtual int siteMultiplicity(int idx) const;
+        virtual StructureDifference diff(StructureAdapterConstPtr other) const;
+
+        // methods - own
+        const Lattice& getLattice() const;
+        int countCells() const;
+        const std::set<CellIndex>& getCells() const;
+        void clearCells();
+        void addCell(int na, int nb, int nc);
+        /// use block of na x nb x nc cells
+        void setBoxShape(int na, int nb, int nc);
+        /// use cells with centers inside a sphere centered at the origin
+        void setSphereShape(double diameter);
+        CellDifferencesConstPtr getCellDifferences() const;
+
+    private:
+
+        // data
+        Lattice mlattice;
+        std::set<CellIndex> mcells;
+        mutable CellDifferencesConstPtr mcelldiffs;
+
+        // serialization
+        friend class boost::serialization::access;
+        template<class Archive>
+            void serialize(Archive& ar, const unsigned int version)
+        {
+            using boost::serialization::base_object;
+            ar & base_object<AtomicStructureAdapter>(*this);
+            ar & mlattice;
+            ar & mcells;
+            if (Archive::is_loading::value)  mcelldiffs.reset();
+        }
+
+};
+
+typedef boost::shared_ptr<CrystalliteStructureAdapter>
+    CrystalliteStructureAdapterPtr;
+
+
+class CrystalliteBondGenerator : public BaseBondGenerator
+{
+    public:
+
+        // constructors
+        CrystalliteBondGenerator(StructureAdapterConstPtr);
+
+        // methods
+        virtual int multiplicity() const;
+
+    protected:
+
+        // methods
+        virtual bool iterateSymmetry();
+        virtual void rewindSymmetry();
+
+    private:
+
+        // data
+        CrystalliteStructureAdapter::CellDifferencesConstPtr mcelldiffs;
+        R3::Vector mr1uc;
+        int mdidx;
+        int mdend;
+        bool mnegative;
+        /// d and -d are merged for bonds within the same cell site
+        bool mfolded;
+
+        // methods
+        void updater1();
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+BOOST_CLASS_EXPORT_KEY(diffpy::srreal::CrystalliteStructureAdapter)
+
+#endif  // CRYSTALLITESTRUCTUREADAPTER_HPP_INCLUDED
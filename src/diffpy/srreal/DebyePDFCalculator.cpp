@@ -36,6 +36,16 @@ namespace srreal {
 
 const double DEFAULT_DEBYEPDFCALCULATOR_QMAX = 25.0;
 
+namespace {
+
+/// Keys for the derived results in the DebyePDFCalculator cache.
+enum {
+    PDF_UNSCALED,
+    RDFPERR,
+};
+
+}   // namespace
+
 // Constructor ---------------------------------------------------------------
 
 DebyePDFCalculator::DebyePDFCalculator() :
@@ -97,9 +107,17 @@ eventticker::EventTicker& DebyePDFCalculator::ticker() const
 
 QuantityType DebyePDFCalculator::getPDF() const
 {
+    const eventticker::EventTicker& tic = this->resultsTicker();
+    const QuantityType* pdf0 = mresults_cache.find(PDF_UNSCALED, tic);
+    if (!pdf0)
+    {
+        pdf0 = &mresults_cache.store(PDF_UNSCALED,
+                this->getPDFAtQmin(this->getQmin()), tic);
+    }
     QuantityType rgrid = this->getRgrid();
-    QuantityType pdf0 = this->getPDFAtQmin(this->getQmin());
-    QuantityType pdf1 = this->applyEnvelopes(rgrid, pdf0);
+    PQStatisticsTimer tm(this->activeStatistics(),
+            &PQStatistics::postprocessingtime);
+    QuantityType pdf1 = this->applyEnvelopes(rgrid, *pdf0);
     return pdf1;
 }
 
@@ -117,7 +135,10 @@ QuantityType DebyePDFCalculator::getRDF() const
 
 QuantityType DebyePDFCalculator::getRDFperR() const
 {
-    return this->getPDFAtQmin(0.0);
+    const eventticker::EventTicker& tic = this->resultsTicker();
+    const QuantityType* cached = mresults_cache.find(RDFPERR, tic);
+    if (cached)  return *cached;
+    return mresults_cache.store(RDFPERR, this->getPDFAtQmin(0.0), tic);
 }
 
 // Q-range configuration
@@ -128,6 +149,7 @@ void DebyePDFCalculator::setQmin(double qmin)
     // Debye summation is always conducted from Qmin=0.
     ensureNonNegative("Qmin", qmin);
     this->BaseDebyeSum::setQmin(0.0);
+    if (mqminpdf != qmin)  mresults_ticker.click();
     mqminpdf = qmin;
 }
 
@@ -196,7 +218,11 @@ void DebyePDFCalculator::setRstep(double rstep)
     // NOTE: do not update ticker here, rstep is only used in the FFT
     // and not in the Debye summation.
     ensureEpsilonPositive("Rstep", rstep);
-    if (mrstep != rstep)  mrlimits_are_cached = false;
+    if (mrstep != rstep)
+    {
+        mrlimits_are_cached = false;
+        mresults_ticker.click();
+    }
     mrstep = rstep;
 }
 
@@ -275,6 +301,8 @@ void DebyePDFCalculator::configureBondGenerator(BaseBondGenerator& bnds) const
 {
     bnds.setRmin(this->rcalclo());
     bnds.setRmax(this->rcalchi());
+    // user peak widths may depend on the orientation of the bond
+    bnds.setOrbitReduction(this->hasBondLengthPeakWidth());
 }
 
 
@@ -287,6 +315,18 @@ double DebyePDFCalculator::sfSiteAtQ(int siteidx, const double& Q) const
     return rv;
 }
 
+
+QuantityType DebyePDFCalculator::sfSiteAtQGrid(int siteidx, int n) const
+{
+    const ScatteringFactorTablePtr& sftable = this->getScatteringFactorTable();
+    const string& smbl = mstructure->siteAtomType(siteidx);
+    const double occupancy = mstructure->siteOccupancy(siteidx);
+    QuantityType rv = sftable->lookupGrid(smbl, 0.0, this->getQstep(), n);
+    QuantityType::iterator f = rv.begin();
+    for (; f != rv.end(); ++f)  *f *= occupancy;
+    return rv;
+}
+
 // Private Methods -----------------------------------------------------------
 
 QuantityType DebyePDFCalculator::getPDFAtQmin(double qmin) const
@@ -299,7 +339,12 @@ QuantityType DebyePDFCalculator::getPDFAtQmin(double qmin) const
     fill(fpad.begin(), fpad.begin() + nqmin, 0.0);
     int nfromdr = int(ceil(M_PI / this->getRstep() / this->getQstep()));
     if (nfromdr > int(fpad.size()))  fpad.resize(nfromdr, 0.0);
-    QuantityType gpad = fftftog(fpad, this->getQstep());
+    QuantityType gpad;
+    {
+        PQStatisticsTimer tm(this->activeStatistics(),
+                &PQStatistics::postprocessingtime);
+        gpad = fftftog(fpad, this->getQstep());
+    }
     const double drpad = M_PI / (gpad.size() * this->getQstep());
     QuantityType rgrid = this->getRgrid();
     QuantityType pdf0(rgrid.size());
@@ -392,6 +437,15 @@ void DebyePDFCalculator::cacheRlimitsData() const
     mrlimits_are_cached = true;
 }
 
+
+eventticker::EventTicker& DebyePDFCalculator::resultsTicker() const
+{
+    eventticker::EventTicker& tic = mresults_ticker;
+    tic.updateFrom(this->ticker());
+    tic.updateFrom(this->valueTicker());
+    return tic;
+}
+
 }   // namespace srreal
 }   // namespace diffpy
 
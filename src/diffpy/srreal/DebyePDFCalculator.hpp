@@ -104,8 +104,11 @@ class DebyePDFCalculator :
 
         // BaseDebyeSum overloads
         virtual void resetValue();
+        /// generate symmetry-unique bonds only for the built-in peak
+        /// width models, see PeakWidthModelOwner::hasBondLengthPeakWidth
         virtual void configureBondGenerator(BaseBondGenerator&) const;
         virtual double sfSiteAtQ(int, const double& Q) const;
+        virtual QuantityType sfSiteAtQGrid(int, int n) const;
 
     private:
 
@@ -121,6 +124,8 @@ class DebyePDFCalculator :
         /// r-range extension to account for tails from out-of-range peaks
         double extFromPeakTails() const;
         void cacheRlimitsData() const;
+        /// ticker for any change that affects results derived from value
+        eventticker::EventTicker& resultsTicker() const;
 
         // data
         double mqminpdf;
@@ -130,6 +135,9 @@ class DebyePDFCalculator :
         mutable int mrcalclosteps;
         mutable int mrcalchisteps;
         mutable bool mrlimits_are_cached;
+        // cache of the derived results
+        mutable eventticker::EventTicker mresults_ticker;
+        mutable QuantityCache mresults_cache;
 
         // serialization
         friend class boost::serialization::access;
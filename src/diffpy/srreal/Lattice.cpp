@@ -25,6 +25,22 @@
 using namespace std;
 using namespace diffpy::srreal;
 
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+list<R3::Vector> makeUnitCellDiagonals()
+{
+    list<R3::Vector> rv;
+    rv.push_back(R3::Vector(+1, +1, +1));
+    rv.push_back(R3::Vector(-1, +1, +1));
+    rv.push_back(R3::Vector(+1, -1, +1));
+    rv.push_back(R3::Vector(+1, +1, -1));
+    return rv;
+}
+
+}   // namespace
+
 /////////////////////////////////////////////////////////////////////////////
 // class Lattice
 /////////////////////////////////////////////////////////////////////////////
@@ -186,21 +202,21 @@ double Lattice::volume() const
 
 const R3::Vector& Lattice::cartesian(const R3::Vector& lv) const
 {
-    static R3::Vector res;
-    res = R3::mxvecproduct(lv, mbase);
+    static thread_local R3::Vector res;
+    R3::assign(res, R3::mxvecproduct(R3::toPOD(lv), R3::toPOD(mbase)));
     return res;
 }
 
 const R3::Vector& Lattice::fractional(const R3::Vector& cv) const
 {
-    static R3::Vector res;
-    res = R3::mxvecproduct(cv, mrecbase);
+    static thread_local R3::Vector res;
+    R3::assign(res, R3::mxvecproduct(R3::toPOD(cv), R3::toPOD(mrecbase)));
     return res;
 }
 
 const R3::Vector& Lattice::ucvCartesian(const R3::Vector& cv) const
 {
-    static R3::Vector res;
+    static thread_local R3::Vector res;
     res = cartesian(ucvFractional(fractional(cv)));
     return res;
 }
@@ -208,8 +224,10 @@ const R3::Vector& Lattice::ucvCartesian(const R3::Vector& cv) const
 const R3::Vector& Lattice::ucvFractional(const R3::Vector& lv) const
 {
     using mathutils::eps_eq;
-    static R3::Vector res;
-    res = lv - floor(lv);
+    static thread_local R3::Vector res;
+    res[0] = lv[0] - std::floor(lv[0]);
+    res[1] = lv[1] - std::floor(lv[1]);
+    res[2] = lv[2] - std::floor(lv[2]);
     if (eps_eq(res[0], 1.0))  res[0] = 0.0;
     if (eps_eq(res[1], 1.0))  res[1] = 0.0;
     if (eps_eq(res[2], 1.0))  res[2] = 0.0;
@@ -218,7 +236,8 @@ const R3::Vector& Lattice::ucvFractional(const R3::Vector& lv) const
 
 const R3::Matrix& Lattice::cartesianMatrix(const R3::Matrix& Ml) const
 {
-    static R3::Matrix res0, res1;
+    R3::Matrix res0;
+    static thread_local R3::Matrix res1;
     res0 = prod(Ml, mnormbase);
     res1 = prod(R3::trans(mnormbase), res0);
     return res1;
@@ -226,7 +245,8 @@ const R3::Matrix& Lattice::cartesianMatrix(const R3::Matrix& Ml) const
 
 const R3::Matrix& Lattice::fractionalMatrix(const R3::Matrix& Mc) const
 {
-    static R3::Matrix res0, res1;
+    R3::Matrix res0;
+    static thread_local R3::Matrix res1;
     res0 = prod(Mc, mrecnormbase);
     res1 = prod(R3::trans(mrecnormbase), res0);
     return res1;
@@ -235,17 +255,10 @@ const R3::Matrix& Lattice::fractionalMatrix(const R3::Matrix& Mc) const
 
 const R3::Vector& Lattice::ucMaxDiagonal() const
 {
-    static list<R3::Vector> ucdiagonals;
-    if (ucdiagonals.empty())
-    {
-        ucdiagonals.push_back(R3::Vector(+1, +1, +1));
-        ucdiagonals.push_back(R3::Vector(-1, +1, +1));
-        ucdiagonals.push_back(R3::Vector(+1, -1, +1));
-        ucdiagonals.push_back(R3::Vector(+1, +1, -1));
-    }
+    static const list<R3::Vector> ucdiagonals = makeUnitCellDiagonals();
     double maxnorm = -1;
-    list<R3::Vector>::iterator ucd;
-    list<R3::Vector>::iterator maxucd = ucdiagonals.end();
+    list<R3::Vector>::const_iterator ucd;
+    list<R3::Vector>::const_iterator maxucd = ucdiagonals.end();
     for (ucd = ucdiagonals.begin(); ucd != ucdiagonals.end(); ++ucd)
     {
         double normucd = this->norm(*ucd);
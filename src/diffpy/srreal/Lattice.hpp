@@ -112,6 +112,7 @@ class Lattice
         template <class V>
             double anglerad(const V& u, const V& v) const;
         // conversion of coordinates and tensors
+        // the results are per-thread buffers valid until the next call
         const R3::Vector& cartesian(const R3::Vector& lv) const;
         template <class V>
             const R3::Vector& cartesian(const V& lv) const;
@@ -489,10 +490,7 @@ double Lattice::norm(const V& u) const
 template <class V>
 double Lattice::distance(const V& u, const V& v) const
 {
-    static R3::Vector duv;
-    duv[0] = u[0] - v[0];
-    duv[1] = u[1] - v[1];
-    duv[2] = u[2] - v[2];
+    R3::Vector duv(u[0] - v[0], u[1] - v[1], u[2] - v[2]);
     return this->norm(duv);
 }
 
@@ -517,10 +515,7 @@ double Lattice::anglerad(const V& u, const V& v) const
 template <class V>
 const R3::Vector& Lattice::cartesian(const V& lv) const
 {
-    static R3::Vector lvcopy;
-    lvcopy[0] = lv[0];
-    lvcopy[1] = lv[1];
-    lvcopy[2] = lv[2];
+    R3::Vector lvcopy(lv[0], lv[1], lv[2]);
     return this->cartesian(lvcopy);
 }
 
@@ -528,10 +523,7 @@ const R3::Vector& Lattice::cartesian(const V& lv) const
 template <class V>
 const R3::Vector& Lattice::fractional(const V& cv) const
 {
-    static R3::Vector cvcopy;
-    cvcopy[0] = cv[0];
-    cvcopy[1] = cv[1];
-    cvcopy[2] = cv[2];
+    R3::Vector cvcopy(cv[0], cv[1], cv[2]);
     return this->fractional(cvcopy);
 }
 
@@ -539,10 +531,7 @@ const R3::Vector& Lattice::fractional(const V& cv) const
 template <class V>
 const R3::Vector& Lattice::ucvCartesian(const V& cv) const
 {
-    static R3::Vector cvcopy;
-    cvcopy[0] = cv[0];
-    cvcopy[1] = cv[1];
-    cvcopy[2] = cv[2];
+    R3::Vector cvcopy(cv[0], cv[1], cv[2]);
     return this->ucvCartesian(cvcopy);
 }
 
@@ -550,10 +539,7 @@ const R3::Vector& Lattice::ucvCartesian(const V& cv) const
 template <class V>
 const R3::Vector& Lattice::ucvFractional(const V& cv) const
 {
-    static R3::Vector cvcopy;
-    cvcopy[0] = cv[0];
-    cvcopy[1] = cv[1];
-    cvcopy[2] = cv[2];
+    R3::Vector cvcopy(cv[0], cv[1], cv[2]);
     return ucvFractional(cvcopy);
 }
 
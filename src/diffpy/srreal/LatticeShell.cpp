@@ -0,0 +1,117 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class LatticeShell -- Cartesian lattice vectors within a spherical shell
+*     sorted by their length.
+*
+* getLatticeShell -- return shared LatticeShell instance from a process-wide
+*     cache.
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+#include <diffpy/srreal/LatticeShell.hpp>
+#include <diffpy/srreal/PointsInSphere.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Constants -----------------------------------------------------------
+
+namespace {
+
+/// limit on the number of shells kept by getLatticeShell
+const size_t MAX_CACHED_SHELLS = 16;
+
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// class LatticeShell
+//////////////////////////////////////////////////////////////////////////////
+
+// Constructor ---------------------------------------------------------------
+
+LatticeShell::LatticeShell(const Lattice& L, double rmin, double rmax)
+{
+    R3::PODVectorArray cvectors;
+    vector< pair<double, int> > lengthindex;
+    PointsInSphere sph(rmin, rmax, L);
+    for (sph.rewind(); !sph.finished(); sph.next())
+    {
+        lengthindex.push_back(make_pair(sph.r(), int(cvectors.size())));
+        cvectors.push_back(R3::toPOD(L.cartesian(sph.mno())));
+    }
+    // sort by length and keep the PointsInSphere order for equal lengths
+    sort(lengthindex.begin(), lengthindex.end());
+    mvectors.reserve(cvectors.size());
+    mlengths.reserve(cvectors.size());
+    vector< pair<double, int> >::const_iterator li = lengthindex.begin();
+    for (; li != lengthindex.end(); ++li)
+    {
+        mlengths.push_back(li->first);
+        mvectors.push_back(cvectors[li->second]);
+    }
+}
+
+// Public Methods ------------------------------------------------------------
+
+int LatticeShell::lowerBound(double r) const
+{
+    return lower_bound(mlengths.begin(), mlengths.end(), r) - mlengths.begin();
+}
+
+
+int LatticeShell::upperBound(double r) const
+{
+    return upper_bound(mlengths.begin(), mlengths.end(), r) - mlengths.begin();
+}
+
+// Functions -----------------------------------------------------------------
+
+LatticeShellConstPtr getLatticeShell(
+        const Lattice& L, double rmin, double rmax)
+{
+    typedef vector<double> ShellKey;
+    static mutex cachemutex;
+    static map<ShellKey, LatticeShellConstPtr> cache;
+    const R3::Matrix& base = L.base();
+    ShellKey key;
+    for (int i = 0; i < R3::Ndim; ++i)
+    {
+        for (int j = 0; j < R3::Ndim; ++j)  key.push_back(base(i, j));
+    }
+    key.push_back(rmin);
+    key.push_back(rmax);
+    {
+        lock_guard<mutex> lock(cachemutex);
+        map<ShellKey, LatticeShellConstPtr>::const_iterator ii;
+        ii = cache.find(key);
+        if (ii != cache.end())  return ii->second;
+    }
+    LatticeShellConstPtr rv(new LatticeShell(L, rmin, rmax));
+    lock_guard<mutex> lock(cachemutex);
+    if (cache.size() >= MAX_CACHED_SHELLS)  cache.clear();
+    cache[key] = rv;
+    return rv;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
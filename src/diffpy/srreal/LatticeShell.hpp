@@ -0,0 +1,70 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class LatticeShell -- Cartesian lattice vectors within a spherical shell
+*     sorted by their length.
+*
+* getLatticeShell -- return shared LatticeShell instance from a process-wide
+*     cache, so that the vectors are evaluated only once for the same
+*     lattice and shell radii.
+*
+*****************************************************************************/
+
+#ifndef LATTICESHELL_HPP_INCLUDED
+#define LATTICESHELL_HPP_INCLUDED
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include <diffpy/srreal/Lattice.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class LatticeShell
+{
+    public:
+
+        // constructor
+        LatticeShell(const Lattice& L, double rmin, double rmax);
+
+        // methods
+        int size() const  { return mvectors.size(); }
+        /// Cartesian coordinates of the i-th lattice vector
+        const R3::PODVector& cartesian(int i) const  { return mvectors[i]; }
+        /// length of the i-th lattice vector
+        const double& r(int i) const  { return mlengths[i]; }
+        /// index of the first vector that is not shorter than r
+        int lowerBound(double r) const;
+        /// index of the first vector that is longer than r
+        int upperBound(double r) const;
+
+    private:
+
+        // data
+        R3::PODVectorArray mvectors;
+        std::vector<double> mlengths;
+};
+
+typedef boost::shared_ptr<const LatticeShell> LatticeShellConstPtr;
+
+/// Return lattice vectors with lengths in the [rmin, rmax] range.
+/// The instances are shared and must not be modified.
+LatticeShellConstPtr getLatticeShell(
+        const Lattice& L, double rmin, double rmax);
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // LATTICESHELL_HPP_INCLUDED
@@ -26,9 +26,8 @@ namespace srreal {
 
 // Constructors --------------------------------------------------------------
 
-LinearBaseline::LinearBaseline()
+LinearBaseline::LinearBaseline() : mslope(0.0)
 {
-    this->setSlope(0.0);
     this->registerDoubleAttribute("slope", this,
             &LinearBaseline::getSlope,
             &LinearBaseline::setSlope);
@@ -63,8 +62,16 @@ double LinearBaseline::operator()(const double& r) const
 }
 
 
+void LinearBaseline::apply(const double* r, double* y, size_t n) const
+{
+    const double slope = this->getSlope();
+    for (size_t i = 0; i < n; ++i)  y[i] += slope * r[i];
+}
+
+
 void LinearBaseline::setSlope(double sc)
 {
+    if (mslope != sc)  mticker.click();
     mslope = sc;
 }
 
@@ -39,6 +39,7 @@ class LinearBaseline : public PDFBaseline
         // methods
         const std::string& type() const;
         double operator()(const double& r) const;
+        void apply(const double* r, double* y, size_t n) const;
         void setSlope(double sc);
         const double& getSlope() const;
 
@@ -0,0 +1,223 @@
+/*****************************************************************************
+*
+* libdiffpy         by DANSE Diffraction group
+*                   Simon J. L. Billinge
+*                   (c) 2009 The Trustees of Columbia University
+*                   in the City of New York.  All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE_DANSE.txt for license information.
+*
+******************************************************************************
+*
+* class LookupTableProfile -- peak profile interpolated from a table of
+*     another profile sampled at unit FWHM.
+*     Registered as "gaussian-lut" and "croppedgaussian-lut".
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+#include <diffpy/srreal/LookupTableProfile.hpp>
+#include <diffpy/srreal/GaussianProfile.hpp>
+#include <diffpy/srreal/CroppedGaussianProfile.hpp>
+#include <diffpy/validators.hpp>
+#include <diffpy/serialization.ipp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+using namespace diffpy::validators;
+
+// Local Constants -----------------------------------------------------------
+
+namespace {
+
+const double DEFAULT_LOOKUPTABLE_ACCURACY = 1e-6;
+/// number of intervals in the initial table
+const int MIN_TABLE_INTERVALS = 64;
+/// upper limit for the table size when refining to the accuracy target
+const int MAX_TABLE_INTERVALS = 1 << 22;
+
+}   // namespace
+
+// Constructors --------------------------------------------------------------
+
+LookupTableProfile::LookupTableProfile() :
+    mprofile(new GaussianProfile),
+    maccuracy(DEFAULT_LOOKUPTABLE_ACCURACY)
+{
+    mtype = mprofile->type() + "-lut";
+    this->PeakProfile::setPrecision(mprofile->getPrecision());
+    this->registerDoubleAttribute("lutaccuracy", this,
+            &LookupTableProfile::getAccuracy,
+            &LookupTableProfile::setAccuracy);
+    this->updateTable(maccuracy);
+}
+
+
+LookupTableProfile::LookupTableProfile(PeakProfilePtr profile) :
+    maccuracy(DEFAULT_LOOKUPTABLE_ACCURACY)
+{
+    ensureNonNull("PeakProfile", profile);
+    mprofile = profile->clone();
+    mtype = mprofile->type() + "-lut";
+    this->PeakProfile::setPrecision(mprofile->getPrecision());
+    this->registerDoubleAttribute("lutaccuracy", this,
+            &LookupTableProfile::getAccuracy,
+            &LookupTableProfile::setAccuracy);
+    this->updateTable(maccuracy);
+}
+
+
+PeakProfilePtr LookupTableProfile::create() const
+{
+    PeakProfilePtr rv(new LookupTableProfile(mprofile->create()));
+    return rv;
+}
+
+
+PeakProfilePtr LookupTableProfile::clone() const
+{
+    boost::shared_ptr<LookupTableProfile> rv(new LookupTableProfile(*this));
+    rv->mprofile = mprofile->clone();
+    return rv;
+}
+
+// Public Methods ------------------------------------------------------------
+
+const string& LookupTableProfile::type() const
+{
+    return mtype;
+}
+
+
+double LookupTableProfile::operator()(double x, double fwhm) const
+{
+    if (fwhm <= 0)  return 0.0;
+    double rv = this->interpolate(x / fwhm) / fwhm;
+    return rv;
+}
+
+
+double LookupTableProfile::xboundlo(double fwhm) const
+{
+    double rv = (fwhm <= 0.0) ? 0.0 : (mxrello * fwhm);
+    return rv;
+}
+
+
+double LookupTableProfile::xboundhi(double fwhm) const
+{
+    double rv = (fwhm <= 0.0) ? 0.0 : (mxrelhi * fwhm);
+    return rv;
+}
+
+
+void LookupTableProfile::setPrecision(double eps)
+{
+    mprofile->setPrecision(eps);
+    // use the precision value as adjusted by the wrapped profile
+    this->PeakProfile::setPrecision(mprofile->getPrecision());
+    this->updateTable(maccuracy);
+}
+
+
+void LookupTableProfile::setAccuracy(double accuracy)
+{
+    // relative accuracy may be below the tolerance of eps_gt
+    if (!(accuracy > 0.0))
+    {
+        const char* emsg = "lutaccuracy must be positive.";
+        throw invalid_argument(emsg);
+    }
+    if (maccuracy == accuracy)  return;
+    this->updateTable(accuracy);
+    mticker.click();
+}
+
+
+const double& LookupTableProfile::getAccuracy() const
+{
+    return maccuracy;
+}
+
+
+PeakProfilePtr LookupTableProfile::getProfile() const
+{
+    return mprofile->clone();
+}
+
+
+int LookupTableProfile::countTablePoints() const
+{
+    return mtable.size();
+}
+
+// Private Methods -----------------------------------------------------------
+
+void LookupTableProfile::updateTable(double accuracy)
+{
+    const PeakProfile& pkf = *mprofile;
+    const double xrello = pkf.xboundlo(1.0);
+    const double xrelhi = pkf.xboundhi(1.0);
+    vector<double> table;
+    double dxrel = 0.0;
+    // sample the end points from inside, the wrapped profile
+    // may be cropped to zero exactly at its bounds.
+    const double xrello1 = nextafter(xrello, xrelhi);
+    const double xrelhi1 = nextafter(xrelhi, xrello);
+    for (int n = MIN_TABLE_INTERVALS; xrello < xrelhi; n *= 2)
+    {
+        if (n > MAX_TABLE_INTERVALS)
+        {
+            const char* emsg =
+                "Lookup table cannot reach the requested lutaccuracy.";
+            throw invalid_argument(emsg);
+        }
+        dxrel = (xrelhi - xrello) / n;
+        table.resize(n + 1);
+        table.front() = pkf(xrello1, 1.0);
+        table.back() = pkf(xrelhi1, 1.0);
+        for (int i = 1; i < n; ++i)  table[i] = pkf(xrello + i * dxrel, 1.0);
+        double ymax = 0.0;
+        for (int i = 0; i <= n; ++i)  ymax = max(ymax, fabs(table[i]));
+        // check interpolation error at the interval midpoints
+        const double maxerror = accuracy * ymax;
+        bool accurate = true;
+        for (int i = 0; i < n && accurate; ++i)
+        {
+            const double xm = xrello + (i + 0.5) * dxrel;
+            const double ym = 0.5 * (table[i] + table[i + 1]);
+            accurate = (fabs(ym - pkf(xm, 1.0)) <= maxerror);
+        }
+        if (accurate)  break;
+    }
+    maccuracy = accuracy;
+    mxrello = xrello;
+    mxrelhi = xrelhi;
+    mdxrel = dxrel;
+    mtable.swap(table);
+}
+
+// Registration --------------------------------------------------------------
+
+bool reg_LookupTableProfile = LookupTableProfile().registerThisType();
+bool reg_CroppedLookupTableProfile = LookupTableProfile(
+        PeakProfilePtr(new CroppedGaussianProfile)).registerThisType();
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+DIFFPY_INSTANTIATE_SERIALIZATION(diffpy::srreal::LookupTableProfile)
+BOOST_CLASS_EXPORT_IMPLEMENT(diffpy::srreal::LookupTableProfile)
+
+// End of file
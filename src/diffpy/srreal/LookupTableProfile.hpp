@@ -0,0 +1,119 @@
+/*****************************************************************************
+*
+* libdiffpy         by DANSE Diffraction group
+*                   Simon J. L. Billinge
+*                   (c) 2009 The Trustees of Columbia University
+*                   in the City of New York.  All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE_DANSE.txt for license information.
+*
+******************************************************************************
+*
+* class LookupTableProfile -- peak profile interpolated from a table of
+*     another profile sampled at unit FWHM.  This assumes the wrapped
+*     profile is shape invariant, i.e., f(x, fwhm) = f(x / fwhm, 1) / fwhm.
+*     Registered as "gaussian-lut" and "croppedgaussian-lut".
+*
+*****************************************************************************/
+
+#ifndef LOOKUPTABLEPROFILE_HPP_INCLUDED
+#define LOOKUPTABLEPROFILE_HPP_INCLUDED
+
+#include <vector>
+#include <boost/serialization/vector.hpp>
+
+#include <diffpy/srreal/PeakProfile.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+template <class TProfile> class PeakShape;
+
+class LookupTableProfile : public PeakProfile
+{
+    public:
+
+        // constructors
+        LookupTableProfile();
+        explicit LookupTableProfile(PeakProfilePtr profile);
+        PeakProfilePtr create() const;
+        PeakProfilePtr clone() const;
+
+        // methods
+        const std::string& type() const;
+        double operator()(double x, double fwhm) const;
+        double xboundlo(double fwhm) const;
+        double xboundhi(double fwhm) const;
+        void setPrecision(double eps);
+        /// set maximum interpolation error relative to the peak maximum
+        void setAccuracy(double accuracy);
+        /// maximum interpolation error relative to the peak maximum
+        const double& getAccuracy() const;
+        /// peak profile approximated by the table
+        PeakProfilePtr getProfile() const;
+        /// number of points in the lookup table
+        int countTablePoints() const;
+
+    private:
+
+        // methods
+        void updateTable(double accuracy);
+        double interpolate(double xrel) const;
+
+        // data
+        PeakProfilePtr mprofile;
+        std::string mtype;
+        double maccuracy;
+        double mxrello;
+        double mxrelhi;
+        double mdxrel;
+        std::vector<double> mtable;
+
+        // fast evaluation in PDFKernel
+        friend class PeakShape<LookupTableProfile>;
+
+        // serialization
+        friend class boost::serialization::access;
+
+        template<class Archive>
+            void serialize(Archive& ar, const unsigned int version)
+        {
+            using boost::serialization::base_object;
+            ar & base_object<PeakProfile>(*this);
+            ar & mprofile;
+            ar & mtype;
+            ar & maccuracy;
+            ar & mxrello;
+            ar & mxrelhi;
+            ar & mdxrel;
+            ar & mtable;
+        }
+
+};
+
+// Inline Methods ------------------------------------------------------------
+
+/// linear interpolation of the table at x / fwhm, zero outside the table
+inline
+double LookupTableProfile::interpolate(double xrel) const
+{
+    const int ilast = int(mtable.size()) - 1;
+    double t = (xrel - mxrello) / mdxrel;
+    if (!(t >= 0 && t <= ilast))  return 0.0;
+    int i = (int(t) < ilast) ? int(t) : (ilast - 1);
+    double w = t - i;
+    double rv = (1 - w) * mtable[i] + w * mtable[i + 1];
+    return rv;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+BOOST_CLASS_EXPORT_KEY(diffpy::srreal::LookupTableProfile)
+
+#endif  // LOOKUPTABLEPROFILE_HPP_INCLUDED
@@ -0,0 +1,714 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class NUFFTDebyeSum -- orientationally averaged scattering of a finite
+*     structure evaluated with a non-uniform fast Fourier transformation.
+*
+*****************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_fft_complex.h>
+
+#include <diffpy/srreal/NUFFTDebyeSum.hpp>
+#include <diffpy/srreal/PDFUtils.hpp>
+#include <diffpy/validators.hpp>
+#include <diffpy/serialization.ipp>
+
+using namespace std;
+using namespace diffpy::validators;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+const double DEFAULT_NUFFT_PRECISION = 1e-6;
+/// maximum number of species, the cost grows with their squared count
+const int MAX_NUFFT_SPECIES = 32;
+
+/// Atoms of the same type and isotropic displacement share the weights
+/// f(Q) exp(-0.5 Uiso Q^2) and are gridded together.  With binning the
+/// uiso is the mean over the atoms in the species.
+struct Species
+{
+    string smbl;
+    double uiso;
+    vector<R3::Vector> xyz;
+    vector<double> occupancy;
+    double sumsqocc;
+    QuantityType weight;
+};
+
+
+/// Smallest integer at least n that factors into 2, 3 and 5,
+/// which are efficient lengths for the mixed-radix FFT.
+int fftSmoothLength(int n)
+{
+    for (int rv = max(n, 1); true; ++rv)
+    {
+        int m = rv;
+        for (int p : {2, 3, 5})  while (m % p == 0)  m /= p;
+        if (m == 1)  return rv;
+    }
+}
+
+
+/// Number of Gaussian kernel points on each side of an atom
+int spreadingWidth(double precision)
+{
+    precision = max(precision, 1e-16);
+    return max(2, min(16, int(ceil(-log10(precision)))));
+}
+
+
+/// Spacing of the real-space grid that is oversampled twice for
+/// the wavevectors up to qlast.
+double gridStep(double qlast)
+{
+    return M_PI / (2 * qlast);
+}
+
+
+/// Grid shape that holds the autocorrelation of the blurred density
+/// without wrapping.  The last dimension is even for the real transform.
+void gridShape(int shape[R3::Ndim], const R3::Vector& xyzlo,
+        const R3::Vector& xyzhi, double rstep, int msp)
+{
+    for (int j = 0; j < R3::Ndim; ++j)
+    {
+        const double boxsize =
+            2 * (xyzhi[j] - xyzlo[j]) + 2 * (msp + 1) * rstep;
+        shape[j] = fftSmoothLength(int(ceil(boxsize / rstep)));
+    }
+    const int j = R3::Ndim - 1;
+    shape[j] = 2 * fftSmoothLength((shape[j] + 1) / 2);
+}
+
+
+/// Default limit for the grid memory, a half of the physical memory
+double defaultGridMemory()
+{
+    const double npages = sysconf(_SC_PHYS_PAGES);
+    const double pagesize = sysconf(_SC_PAGE_SIZE);
+    if (npages <= 0 || pagesize <= 0)  return numeric_limits<double>::max();
+    return 0.5 * npages * pagesize;
+}
+
+
+/// Resources of the GSL mixed-radix complex FFT of a given length
+class ComplexFFT
+{
+    public:
+
+        explicit ComplexFFT(size_t n) :
+            mwavetable(gsl_fft_complex_wavetable_alloc(n)),
+            mworkspace(gsl_fft_complex_workspace_alloc(n))
+        {
+            if (!mwavetable || !mworkspace)
+            {
+                this->release();
+                throw bad_alloc();
+            }
+        }
+
+        ~ComplexFFT()
+        {
+            this->release();
+        }
+
+        /// unnormalized transform of packed complex array in place
+        void transform(double* data, size_t stride, gsl_fft_direction sign)
+        {
+            const char* emsg = "Failed evaluation of the complex FFT.";
+            int status = gsl_fft_complex_transform(data, stride,
+                    mwavetable->n, mwavetable, mworkspace, sign);
+            if (status != GSL_SUCCESS)  throw runtime_error(emsg);
+        }
+
+    private:
+
+        gsl_fft_complex_wavetable* mwavetable;
+        gsl_fft_complex_workspace* mworkspace;
+
+        void release()
+        {
+            if (mworkspace)  gsl_fft_complex_workspace_free(mworkspace);
+            if (mwavetable)  gsl_fft_complex_wavetable_free(mwavetable);
+            mworkspace = NULL;
+            mwavetable = NULL;
+        }
+
+        // non-copyable
+        ComplexFFT(const ComplexFFT&);
+        ComplexFFT& operator=(const ComplexFFT&);
+};
+
+
+/// Real-to-complex 3D transform on nx x ny x nz grid with even nz.
+/// Real grid values are stored in rows of nz doubles padded to nz + 2.
+/// The spectrum keeps only the nz / 2 + 1 non-negative frequencies
+/// along z, the rest follows from the Hermitian symmetry.  The rows are
+/// transformed as complex arrays of half length.
+class RealFFT3D
+{
+    public:
+
+        RealFFT3D(const int shape[R3::Ndim]) :
+            mnx(shape[0]), mny(shape[1]), mnz(shape[2]),
+            mnzh(shape[2] / 2 + 1),
+            mfftx(shape[0]), mffty(shape[1]), mfftz(shape[2] / 2),
+            mtwiddle(mnzh), mrow(mnzh)
+        {
+            assert(mnz % 2 == 0);
+            for (int k = 0; k < mnzh; ++k)
+            {
+                mtwiddle[k] = polar(1.0, -2 * M_PI * k / mnz);
+            }
+        }
+
+        /// number of doubles in the grid array
+        size_t countDoubles() const
+        {
+            return 2 * size_t(mnx) * mny * mnzh;
+        }
+
+        /// index of the first real value in the z-row at ix, iy
+        size_t rowIndex(int ix, int iy) const
+        {
+            return 2 * (size_t(ix) * mny + iy) * mnzh;
+        }
+
+        /// transform of real values to the half spectrum in place
+        void forward(vector<double>& data)
+        {
+            assert(data.size() == this->countDoubles());
+            const int m = mnz / 2;
+            const complex<double> mhalfi(0.0, -0.5);
+            for (size_t r = 0; r < size_t(mnx) * mny; ++r)
+            {
+                double* row = &data[2 * r * mnzh];
+                mfftz.transform(row, 1, gsl_fft_forward);
+                // separate transforms of the even and odd values
+                complex<double>* z = reinterpret_cast<complex<double>*>(row);
+                copy(z, z + m, mrow.begin());
+                mrow[m] = mrow[0];
+                for (int k = 0; k <= m; ++k)
+                {
+                    const complex<double> zc = conj(mrow[m - k]);
+                    const complex<double> ek = 0.5 * (mrow[k] + zc);
+                    const complex<double> ok = mhalfi * (mrow[k] - zc);
+                    z[k] = ek + mtwiddle[k] * ok;
+                }
+            }
+            this->transformXY(data, gsl_fft_forward);
+        }
+
+        /// unnormalized inverse, real values are scaled by nx ny nz
+        void backward(vector<double>& data)
+        {
+            assert(data.size() == this->countDoubles());
+            this->transformXY(data, gsl_fft_backward);
+            const int m = mnz / 2;
+            const complex<double> iunit(0.0, 1.0);
+            for (size_t r = 0; r < size_t(mnx) * mny; ++r)
+            {
+                double* row = &data[2 * r * mnzh];
+                complex<double>* z = reinterpret_cast<complex<double>*>(row);
+                copy(z, z + m + 1, mrow.begin());
+                for (int k = 0; k < m; ++k)
+                {
+                    const complex<double> xc = conj(mrow[m - k]);
+                    z[k] = (mrow[k] + xc) +
+                        iunit * conj(mtwiddle[k]) * (mrow[k] - xc);
+                }
+                z[m] = 0.0;
+                mfftz.transform(row, 1, gsl_fft_backward);
+            }
+        }
+
+    private:
+
+        int mnx;
+        int mny;
+        int mnz;
+        int mnzh;
+        ComplexFFT mfftx;
+        ComplexFFT mffty;
+        ComplexFFT mfftz;
+        vector< complex<double> > mtwiddle;
+        vector< complex<double> > mrow;
+
+        void transformXY(vector<double>& data, gsl_fft_direction sign)
+        {
+            for (int ix = 0; ix < mnx; ++ix)
+            {
+                for (int kz = 0; kz < mnzh; ++kz)
+                {
+                    size_t i = size_t(ix) * mny * mnzh + kz;
+                    mffty.transform(&data[2 * i], mnzh, sign);
+                }
+            }
+            const size_t nyz = size_t(mny) * mnzh;
+            for (size_t iyz = 0; iyz < nyz; ++iyz)
+            {
+                mfftx.transform(&data[2 * iyz], nyz, sign);
+            }
+        }
+
+        // non-copyable
+        RealFFT3D(const RealFFT3D&);
+        RealFFT3D& operator=(const RealFFT3D&);
+};
+
+
+/// Lower and upper corner of the Cartesian positions in the structure
+void boundingBox(const StructureAdapter& stru,
+        R3::Vector& xyzlo, R3::Vector& xyzhi)
+{
+    xyzlo = R3::zerovector;
+    xyzhi = R3::zerovector;
+    const int cntsites = stru.countSites();
+    for (int i = 0; i < cntsites; ++i)
+    {
+        const R3::Vector& xyz = stru.siteCartesianPosition(i);
+        for (int j = 0; j < R3::Ndim; ++j)
+        {
+            xyzlo[j] = i ? min(xyzlo[j], xyz[j]) : xyz[j];
+            xyzhi[j] = i ? max(xyzhi[j], xyz[j]) : xyz[j];
+        }
+    }
+}
+
+
+/// Cross spectrum b0 conj(b1) of packed complex arrays, rv may be b1
+void crossSpectrum(const vector<double>& b0, const vector<double>& b1,
+        vector<double>& rv)
+{
+    assert(b0.size() == b1.size());
+    rv.resize(b0.size());
+    for (size_t i = 0; i < b0.size(); i += 2)
+    {
+        const double re = b0[i] * b1[i] + b0[i + 1] * b1[i + 1];
+        const double im = b0[i + 1] * b1[i] - b0[i] * b1[i + 1];
+        rv[i] = re;
+        rv[i + 1] = im;
+    }
+}
+
+}   // namespace
+
+// Constructor ---------------------------------------------------------------
+
+NUFFTDebyeSum::NUFFTDebyeSum() :
+    mqmin(0.0),
+    mqmax(DEFAULT_QGRID_QMAX),
+    mqstep(DEFAULT_QGRID_QSTEP),
+    mnufftprecision(DEFAULT_NUFFT_PRECISION),
+    mmaxgridmemory(0.0),
+    muisostep(0.0)
+{
+    // default configuration
+    this->setScatteringFactorTableByType("xray");
+    // attributes
+    this->registerDoubleAttribute("qmin", this,
+            &NUFFTDebyeSum::getQmin, &NUFFTDebyeSum::setQmin);
+    this->registerDoubleAttribute("qmax", this,
+            &NUFFTDebyeSum::getQmax, &NUFFTDebyeSum::setQmax);
+    this->registerDoubleAttribute("qstep", this,
+            &NUFFTDebyeSum::getQstep, &NUFFTDebyeSum::setQstep);
+    this->registerDoubleAttribute("nufftprecision", this,
+            &NUFFTDebyeSum::getNUFFTPrecision,
+            &NUFFTDebyeSum::setNUFFTPrecision);
+    this->registerDoubleAttribute("maxgridmemory", this,
+            &NUFFTDebyeSum::getMaxGridMemory,
+            &NUFFTDebyeSum::setMaxGridMemory);
+    this->registerDoubleAttribute("uisostep", this,
+            &NUFFTDebyeSum::getUisoStep,
+            &NUFFTDebyeSum::setUisoStep);
+}
+
+// Public Methods ------------------------------------------------------------
+
+const QuantityType& NUFFTDebyeSum::eval(StructureAdapterPtr stru)
+{
+    const int nqpts = pdfutils_qmaxSteps(this);
+    const int kqlo = min(pdfutils_qminSteps(this), nqpts);
+    mvalue.assign(nqpts, 0.0);
+    mfscale.assign(nqpts, 0.0);
+    if (stru->numberDensity() > 0.0)
+    {
+        const char* emsg = "NUFFTDebyeSum requires finite structure.";
+        throw invalid_argument(emsg);
+    }
+    // group atoms by species, Uiso values are binned when uisostep > 0
+    const int cntsites = stru->countSites();
+    const double uisostep = this->getUisoStep();
+    map<pair<string, double>, int> speciesindex;
+    vector<Species> species;
+    double totocc = 0.0;
+    for (int i = 0; i < cntsites; ++i)
+    {
+        if (stru->siteMultiplicity(i) != 1)
+        {
+            const char* emsg = "NUFFTDebyeSum requires sites "
+                "with unit multiplicity.";
+            throw invalid_argument(emsg);
+        }
+        const R3::Matrix& U = stru->siteCartesianUij(i);
+        const double uiso = (U(0, 0) + U(1, 1) + U(2, 2)) / 3.0;
+        const string& smbl = stru->siteAtomType(i);
+        const double ukey = (uisostep > 0) ? round(uiso / uisostep) : uiso;
+        auto spi = speciesindex.insert(
+                make_pair(make_pair(smbl, ukey), int(species.size())));
+        if (spi.second)
+        {
+            if (int(species.size()) == MAX_NUFFT_SPECIES)
+            {
+                ostringstream emsg;
+                emsg << "NUFFTDebyeSum supports at most " <<
+                    MAX_NUFFT_SPECIES << " pairs of atom type and Uiso.  " <<
+                    "Increase uisostep to bin the Uiso values.";
+                throw invalid_argument(emsg.str());
+            }
+            species.push_back(Species());
+            species.back().smbl = smbl;
+            species.back().uiso = 0.0;
+            species.back().sumsqocc = 0.0;
+        }
+        Species& sp = species[spi.first->second];
+        const double occ = stru->siteOccupancy(i);
+        sp.xyz.push_back(stru->siteCartesianPosition(i));
+        sp.uiso += (uiso - sp.uiso) / sp.xyz.size();
+        sp.occupancy.push_back(occ);
+        sp.sumsqocc += occ * occ;
+        totocc += occ;
+    }
+    if (species.empty() || nqpts <= 1)  return mvalue;
+    const double qstep = this->getQstep();
+    const ScatteringFactorTablePtr& sftable = this->getScatteringFactorTable();
+    for (Species& sp : species)
+    {
+        sp.weight = sftable->lookupGrid(sp.smbl, 0.0, qstep, nqpts);
+        for (int kq = 0; kq < nqpts; ++kq)
+        {
+            const double q = kq * qstep;
+            sp.weight[kq] *= exp(-0.5 * sp.uiso * q * q);
+        }
+    }
+    // Gaussian gridding parameters after Greengard and Lee for twice
+    // oversampled grid.  The blur variance tau is in squared Angstroms.
+    const double qlast = nqpts * qstep;
+    const int msp = spreadingWidth(this->getNUFFTPrecision());
+    const double rstep = gridStep(qlast);
+    const double tau = msp * rstep * rstep / (3 * M_PI);
+    R3::Vector xyzlo, xyzhi;
+    boundingBox(*stru, xyzlo, xyzhi);
+    int shape[R3::Ndim];
+    gridShape(shape, xyzlo, xyzhi, rstep, msp);
+    // keep spectra of all species when they fit in the memory limit,
+    // otherwise recompute them for each pair of species
+    const int nspecies = species.size();
+    const double gridbytes = this->estimateGridMemory(stru);
+    const double maxbytes = (mmaxgridmemory > 0.0) ?
+        mmaxgridmemory : defaultGridMemory();
+    const bool keepspectra = ((nspecies + 1) * gridbytes <= maxbytes);
+    if (2 * gridbytes > maxbytes)
+    {
+        ostringstream emsg;
+        emsg << "NUFFTDebyeSum needs " << 2 * gridbytes / 1e9 <<
+            " GB for the Fourier grids above the limit of " <<
+            maxbytes / 1e9 << " GB.  Reduce Qmax or the structure size.";
+        throw runtime_error(emsg.str());
+    }
+    RealFFT3D fft(shape);
+    const size_t ntotal = size_t(shape[0]) * shape[1] * shape[2];
+    auto fineindex = [](int m, int n) { return (m % n + n) % n; };
+    vector<int> mlo(R3::Ndim);
+    vector< vector<double> > kernel(R3::Ndim, vector<double>(2 * msp));
+    // spread species density to the real grid and transform
+    auto speciesSpectrum = [&](const Species& sp, vector<double>& grid) {
+        grid.assign(fft.countDoubles(), 0.0);
+        for (size_t n = 0; n < sp.xyz.size(); ++n)
+        {
+            for (int j = 0; j < R3::Ndim; ++j)
+            {
+                const double x = sp.xyz[n][j] - xyzlo[j];
+                mlo[j] = int(floor(x / rstep)) - msp + 1;
+                for (int m = 0; m < 2 * msp; ++m)
+                {
+                    const double dx = x - (mlo[j] + m) * rstep;
+                    kernel[j][m] = exp(-dx * dx / (4 * tau));
+                }
+            }
+            for (int mx = 0; mx < 2 * msp; ++mx)
+            {
+                const int ix = fineindex(mlo[0] + mx, shape[0]);
+                const double wx = sp.occupancy[n] * kernel[0][mx];
+                for (int my = 0; my < 2 * msp; ++my)
+                {
+                    const int iy = fineindex(mlo[1] + my, shape[1]);
+                    const double wxy = wx * kernel[1][my];
+                    double* row = &grid[fft.rowIndex(ix, iy)];
+                    for (int mz = 0; mz < 2 * msp; ++mz)
+                    {
+                        const int iz = fineindex(mlo[2] + mz, shape[2]);
+                        row[iz] += wxy * kernel[2][mz];
+                    }
+                }
+            }
+        }
+        fft.forward(grid);
+    };
+    vector< vector<double> > spectra(keepspectra ? nspecies : 0);
+    for (int t = 0; t < int(spectra.size()); ++t)
+    {
+        speciesSpectrum(species[t], spectra[t]);
+    }
+    // Radial distribution of the blurred autocorrelation is accumulated
+    // by the squared length of integer grid offsets, which avoids any
+    // binning.  Offsets beyond the largest pair distance are skipped.
+    R3::Vector diagonal = xyzhi - xyzlo;
+    const double rcut = R3::norm(diagonal) + 2 * sqrt(3.0) * msp * rstep;
+    double nsqmax = 0.0;
+    vector< vector<int> > offset(R3::Ndim);
+    for (int j = 0; j < R3::Ndim; ++j)
+    {
+        const int n = shape[j];
+        nsqmax += double(n / 2) * (n / 2);
+        offset[j].resize(n);
+        for (int m = 0; m < n; ++m)
+        {
+            offset[j][m] = (m <= n / 2) ? m : (m - n);
+        }
+    }
+    const int nsqcut = int(min(nsqmax, ceil(pow(rcut / rstep, 2))));
+    vector<double> spectrumt;
+    vector<double> work;
+    QuantityType sinesum(nqpts);
+    for (int t = 0; t < nspecies; ++t)
+    {
+        if (!keepspectra)  speciesSpectrum(species[t], spectrumt);
+        const vector<double>& bt = keepspectra ? spectra[t] : spectrumt;
+        for (int s = t; s < nspecies; ++s)
+        {
+            if (keepspectra)  crossSpectrum(bt, spectra[s], work);
+            else if (s == t)  crossSpectrum(bt, bt, work);
+            else
+            {
+                speciesSpectrum(species[s], work);
+                crossSpectrum(bt, work, work);
+            }
+            fft.backward(work);
+            vector<double> histogram(nsqcut + 1, 0.0);
+            for (int ix = 0; ix < shape[0]; ++ix)
+            {
+                const int nx2 = offset[0][ix] * offset[0][ix];
+                for (int iy = 0; iy < shape[1]; ++iy)
+                {
+                    const int nxy2 = nx2 + offset[1][iy] * offset[1][iy];
+                    const double* row = &work[fft.rowIndex(ix, iy)];
+                    for (int iz = 0; iz < shape[2]; ++iz)
+                    {
+                        const int nsq = nxy2 + offset[2][iz] * offset[2][iz];
+                        if (nsq <= nsqcut)  histogram[nsq] += row[iz];
+                    }
+                }
+            }
+            // sum of sin(Q r) / r using the Chebyshev recurrence in Q
+            fill(sinesum.begin(), sinesum.end(), 0.0);
+            for (int nsq = 1; nsq <= nsqcut; ++nsq)
+            {
+                if (histogram[nsq] == 0.0)  continue;
+                const double r = rstep * sqrt(double(nsq));
+                const double hr = histogram[nsq] / r;
+                const double c2 = 2 * cos(qstep * r);
+                double sk0 = 0.0;
+                double sk1 = sin(qstep * r);
+                for (int kq = 1; kq < nqpts; ++kq)
+                {
+                    sinesum[kq] += hr * sk1;
+                    const double sk2 = c2 * sk1 - sk0;
+                    sk0 = sk1;
+                    sk1 = sk2;
+                }
+            }
+            // species weights, deconvolution and normalization of the FFT
+            const double pairscale = ((s == t) ? 1.0 : 2.0) *
+                pow(rstep * rstep / (4 * M_PI * tau), 3) / ntotal;
+            const QuantityType& wt = species[t].weight;
+            const QuantityType& ws = species[s].weight;
+            for (int kq = max(1, kqlo); kq < nqpts; ++kq)
+            {
+                const double q = kq * qstep;
+                mvalue[kq] += pairscale * exp(2 * tau * q * q) *
+                    wt[kq] * ws[kq] * (sinesum[kq] + q * histogram[0]);
+            }
+        }
+    }
+    // subtract self-scattering and evaluate normalization to F(Q)
+    for (int kq = max(1, kqlo); kq < nqpts; ++kq)
+    {
+        const double q = kq * qstep;
+        double sfsum = 0.0;
+        for (const Species& sp : species)
+        {
+            mvalue[kq] -= q * sp.sumsqocc * sp.weight[kq] * sp.weight[kq];
+            const double sf = sftable->lookup(sp.smbl, q);
+            sfsum += sf * accumulate(sp.occupancy.begin(),
+                    sp.occupancy.end(), 0.0);
+        }
+        mfscale[kq] = (sfsum == 0.0) ? 0.0 : totocc / (sfsum * sfsum);
+    }
+    return mvalue;
+}
+
+
+double NUFFTDebyeSum::estimateGridMemory(StructureAdapterPtr stru) const
+{
+    const int nqpts = pdfutils_qmaxSteps(this);
+    const double qlast = nqpts * this->getQstep();
+    const int msp = spreadingWidth(this->getNUFFTPrecision());
+    R3::Vector xyzlo, xyzhi;
+    boundingBox(*stru, xyzlo, xyzhi);
+    int shape[R3::Ndim];
+    gridShape(shape, xyzlo, xyzhi, gridStep(qlast), msp);
+    double rv = sizeof(double) * (shape[2] + 2.0);
+    rv *= double(shape[0]) * shape[1];
+    return rv;
+}
+
+
+const QuantityType& NUFFTDebyeSum::value() const
+{
+    return mvalue;
+}
+
+// results
+
+QuantityType NUFFTDebyeSum::getF() const
+{
+    QuantityType rv = this->value();
+    for (size_t kq = 0; kq < rv.size() && kq < mfscale.size(); ++kq)
+    {
+        rv[kq] *= mfscale[kq];
+    }
+    return rv;
+}
+
+// Q-range methods
+
+QuantityType NUFFTDebyeSum::getQgrid() const
+{
+    return pdfutils_getQgrid(this);
+}
+
+// Q-range configuration
+
+void NUFFTDebyeSum::setQmin(double qmin)
+{
+    ensureNonNegative("Qmin", qmin);
+    mqmin = qmin;
+}
+
+
+const double& NUFFTDebyeSum::getQmin() const
+{
+    return mqmin;
+}
+
+
+void NUFFTDebyeSum::setQmax(double qmax)
+{
+    ensureNonNegative("Qmax", qmax);
+    mqmax = qmax;
+}
+
+
+const double& NUFFTDebyeSum::getQmax() const
+{
+    return mqmax;
+}
+
+
+void NUFFTDebyeSum::setQstep(double qstep)
+{
+    ensureEpsilonPositive("Qstep", qstep);
+    mqstep = qstep;
+}
+
+
+const double& NUFFTDebyeSum::getQstep() const
+{
+    return mqstep;
+}
+
+
+void NUFFTDebyeSum::setNUFFTPrecision(double precision)
+{
+    ensureNonNegative("nufftprecision", precision);
+    mnufftprecision = precision;
+}
+
+
+const double& NUFFTDebyeSum::getNUFFTPrecision() const
+{
+    return mnufftprecision;
+}
+
+
+void NUFFTDebyeSum::setMaxGridMemory(double nbytes)
+{
+    ensureNonNegative("maxgridmemory", nbytes);
+    mmaxgridmemory = nbytes;
+}
+
+
+const double& NUFFTDebyeSum::getMaxGridMemory() const
+{
+    return mmaxgridmemory;
+}
+
+
+void NUFFTDebyeSum::setUisoStep(double uisostep)
+{
+    ensureNonNegative("uisostep", uisostep);
+    muisostep = uisostep;
+}
+
+
+const double& NUFFTDebyeSum::getUisoStep() const
+{
+    return muisostep;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+DIFFPY_INSTANTIATE_SERIALIZATION(diffpy::srreal::NUFFTDebyeSum)
+BOOST_CLASS_EXPORT_IMPLEMENT(diffpy::srreal::NUFFTDebyeSum)
+
+// End of file
@@ -0,0 +1,157 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class NUFFTDebyeSum -- orientationally averaged scattering of a finite
+*     structure evaluated with a non-uniform fast Fourier transformation.
+*
+*****************************************************************************/
+
+// Densities of atom species are spread to a fine 3D grid with Gaussian
+// kernels and Fourier transformed as in the type-1 NUFFT of Greengard and
+// Lee, SIAM Rev. 46, 443 (2004).  The orientational average of the cross
+// spectra |F(q)|^2 is obtained from the radial distribution of their
+// inverse transform, i.e., of the Gaussian-blurred pair correlation, which
+// is histogrammed by exact squared grid offsets.  The isotropic Gaussian
+// blur is then divided out at each Q, so the result is the Debye sum
+// over distinct atom pairs up to the nufftprecision accuracy.  Atoms have
+// uncorrelated isotropic displacements with the Debye-Waller factors
+// exp(-0.5 Uiso Q^2).  The cost scales with the number of atoms plus
+// (Qmax D)^3 log(Qmax D) for the structure size D instead of the squared
+// count of atoms.
+//
+// Atoms are grouped in species of the same type and Uiso and the cost
+// grows with the squared count of species, which is limited to 32.
+// Structures with per-atom Uiso such as MD snapshots need uisostep
+// that bins Uiso values to species with their mean Uiso.  The relative
+// error of binned weights is about 0.5 dU Q^2 for the Uiso deviation dU
+// from the bin mean.
+//
+// The grid spacing is pi / (2 Qmax) and the grid spans twice the
+// structure extent along each axis.  One real-to-complex grid takes about
+// 16 Qmax^3 Dx Dy Dz bytes for the extents Dx, Dy, Dz, e.g., 2 GB for
+// a 50 A cube at Qmax = 10 A^-1 and 16 GB for a 100 A cube.  Spectra of
+// all species are kept when they fit within maxgridmemory.  Otherwise
+// they are recomputed for every pair of species with only two grids in
+// memory.  The evaluation throws runtime_error before any allocation when
+// even two grids exceed maxgridmemory, which defaults to a half of the
+// physical memory.  Larger structures need the pair sum of
+// DebyePDFCalculator.
+
+#ifndef NUFFTDEBYESUM_HPP_INCLUDED
+#define NUFFTDEBYESUM_HPP_INCLUDED
+
+#include <boost/serialization/base_object.hpp>
+
+#include <diffpy/Attributes.hpp>
+#include <diffpy/srreal/ScatteringFactorTable.hpp>
+#include <diffpy/srreal/StructureAdapter.hpp>
+#include <diffpy/srreal/QuantityType.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class NUFFTDebyeSum :
+    public diffpy::Attributes,
+    public ScatteringFactorTableOwner
+{
+    public:
+
+        // constructor
+        NUFFTDebyeSum();
+
+        // methods
+        /// evaluate Debye sum for a finite structure
+        const QuantityType& eval(StructureAdapterPtr);
+        template <class T> const QuantityType& eval(const T&);
+        /// Debye sum over distinct pairs on the Q-grid as in BaseDebyeSum
+        const QuantityType& value() const;
+
+        // results
+        /// F values on a full Q-grid starting at 0
+        QuantityType getF() const;
+
+        // Q-range methods
+        /// Full Q-grid starting at 0
+        QuantityType getQgrid() const;
+        // Q-range configuration
+        void setQmin(double);
+        const double& getQmin() const;
+        void setQmax(double);
+        const double& getQmax() const;
+        void setQstep(double);
+        const double& getQstep() const;
+
+        /// set relative accuracy of the gridded Fourier transformation
+        void setNUFFTPrecision(double);
+        /// return relative accuracy of the gridded Fourier transformation
+        const double& getNUFFTPrecision() const;
+        /// set memory limit in bytes for the Fourier grids,
+        /// use a half of the physical memory when 0
+        void setMaxGridMemory(double);
+        const double& getMaxGridMemory() const;
+        /// bin Uiso of atoms of the same type by uisostep, exact when 0
+        void setUisoStep(double);
+        const double& getUisoStep() const;
+        /// memory in bytes of one Fourier grid for the structure
+        double estimateGridMemory(StructureAdapterPtr) const;
+
+    private:
+
+        // data
+        double mqmin;
+        double mqmax;
+        double mqstep;
+        double mnufftprecision;
+        double mmaxgridmemory;
+        double muisostep;
+        QuantityType mvalue;
+        /// normalization of value to the F(Q) function
+        QuantityType mfscale;
+
+        // serialization
+        friend class boost::serialization::access;
+        template<class Archive>
+            void serialize(Archive& ar, const unsigned int version)
+        {
+            using boost::serialization::base_object;
+            ar & base_object<ScatteringFactorTableOwner>(*this);
+            ar & mqmin;
+            ar & mqmax;
+            ar & mqstep;
+            ar & mnufftprecision;
+            ar & mmaxgridmemory;
+            ar & muisostep;
+            ar & mvalue;
+            ar & mfscale;
+        }
+
+};  // class NUFFTDebyeSum
+
+// Template Public Methods ---------------------------------------------------
+
+template <class T>
+const QuantityType& NUFFTDebyeSum::eval(const T& stru)
+{
+    StructureAdapterPtr pstru = convertToStructureAdapter(stru);
+    return this->eval(pstru);
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+BOOST_CLASS_EXPORT_KEY(diffpy::srreal::NUFFTDebyeSum)
+
+#endif  // NUFFTDEBYESUM_HPP_INCLUDED
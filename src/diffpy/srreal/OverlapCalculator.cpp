@@ -455,6 +455,13 @@ void OverlapCalculator::executeParallelMerge(const std::string& pdata)
     mvalue.insert(mvalue.end(), pvalue.begin(), pvalue.end());
 }
 
+
+void OverlapCalculator::executeParallelArrayMerge(
+        const double* pdata, size_t n)
+{
+    mvalue.insert(mvalue.end(), pdata, pdata + n);
+}
+
 // Private Methods -----------------------------------------------------------
 
 int OverlapCalculator::count() const
@@ -489,12 +496,12 @@ const double& OverlapCalculator::subvalue(int offset, int index) const
 }
 
 
-const R3::Vector& OverlapCalculator::subdirection(int index) const
+R3::Vector OverlapCalculator::subdirection(int index) const
 {
-    static R3::Vector rv;
-    rv[0] = this->subvalue(DIRECTION0_OFFSET, index);
-    rv[1] = this->subvalue(DIRECTION1_OFFSET, index);
-    rv[2] = this->subvalue(DIRECTION2_OFFSET, index);
+    R3::Vector rv(
+            this->subvalue(DIRECTION0_OFFSET, index),
+            this->subvalue(DIRECTION1_OFFSET, index),
+            this->subvalue(DIRECTION2_OFFSET, index));
     return rv;
 }
 
@@ -553,7 +560,7 @@ OverlapCalculator::getNeighborIds(int k) const
         }
         mneighborids_cached = true;
     }
-    static NbList noneighbors;
+    static const NbList noneighbors;
     NeighborIdsStorage::const_iterator nbit = mneighborids.find(k);
     const NbList& rv =
         (nbit == mneighborids.end()) ?  noneighbors : nbit->second;
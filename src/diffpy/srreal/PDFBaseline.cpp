@@ -25,6 +25,17 @@ namespace diffpy {
 // Unique instantiation of the template registry base class.
 template class HasClassRegistry<srreal::PDFBaseline>;
 
+namespace srreal {
+
+// Public Methods ------------------------------------------------------------
+
+void PDFBaseline::apply(const double* r, double* y, size_t n) const
+{
+    const PDFBaseline& fbaseline = *this;
+    for (size_t i = 0; i < n; ++i)  y[i] += fbaseline(r[i]);
+}
+
+}   // namespace srreal
 }   // namespace diffpy
 
 // Serialization -------------------------------------------------------------
@@ -16,12 +16,15 @@
 *     A concrete instance of PDFBaseline is a functor, that calculates
 *     baseline value at a given pair distance r.  The baseline is added to
 *     (R(r) * r) before multiplication by any envelope functions.
+*     The apply method adds baseline to an array of values in one call.
 *
 *****************************************************************************/
 
 #ifndef PDFBASELINE_HPP_INCLUDED
 #define PDFBASELINE_HPP_INCLUDED
 
+#include <cstddef>
+
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/assume_abstract.hpp>
 #include <boost/serialization/export.hpp>
@@ -29,6 +32,7 @@
 
 #include <diffpy/Attributes.hpp>
 #include <diffpy/HasClassRegistry.hpp>
+#include <diffpy/EventTicker.hpp>
 
 namespace diffpy {
 namespace srreal {
@@ -44,6 +48,15 @@ class PDFBaseline :
 
         // methods
         virtual double operator()(const double& r) const = 0;
+        /// add baseline evaluated at r to n values in y
+        virtual void apply(const double* r, double* y, size_t n) const;
+        /// ticker for changes in the baseline parameters
+        virtual eventticker::EventTicker& ticker() const  { return mticker; }
+
+    protected:
+
+        // data
+        mutable eventticker::EventTicker mticker;
 
     private:
 
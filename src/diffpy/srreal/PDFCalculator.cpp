@@ -20,12 +20,16 @@
 #include <sstream>
 #include <cmath>
 #include <cassert>
+#include <typeinfo>
 
 #include <diffpy/serialization.ipp>
 #include <diffpy/srreal/PDFCalculator.hpp>
 #include <diffpy/srreal/StructureAdapter.hpp>
 #include <diffpy/srreal/R3linalg.hpp>
 #include <diffpy/srreal/PDFUtils.hpp>
+#include <diffpy/srreal/PDFKernel.hpp>
+#include <diffpy/srreal/ConstantPeakWidth.hpp>
+#include <diffpy/srreal/JeongPeakWidth.hpp>
 #include <diffpy/mathutils.hpp>
 #include <diffpy/validators.hpp>
 
@@ -40,6 +44,14 @@ using namespace diffpy::mathutils;
 
 namespace {
 
+/// Keys for the derived results in the PDFCalculator cache.
+enum {
+    EXTENDED_RDF,
+    EXTENDED_RDFPERR,
+    EXTENDED_F,
+    EXTENDED_PDF_UNSCALED,
+};
+
 /// Return true if qstep value can be cheaply recomputed in initial setup.
 template <class PDFC>
 bool _initialQstepUpdate(const PDFC* pc)
@@ -60,7 +72,10 @@ PDFCalculator::PDFCalculator() :
     mqmin(0.0),
     mqmax(DOUBLE_MAX),
     mrstep(DEFAULT_PDFCALCULATOR_RSTEP),
-    mmaxextension(DEFAULT_PDFCALCULATOR_MAXEXTENSION)
+    mmaxextension(DEFAULT_PDFCALCULATOR_MAXEXTENSION),
+    mhistogrammode(false),
+    maddpaircontribution(&PDFCalculator::addPairContributionKernel<
+            PeakProfile, PeakWidthModel>)
 {
     // default configuration
     mrmax = DEFAULT_PDFCALCULATOR_RMAX;
@@ -150,42 +165,26 @@ QuantityType PDFCalculator::getF() const
 
 QuantityType PDFCalculator::getExtendedPDF() const
 {
-    QuantityType rgrid_ext = this->getExtendedRgrid();
-    // Skip FFT when qmax is not specified and qmin does not exclude the
-    // the F(Q=Qstep) point (excluding F(0) == 0 makes no difference to G).
-    const bool skipfft =
-        !eps_lt(this->getQmax(), M_PI / this->getRstep()) &&
-        !(1 < pdfutils_qminSteps(this));
-    if (skipfft)
+    const eventticker::EventTicker& tic = this->resultsTicker();
+    const QuantityType* pdf0 = mresults_cache.find(EXTENDED_PDF_UNSCALED, tic);
+    if (!pdf0)
     {
-        QuantityType rdfpr = this->getExtendedRDFperR();
-        QuantityType rdfprb = this->applyBaseline(rgrid_ext, rdfpr);
-        QuantityType pdf = this->applyEnvelopes(rgrid_ext, rdfprb);
-        return pdf;
+        pdf0 = &mresults_cache.store(EXTENDED_PDF_UNSCALED,
+                this->calcExtendedPDFUnscaled(), tic);
     }
-    // FFT required here
-    // we need a full range PDF to apply termination ripples correctly
-    QuantityType f_ext = this->getExtendedF();
-    // zero all F points at Q < Qmin
-    QuantityType::iterator ii_qmin =
-        f_ext.begin() + min(pdfutils_qminSteps(this), int(f_ext.size()));
-    fill(f_ext.begin(), ii_qmin, 0.0);
-    // zero all F points at Q >= Qmax
-    assert(pdfutils_qmaxSteps(this) <= int(f_ext.size()));
-    QuantityType::iterator ii_qmax = f_ext.begin() + pdfutils_qmaxSteps(this);
-    fill(ii_qmax, f_ext.end(), 0.0);
-    QuantityType pdf1 = fftftog(f_ext, this->getQstep());
-    // cut away the FFT padded points
-    assert(this->extendedRmaxSteps() <= int(pdf1.size()));
-    pdf1.erase(pdf1.begin() + this->extendedRmaxSteps(), pdf1.end());
-    pdf1.erase(pdf1.begin(), pdf1.begin() + this->extendedRminSteps());
-    QuantityType pdf2 = this->applyEnvelopes(rgrid_ext, pdf1);
-    return pdf2;
+    QuantityType rgrid_ext = this->getExtendedRgrid();
+    PQStatisticsTimer tm(this->activeStatistics(),
+            &PQStatistics::postprocessingtime);
+    QuantityType pdf = this->applyEnvelopes(rgrid_ext, *pdf0);
+    return pdf;
 }
 
 
 QuantityType PDFCalculator::getExtendedRDF() const
 {
+    const eventticker::EventTicker& tic = this->resultsTicker();
+    const QuantityType* cached = mresults_cache.find(EXTENDED_RDF, tic);
+    if (cached)  return *cached;
     QuantityType rdf(this->countExtendedPoints());
     const double& totocc = mstructure_cache.totaloccupancy;
     double sfavg = this->sfAverage();
@@ -204,12 +203,15 @@ QuantityType PDFCalculator::getExtendedRDF() const
     {
         *iirdf = *iival * rdf_scale;
     }
-    return rdf;
+    return mresults_cache.store(EXTENDED_RDF, rdf, tic);
 }
 
 
 QuantityType PDFCalculator::getExtendedRDFperR() const
 {
+    const eventticker::EventTicker& tic = this->resultsTicker();
+    const QuantityType* cached = mresults_cache.find(EXTENDED_RDFPERR, tic);
+    if (cached)  return *cached;
     QuantityType rdf_ext = this->getExtendedRDF();
     QuantityType rgrid_ext = this->getExtendedRgrid();
     assert(rdf_ext.size() == rgrid_ext.size());
@@ -219,20 +221,25 @@ QuantityType PDFCalculator::getExtendedRDFperR() const
     {
         *rdfi = eps_gt(*ri, 0) ? (*rdfi / *ri) : 0.0;
     }
-    return rdf_ext;
+    return mresults_cache.store(EXTENDED_RDFPERR, rdf_ext, tic);
 }
 
 
 QuantityType PDFCalculator::getExtendedF() const
 {
+    const eventticker::EventTicker& tic = this->resultsTicker();
+    const QuantityType* cached = mresults_cache.find(EXTENDED_F, tic);
+    if (cached)  return *cached;
     QuantityType rdfperr_ext = this->getExtendedRDFperR();
     QuantityType rgrid_ext = this->getExtendedRgrid();
     QuantityType rdfperr_ext1 = this->applyBaseline(rgrid_ext, rdfperr_ext);
     const double rmin_ext = this->getExtendedRmin();
+    PQStatisticsTimer tm(this->activeStatistics(),
+            &PQStatistics::postprocessingtime);
     QuantityType rv = fftgtof(rdfperr_ext1, this->getRstep(), rmin_ext);
     assert(rv.empty() || eps_eq(M_PI,
                 this->getQstep() * rv.size() * this->getRstep()));
-    return rv;
+    return mresults_cache.store(EXTENDED_F, rv, tic);
 }
 
 
@@ -262,6 +269,7 @@ QuantityType PDFCalculator::getQgrid() const
 void PDFCalculator::setQmin(double qmin)
 {
     ensureNonNegative("Qmin", qmin);
+    if (mqmin != qmin)  mresults_ticker.click();
     mqmin = qmin;
 }
 
@@ -277,26 +285,25 @@ void PDFCalculator::setQmax(double qmax)
     ensureNonNegative("Qmax", qmax);
     double qmax1 = (qmax > 0.0) ? qmax : DOUBLE_MAX;
     if (qmax1 < mqmax)  mticker.click();
+    if (qmax1 != mqmax)  mresults_ticker.click();
     mqmax = qmax1;
     if (_initialQstepUpdate(this))  this->resetValue();
 }
 
 
-const double& PDFCalculator::getQmax() const
+double PDFCalculator::getQmax() const
 {
-    static double rv;
-    rv = min(mqmax, M_PI / this->getRstep());
+    double rv = min(mqmax, M_PI / this->getRstep());
     return rv;
 }
 
 
-const double& PDFCalculator::getQstep() const
+double PDFCalculator::getQstep() const
 {
-    static double rv;
     // replicate the zero padding as done in fftgtof
     int Npad1 = this->extendedRmaxSteps();
     int Npad2 = (Npad1 > 0) ? (1 << int(ceil(log2(Npad1)))) : 0;
-    rv = (Npad2 > 0) ? M_PI / (Npad2 * this->getRstep()) : 0.0;
+    double rv = (Npad2 > 0) ? M_PI / (Npad2 * this->getRstep()) : 0.0;
     return rv;
 }
 
@@ -400,6 +407,19 @@ const PeakProfilePtr& PDFCalculator::getPeakProfile() const
     return mpeakprofile;
 }
 
+
+void PDFCalculator::setHistogramMode(bool flag)
+{
+    if (mhistogrammode != flag)  mticker.click();
+    mhistogrammode = flag;
+}
+
+
+bool PDFCalculator::getHistogramMode() const
+{
+    return mhistogrammode;
+}
+
 // PDF baseline methods
 
 QuantityType PDFCalculator::applyBaseline(
@@ -407,13 +427,9 @@ QuantityType PDFCalculator::applyBaseline(
 {
     assert(x.size() == y.size());
     QuantityType z = y;
+    if (z.empty())  return z;
     const PDFBaseline& baseline = *(this->getBaseline());
-    QuantityType::const_iterator xi = x.begin();
-    QuantityType::iterator zi = z.begin();
-    for (; xi != x.end(); ++xi, ++zi)
-    {
-        *zi += baseline(*xi);
-    }
+    baseline.apply(&(x[0]), &(z[0]), z.size());
     return z;
 }
 
@@ -421,13 +437,14 @@ QuantityType PDFCalculator::applyBaseline(
 void PDFCalculator::setBaseline(PDFBaselinePtr baseline)
 {
     ensureNonNull("PDFBaseline", baseline);
+    if (mbaseline != baseline)  mresults_ticker.click();
     mbaseline = baseline;
 }
 
 
 void PDFCalculator::setBaselineByType(const std::string& tp)
 {
-    mbaseline = PDFBaseline::createByType(tp);
+    this->setBaseline(PDFBaseline::createByType(tp));
 }
 
 
@@ -500,6 +517,12 @@ void PDFCalculator::resetValue()
     }
     this->resizeValue(this->countCalcPoints());
     this->PairQuantity::resetValue();
+    this->selectPairKernel();
+    mhistogram.clear();
+    if (mhistogrammode)
+    {
+        mhistogram.setup(*(this->getPeakProfile()), this->getRstep());
+    }
 }
 
 
@@ -507,38 +530,45 @@ void PDFCalculator::configureBondGenerator(BaseBondGenerator& bnds) const
 {
     bnds.setRmin(this->rcalclo());
     bnds.setRmax(this->rcalchi());
+    // user peak widths may depend on the orientation of the bond
+    bnds.setOrbitReduction(this->hasBondLengthPeakWidth());
 }
 
 
 void PDFCalculator::addPairContribution(const BaseBondGenerator& bnds,
         int summationscale)
 {
-    double sfprod = this->sfSite(bnds.site0()) * this->sfSite(bnds.site1());
-    double peakscale = sfprod * bnds.multiplicity() * summationscale;
-    double fwhm = this->getPeakWidthModel()->calculate(bnds);
-    const PeakProfile& pkf = *(this->getPeakProfile());
-    double dist = bnds.distance();
-    double xlo = dist + pkf.xboundlo(fwhm);
-    double xhi = dist + pkf.xboundhi(fwhm);
-    int i = max(0, this->calcIndex(xlo));
-    int ilast = min(this->countCalcPoints(), this->calcIndex(xhi) + 1);
-    assert(ilast <= int(mvalue.size()));
-    assert(eps_gt(dist, 0.0));
-    for (; i < ilast; ++i)
-    {
-        double x = (this->rcalcloSteps() + i) * this->getRstep() - dist;
-        double y = pkf(x, fwhm);
-        // Contributions in G(r) need to be normalized by pair distance,
-        // not by r as done in PDFfit or PDFfit2.  Here we rescale RDF
-        // in such way that division by r will give a correct result.
-        double yrdf = y * (x / dist + 1);
-        mvalue[i] += peakscale * yrdf;
-    }
+    (this->*maddpaircontribution)(bnds, summationscale);
+}
+
+
+void PDFCalculator::finishValue()
+{
+    this->flushHistogram();
+}
+
+
+void PDFCalculator::flushPartialValue()
+{
+    this->flushHistogram();
+}
+
+
+size_t PDFCalculator::countBufferBytes() const
+{
+    const size_t szd = sizeof(double);
+    size_t rv = this->PairQuantity::countBufferBytes();
+    rv += mstructure_cache.sfsite.capacity() * szd;
+    rv += mstashedvalue.value.capacity() * szd;
+    rv += mhistogram.countBytes();
+    return rv;
 }
 
 
 void PDFCalculator::stashPartialValue()
 {
+    // histogram grid may change with the structure, apply it now
+    this->flushHistogram();
     mstashedvalue.value = this->value();
     mstashedvalue.rclosteps = this->rcalcloSteps();
 }
@@ -560,6 +590,141 @@ void PDFCalculator::restorePartialValue()
     mstashedvalue.value.clear();
 }
 
+// Private Methods -----------------------------------------------------------
+
+// pair contribution kernels
+
+void PDFCalculator::selectPairKernel()
+{
+    const PeakProfile& pkf = *(this->getPeakProfile());
+    const PeakWidthModel& pwm = *(this->getPeakWidthModel());
+    const type_info& tp = typeid(pkf);
+    if (mhistogrammode)
+    {
+        maddpaircontribution = histogramKernelFor(pwm);
+    }
+    else if (tp == typeid(GaussianProfile))
+    {
+        maddpaircontribution = pairKernelFor<GaussianProfile>(pwm);
+    }
+    else if (tp == typeid(CroppedGaussianProfile))
+    {
+        maddpaircontribution = pairKernelFor<CroppedGaussianProfile>(pwm);
+    }
+    else if (tp == typeid(LookupTableProfile))
+    {
+        maddpaircontribution = pairKernelFor<LookupTableProfile>(pwm);
+    }
+    else
+    {
+        maddpaircontribution = pairKernelFor<PeakProfile>(pwm);
+    }
+}
+
+
+template <class TProfile>
+PDFCalculator::PairContributionMethod
+PDFCalculator::pairKernelFor(const PeakWidthModel& pwm)
+{
+    const type_info& tp = typeid(pwm);
+    if (tp == typeid(JeongPeakWidth))
+    {
+        return &PDFCalculator::addPairContributionKernel<
+            TProfile, JeongPeakWidth>;
+    }
+    if (tp == typeid(DebyeWallerPeakWidth))
+    {
+        return &PDFCalculator::addPairContributionKernel<
+            TProfile, DebyeWallerPeakWidth>;
+    }
+    if (tp == typeid(ConstantPeakWidth))
+    {
+        return &PDFCalculator::addPairContributionKernel<
+            TProfile, ConstantPeakWidth>;
+    }
+    return &PDFCalculator::addPairContributionKernel<
+        TProfile, PeakWidthModel>;
+}
+
+
+template <class TProfile, class TWidth>
+void PDFCalculator::addPairContributionKernel(
+        const BaseBondGenerator& bnds, int summationscale)
+{
+    const PDFKernel<TProfile, TWidth> kernel(
+            *(this->getPeakProfile()), *(this->getPeakWidthModel()));
+    double sfprod = this->sfSite(bnds.site0()) * this->sfSite(bnds.site1());
+    double peakscale = sfprod * bnds.multiplicity() * summationscale;
+    const PeakShape<TProfile> pkshape = kernel.peakShape(kernel.fwhm(bnds));
+    const double dist = bnds.distance();
+    double xlo = dist + pkshape.xboundlo();
+    double xhi = dist + pkshape.xboundhi();
+    int i = max(0, this->calcIndex(xlo));
+    int ilast = min(this->countCalcPoints(), this->calcIndex(xhi) + 1);
+    assert(ilast <= int(mvalue.size()));
+    assert(eps_gt(dist, 0.0));
+    PQStatistics* stats = this->activeStatistics();
+    if (stats && i < ilast)  stats->peakpoints += ilast - i;
+    const int rclosteps = this->rcalcloSteps();
+    const double dr = this->getRstep();
+    for (; i < ilast; ++i)
+    {
+        double x = (rclosteps + i) * dr - dist;
+        double y = pkshape(x);
+        // Contributions in G(r) need to be normalized by pair distance,
+        // not by r as done in PDFfit or PDFfit2.  Here we rescale RDF
+        // in such way that division by r will give a correct result.
+        double yrdf = y * (x / dist + 1);
+        mvalue[i] += peakscale * yrdf;
+    }
+}
+
+
+PDFCalculator::PairContributionMethod
+PDFCalculator::histogramKernelFor(const PeakWidthModel& pwm)
+{
+    const type_info& tp = typeid(pwm);
+    if (tp == typeid(JeongPeakWidth))
+    {
+        return &PDFCalculator::addPairContributionHistogram<JeongPeakWidth>;
+    }
+    if (tp == typeid(DebyeWallerPeakWidth))
+    {
+        return &PDFCalculator::addPairContributionHistogram<
+            DebyeWallerPeakWidth>;
+    }
+    if (tp == typeid(ConstantPeakWidth))
+    {
+        return &PDFCalculator::addPairContributionHistogram<
+            ConstantPeakWidth>;
+    }
+    return &PDFCalculator::addPairContributionHistogram<PeakWidthModel>;
+}
+
+
+template <class TWidth>
+void PDFCalculator::addPairContributionHistogram(
+        const BaseBondGenerator& bnds, int summationscale)
+{
+    const PDFKernel<PeakProfile, TWidth> kernel(
+            *(this->getPeakProfile()), *(this->getPeakWidthModel()));
+    double sfprod = this->sfSite(bnds.site0()) * this->sfSite(bnds.site1());
+    double peakscale = sfprod * bnds.multiplicity() * summationscale;
+    const double dist = bnds.distance();
+    assert(eps_gt(dist, 0.0));
+    // the r / dist scaling of RDF is completed in the histogram flush
+    mhistogram.add(dist, kernel.fwhm(bnds), peakscale / dist);
+}
+
+
+void PDFCalculator::flushHistogram()
+{
+    if (mhistogram.empty())  return;
+    // the histogram grids are largest just before the flush
+    this->recordBufferBytes();
+    mhistogram.flush(*(this->getPeakProfile()), mvalue, this->rcalcloSteps());
+}
+
 // calculation specific
 
 double PDFCalculator::rcalclo() const
@@ -664,6 +829,57 @@ void PDFCalculator::cutRipplePoints(QuantityType& y) const
 }
 
 
+QuantityType PDFCalculator::calcExtendedPDFUnscaled() const
+{
+    QuantityType rgrid_ext = this->getExtendedRgrid();
+    // Skip FFT when qmax is not specified and qmin does not exclude the
+    // the F(Q=Qstep) point (excluding F(0) == 0 makes no difference to G).
+    const bool skipfft =
+        !eps_lt(this->getQmax(), M_PI / this->getRstep()) &&
+        !(1 < pdfutils_qminSteps(this));
+    if (skipfft)
+    {
+        QuantityType rdfpr = this->getExtendedRDFperR();
+        QuantityType rdfprb = this->applyBaseline(rgrid_ext, rdfpr);
+        return rdfprb;
+    }
+    // FFT required here
+    // we need a full range PDF to apply termination ripples correctly
+    QuantityType f_ext = this->getExtendedF();
+    // zero all F points at Q < Qmin
+    QuantityType::iterator ii_qmin =
+        f_ext.begin() + min(pdfutils_qminSteps(this), int(f_ext.size()));
+    fill(f_ext.begin(), ii_qmin, 0.0);
+    // zero all F points at Q >= Qmax
+    assert(pdfutils_qmaxSteps(this) <= int(f_ext.size()));
+    QuantityType::iterator ii_qmax = f_ext.begin() + pdfutils_qmaxSteps(this);
+    fill(ii_qmax, f_ext.end(), 0.0);
+    QuantityType pdf1;
+    {
+        PQStatisticsTimer tm(this->activeStatistics(),
+                &PQStatistics::postprocessingtime);
+        pdf1 = fftftog(f_ext, this->getQstep());
+    }
+    // cut away the FFT padded points
+    assert(this->extendedRmaxSteps() <= int(pdf1.size()));
+    pdf1.erase(pdf1.begin() + this->extendedRmaxSteps(), pdf1.end());
+    pdf1.erase(pdf1.begin(), pdf1.begin() + this->extendedRminSteps());
+    return pdf1;
+}
+
+
+
+
+eventticker::EventTicker& PDFCalculator::resultsTicker() const
+{
+    eventticker::EventTicker& tic = mresults_ticker;
+    tic.updateFrom(this->ticker());
+    tic.updateFrom(this->valueTicker());
+    tic.updateFrom(this->getBaseline()->ticker());
+    return tic;
+}
+
+
 const double& PDFCalculator::sfSite(int siteidx) const
 {
     assert(0 <= siteidx && siteidx < int(mstructure_cache.sfsite.size()));
@@ -24,6 +24,8 @@
 #include <diffpy/srreal/PeakWidthModel.hpp>
 #include <diffpy/srreal/PDFBaseline.hpp>
 #include <diffpy/srreal/PDFEnvelope.hpp>
+#include <diffpy/srreal/PeakWidthHistogram.hpp>
+#include <diffpy/srreal/QuantityCache.hpp>
 #include <diffpy/srreal/ScatteringFactorTable.hpp>
 
 namespace diffpy {
@@ -66,8 +68,8 @@ class PDFCalculator :
         void setQmin(double);
         const double& getQmin() const;
         void setQmax(double);
-        const double& getQmax() const;
-        const double& getQstep() const;
+        double getQmax() const;
+        double getQstep() const;
 
         // R-range methods
         QuantityType getRgrid() const;
@@ -92,6 +94,10 @@ class PDFCalculator :
         void setPeakProfileByType(const std::string& tp);
         PeakProfilePtr& getPeakProfile();
         const PeakProfilePtr& getPeakProfile() const;
+        /// accumulate pair contributions in a distance histogram binned
+        /// by peak width and convolve it with the peak profile at the end
+        void setHistogramMode(bool);
+        bool getHistogramMode() const;
 
         // PDF baseline configuration
         // application on an array
@@ -109,14 +115,37 @@ class PDFCalculator :
 
         // PairQuantity overloads
         virtual void resetValue();
+        /// generate symmetry-unique bonds only for the built-in peak
+        /// width models, see PeakWidthModelOwner::hasBondLengthPeakWidth
         virtual void configureBondGenerator(BaseBondGenerator&) const;
         virtual void addPairContribution(const BaseBondGenerator&, int);
+        virtual void finishValue();
+        virtual void flushPartialValue();
+        virtual size_t countBufferBytes() const;
         // support for PQEvaluatorOptimized
         virtual void stashPartialValue();
         virtual void restorePartialValue();
 
     private:
 
+        // types
+        typedef void (PDFCalculator::*PairContributionMethod)(
+                const BaseBondGenerator&, int);
+
+        // methods - pair contribution kernels
+        /// select the fastest kernel for the peak profile and width model
+        void selectPairKernel();
+        template <class TProfile>
+            static PairContributionMethod pairKernelFor(const PeakWidthModel&);
+        template <class TProfile, class TWidth>
+            void addPairContributionKernel(const BaseBondGenerator&, int);
+        static PairContributionMethod
+            histogramKernelFor(const PeakWidthModel&);
+        template <class TWidth>
+            void addPairContributionHistogram(const BaseBondGenerator&, int);
+        /// convolve and add pending histogram contributions to the value
+        void flushHistogram();
+
         // methods - calculation specific
         /// complete lower bound extension of the calculated grid
         double rcalclo() const;
@@ -143,6 +172,10 @@ class PDFCalculator :
         /// reduce extended grid to user-requested results grid
         /// by cutting away the points for termination ripples
         void cutRipplePoints(QuantityType& y) const;
+        /// extended PDF before the application of envelope functions
+        QuantityType calcExtendedPDFUnscaled() const;
+        /// ticker for any change that affects results derived from value
+        eventticker::EventTicker& resultsTicker() const;
 
         // structure factors - fast lookup by site index
         /// effective scattering factor at a given site scaled by occupancy
@@ -160,6 +193,9 @@ class PDFCalculator :
         double mmaxextension;
         PeakProfilePtr mpeakprofile;
         PDFBaselinePtr mbaseline;
+        bool mhistogrammode;
+        PairContributionMethod maddpaircontribution;
+        PeakWidthHistogram mhistogram;
         struct {
             std::vector<double> sfsite;
             double sfaverage;
@@ -177,6 +213,9 @@ class PDFCalculator :
             QuantityType value;
             int rclosteps;
         } mstashedvalue;
+        // cache of the derived results
+        mutable eventticker::EventTicker mresults_ticker;
+        mutable QuantityCache mresults_cache;
         // serialization
         friend class boost::serialization::access;
         template<class Archive>
@@ -201,6 +240,9 @@ class PDFCalculator :
             ar & mrlimits_cache.extendedrmaxsteps;
             ar & mrlimits_cache.rcalclosteps;
             ar & mrlimits_cache.rcalchisteps;
+            if (version >= 1) {
+                ar & mhistogrammode;
+            }
         }
 
 };  // class PDFCalculator
@@ -210,6 +252,7 @@ class PDFCalculator :
 
 // Serialization -------------------------------------------------------------
 
+BOOST_CLASS_VERSION(diffpy::srreal::PDFCalculator, 1)
 BOOST_CLASS_EXPORT_KEY(diffpy::srreal::PDFCalculator)
 
 #endif  // PDFCALCULATOR_HPP_INCLUDED
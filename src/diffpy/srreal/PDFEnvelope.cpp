@@ -18,6 +18,7 @@
 
 #include <sstream>
 #include <stdexcept>
+#include <algorithm>
 #include <boost/serialization/export.hpp>
 
 #include <diffpy/srreal/PDFEnvelope.hpp>
@@ -35,6 +36,26 @@ template class HasClassRegistry<srreal::PDFEnvelope>;
 
 namespace srreal {
 
+// Local Constants -----------------------------------------------------------
+
+namespace {
+
+/// Number of points scaled by all envelopes before moving to the next block.
+/// This keeps the processed block in the CPU cache for every envelope.
+const size_t ENVELOPE_BLOCK_SIZE = 512;
+
+}   // namespace
+
+// class PDFEnvelope ---------------------------------------------------------
+
+// public methods
+
+void PDFEnvelope::apply(const double* r, double* y, size_t n) const
+{
+    const PDFEnvelope& fenvelope = *this;
+    for (size_t i = 0; i < n; ++i)  y[i] *= fenvelope(r[i]);
+}
+
 // class PDFEnvelopeOwner ----------------------------------------------------
 
 // public methods
@@ -44,15 +65,17 @@ QuantityType PDFEnvelopeOwner::applyEnvelopes(
 {
     assert(x.size() == y.size());
     QuantityType z = y;
+    if (z.empty())  return z;
+    // apply all envelopes to one block of points at a time
+    const size_t npts = z.size();
     EnvelopeStorage::const_iterator evit;
-    for (evit = menvelope.begin(); evit != menvelope.end(); ++evit)
+    for (size_t lo = 0; lo < npts; lo += ENVELOPE_BLOCK_SIZE)
     {
-        PDFEnvelope& fenvelope = *(evit->second);
-        QuantityType::const_iterator xi = x.begin();
-        QuantityType::iterator zi = z.begin();
-        for (; xi != x.end(); ++xi, ++zi)
+        const size_t nblock = min(ENVELOPE_BLOCK_SIZE, npts - lo);
+        for (evit = menvelope.begin(); evit != menvelope.end(); ++evit)
         {
-            *zi *= fenvelope(*xi);
+            const PDFEnvelope& fenvelope = *(evit->second);
+            fenvelope.apply(&(x[lo]), &(z[lo]), nblock);
         }
     }
     return z;
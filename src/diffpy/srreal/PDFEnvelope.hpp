@@ -15,13 +15,16 @@
 * class PDFEnvelope -- abstract base class for PDF envelope functions
 *     A concrete instance of PDFEnvelope is a functor, that calculates
 *     PDF scaling coefficients at a given pair distance r.  Several functors
-*     can be defined and applied in PDFCalculator.
+*     can be defined and applied in PDFCalculator.  The apply method
+*     scales an array of values in one call and can be overloaded with
+*     a faster loop in the derived classes.
 *
 *****************************************************************************/
 
 #ifndef PDFENVELOPE_HPP_INCLUDED
 #define PDFENVELOPE_HPP_INCLUDED
 
+#include <cstddef>
 #include <string>
 #include <set>
 
@@ -50,6 +53,8 @@ class PDFEnvelope :
 
         // methods
         virtual double operator()(const double& r) const = 0;
+        /// multiply n values in y by the envelope evaluated at r
+        virtual void apply(const double* r, double* y, size_t n) const;
 
     private:
 
@@ -0,0 +1,223 @@
+/*****************************************************************************
+*
+* libdiffpy         by DANSE Diffraction group
+*                   Simon J. L. Billinge
+*                   (c) 2009 The Trustees of Columbia University
+*                   in the City of New York.  All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE_DANSE.txt for license information.
+*
+******************************************************************************
+*
+* class PeakShape -- peak profile evaluation for a single pair width
+* class PDFKernel -- peak width and shape calculation for a pair
+*     contribution in PDFCalculator
+*
+* The primary templates work through the virtual methods of PeakProfile
+* and PeakWidthModel and support any registered types.  Specializations
+* for the built-in classes call their methods non-virtually and keep
+* per-pair constants so that the loop over r-points can be inlined.
+*
+*****************************************************************************/
+
+#ifndef PDFKERNEL_HPP_INCLUDED
+#define PDFKERNEL_HPP_INCLUDED
+
+#include <cmath>
+
+#include <diffpy/srreal/PeakProfile.hpp>
+#include <diffpy/srreal/PeakWidthModel.hpp>
+#include <diffpy/srreal/GaussianProfile.hpp>
+#include <diffpy/srreal/CroppedGaussianProfile.hpp>
+#include <diffpy/srreal/LookupTableProfile.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+/// peak profile evaluated at a fixed FWHM through virtual calls
+template <class TProfile>
+class PeakShape
+{
+    public:
+
+        // constructor
+        PeakShape(const TProfile& pkf, double fwhm) :
+            mpkf(pkf), mfwhm(fwhm)
+        { }
+
+        // methods
+        double xboundlo() const  { return mpkf.xboundlo(mfwhm); }
+        double xboundhi() const  { return mpkf.xboundhi(mfwhm); }
+        double operator()(double x) const  { return mpkf(x, mfwhm); }
+
+    private:
+
+        // data
+        const TProfile& mpkf;
+        double mfwhm;
+
+};
+
+
+/// GaussianProfile at a fixed FWHM
+template <>
+class PeakShape<GaussianProfile>
+{
+    public:
+
+        // constructor
+        PeakShape(const GaussianProfile& pkf, double fwhm) :
+            mfwhm(fwhm),
+            mxboundhi(pkf.GaussianProfile::xboundhi(fwhm)),
+            mscale((fwhm <= 0) ? 0.0 : 2 * sqrt(M_LN2 / M_PI) / fwhm)
+        { }
+
+        // methods
+        double xboundlo() const  { return -1 * mxboundhi; }
+        double xboundhi() const  { return mxboundhi; }
+
+        double operator()(double x) const
+        {
+            if (mfwhm <= 0)  return 0.0;
+            double xrel = x / mfwhm;
+            return mscale * exp(-4 * M_LN2 * xrel * xrel);
+        }
+
+    private:
+
+        // data
+        double mfwhm;
+        double mxboundhi;
+        double mscale;
+
+};
+
+
+/// CroppedGaussianProfile at a fixed FWHM
+template <>
+class PeakShape<CroppedGaussianProfile>
+{
+    public:
+
+        // constructor
+        PeakShape(const CroppedGaussianProfile& pkf, double fwhm) :
+            mfwhm(fwhm),
+            mxboundhi(pkf.GaussianProfile::xboundhi(fwhm)),
+            mhalfboundrel(pkf.mhalfboundrel),
+            mscale(2 * sqrt(M_LN2 / M_PI) / fwhm * pkf.mscale)
+        { }
+
+        // methods
+        double xboundlo() const  { return -1 * mxboundhi; }
+        double xboundhi() const  { return mxboundhi; }
+
+        double operator()(double x) const
+        {
+            double xrel = x / mfwhm;
+            double rv = (fabs(xrel) >= mhalfboundrel) ? 0.0 :
+                mscale * exp(-4 * M_LN2 * xrel * xrel);
+            return rv;
+        }
+
+    private:
+
+        // data
+        double mfwhm;
+        double mxboundhi;
+        double mhalfboundrel;
+        double mscale;
+
+};
+
+
+/// LookupTableProfile at a fixed FWHM
+template <>
+class PeakShape<LookupTableProfile>
+{
+    public:
+
+        // constructor
+        PeakShape(const LookupTableProfile& pkf, double fwhm) :
+            mpkf(pkf),
+            mfwhm(fwhm),
+            mxboundlo(pkf.LookupTableProfile::xboundlo(fwhm)),
+            mxboundhi(pkf.LookupTableProfile::xboundhi(fwhm))
+        { }
+
+        // methods
+        double xboundlo() const  { return mxboundlo; }
+        double xboundhi() const  { return mxboundhi; }
+
+        double operator()(double x) const
+        {
+            if (mfwhm <= 0)  return 0.0;
+            return mpkf.interpolate(x / mfwhm) / mfwhm;
+        }
+
+    private:
+
+        // data
+        const LookupTableProfile& mpkf;
+        double mfwhm;
+        double mxboundlo;
+        double mxboundhi;
+
+};
+
+
+/// peak width and profile calculation for the pairs in PDFCalculator
+template <class TProfile, class TWidth>
+class PDFKernel
+{
+    public:
+
+        // constructor
+        PDFKernel(const PeakProfile& pkf, const PeakWidthModel& pwm) :
+            mpkf(static_cast<const TProfile&>(pkf)),
+            mpwm(static_cast<const TWidth&>(pwm))
+        { }
+
+        // methods
+        /// FWHM of the pair peak at the current bond
+        double fwhm(const BaseBondGenerator& bnds) const
+        {
+            return this->calculateWidth(mpwm, bnds);
+        }
+
+        /// profile of the pair peak with the specified FWHM
+        PeakShape<TProfile> peakShape(double fwhm) const
+        {
+            return PeakShape<TProfile>(mpkf, fwhm);
+        }
+
+    private:
+
+        // methods
+        /// non-virtual call for a built-in peak width model
+        template <class T>
+        static double calculateWidth(const T& pwm,
+                const BaseBondGenerator& bnds)
+        {
+            return pwm.T::calculate(bnds);
+        }
+
+        /// virtual call for a generic peak width model
+        static double calculateWidth(const PeakWidthModel& pwm,
+                const BaseBondGenerator& bnds)
+        {
+            return pwm.calculate(bnds);
+        }
+
+        // data
+        const TProfile& mpkf;
+        const TWidth& mpwm;
+
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // PDFKERNEL_HPP_INCLUDED
@@ -0,0 +1,90 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PQAsyncEvaluation -- handle to a PairQuantity evaluation running
+*     in a background thread, created by PairQuantity::evalAsync
+*
+*****************************************************************************/
+
+#include <chrono>
+
+#include <diffpy/srreal/PQAsyncEvaluation.hpp>
+#include <diffpy/srreal/PairQuantity.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Constructor ---------------------------------------------------------------
+
+PQAsyncEvaluation::PQAsyncEvaluation(
+        PairQuantity& pq, StructureAdapterPtr stru) : mpq(pq)
+{
+    mpq.mprogress = &mprogress;
+    try {
+        mfuture = async(launch::async, [this, stru]() {
+                try {
+                    mpq.eval(stru);
+                }
+                catch (...) {
+                    mpq.mprogress = NULL;
+                    throw;
+                }
+                mpq.mprogress = NULL;
+            }).share();
+    }
+    catch (...) {
+        mpq.mprogress = NULL;
+        throw;
+    }
+}
+
+
+PQAsyncEvaluation::~PQAsyncEvaluation()
+{
+    this->wait();
+}
+
+// Public Methods ------------------------------------------------------------
+
+bool PQAsyncEvaluation::ready() const
+{
+    future_status st = mfuture.wait_for(chrono::seconds(0));
+    return st == future_status::ready;
+}
+
+
+void PQAsyncEvaluation::wait() const
+{
+    mfuture.wait();
+}
+
+
+const QuantityType& PQAsyncEvaluation::get() const
+{
+    mfuture.get();
+    return mpq.value();
+}
+
+
+void PQAsyncEvaluation::cancel()
+{
+    mprogress.cancel();
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
@@ -0,0 +1,75 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PQAsyncEvaluation -- handle to a PairQuantity evaluation running
+*     in a background thread, created by PairQuantity::evalAsync
+*
+* The PairQuantity must not be used nor destroyed until the evaluation
+* finishes.  Destructor of the handle waits for the evaluation.
+*
+*****************************************************************************/
+
+#ifndef PQASYNCEVALUATION_HPP_INCLUDED
+#define PQASYNCEVALUATION_HPP_INCLUDED
+
+#include <future>
+#include <boost/shared_ptr.hpp>
+
+#include <diffpy/srreal/PQProgress.hpp>
+#include <diffpy/srreal/QuantityType.hpp>
+#include <diffpy/srreal/StructureAdapter.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class PairQuantity;
+
+class PQAsyncEvaluation
+{
+    public:
+
+        // constructor
+        PQAsyncEvaluation(PairQuantity& pq, StructureAdapterPtr stru);
+        ~PQAsyncEvaluation();
+
+        // methods
+        /// true when the evaluation has finished, failed or was cancelled
+        bool ready() const;
+        /// block until the evaluation ends
+        void wait() const;
+        /// wait for the result, rethrow PQEvaluationCancelled or
+        /// any other exception from the evaluation
+        const QuantityType& get() const;
+        /// request cancellation at the next anchor site
+        void cancel();
+        const PQProgress& progress() const  { return mprogress; }
+
+    private:
+
+        // data
+        PairQuantity& mpq;
+        PQProgress mprogress;
+        std::shared_future<void> mfuture;
+
+        // non-copyable
+        PQAsyncEvaluation(const PQAsyncEvaluation&);
+        PQAsyncEvaluation& operator=(const PQAsyncEvaluation&);
+};
+
+typedef boost::shared_ptr<PQAsyncEvaluation> PQAsyncEvaluationPtr;
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // PQASYNCEVALUATION_HPP_INCLUDED
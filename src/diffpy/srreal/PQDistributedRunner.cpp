@@ -0,0 +1,273 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PQDistributedRunner -- evaluate PairQuantity on remote workers
+*
+* servePQWorker -- worker loop that answers PQDistributedRunner requests
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <diffpy/srreal/PQDistributedRunner.hpp>
+#include <diffpy/serialization.hpp>
+#include <diffpy/validators.hpp>
+
+using namespace std;
+using namespace diffpy::validators;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+// message types of the worker protocol
+const char MSG_JOB = 'J';
+const char MSG_TASK = 'T';
+const char MSG_DATA = 'D';
+const char MSG_ERROR = 'E';
+
+const int DEFAULT_PARTITIONS_PER_WORKER = 4;
+
+/// Progress of one distributed evaluation shared by the worker threads
+struct DistributedEvaluation
+{
+    mutex mtx;
+    condition_variable cv;
+    deque<int> pending;
+    vector<string> results;
+    int ndone;
+    vector<int> failed;
+    exception_ptr error;
+
+    bool finished() const
+    {
+        return ndone == int(results.size()) || error;
+    }
+};
+
+
+string taskMessage(int part, int npart)
+{
+    ostringstream msg;
+    msg << MSG_TASK << part << ' ' << npart;
+    return msg.str();
+}
+
+
+void runWorkerChannel(PQTransport& transport, int widx,
+        const string& job, DistributedEvaluation& de)
+{
+    int part = -1;
+    try {
+        PQChannelPtr channel = transport.connect(widx);
+        channel->send(job);
+        while (true)
+        {
+            {
+                unique_lock<mutex> lock(de.mtx);
+                de.cv.wait(lock, [&de] {
+                        return !de.pending.empty() || de.finished(); });
+                if (de.finished())  break;
+                part = de.pending.front();
+                de.pending.pop_front();
+            }
+            channel->send(taskMessage(part, de.results.size()));
+            string reply = channel->receive();
+            lock_guard<mutex> lock(de.mtx);
+            if (!reply.empty() && reply[0] == MSG_DATA)
+            {
+                de.results[part] = reply.substr(1);
+                ++de.ndone;
+            }
+            else if (!de.error)
+            {
+                string emsg = (!reply.empty() && reply[0] == MSG_ERROR) ?
+                    reply.substr(1) : "Invalid reply from a worker.";
+                de.error = make_exception_ptr(runtime_error(emsg));
+            }
+            part = -1;
+            de.cv.notify_all();
+        }
+    }
+    catch (PQTransportError&) {
+        // return unfinished partition to the queue for other workers
+        lock_guard<mutex> lock(de.mtx);
+        if (part >= 0)  de.pending.push_front(part);
+        de.failed.push_back(widx);
+        de.cv.notify_all();
+    }
+    catch (...) {
+        lock_guard<mutex> lock(de.mtx);
+        if (!de.error)  de.error = current_exception();
+        de.cv.notify_all();
+    }
+}
+
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// class PQDistributedRunner
+//////////////////////////////////////////////////////////////////////////////
+
+// Constructor ---------------------------------------------------------------
+
+PQDistributedRunner::PQDistributedRunner(PQTransportPtr transport) :
+    mtransport(transport),
+    mpartitions(0)
+{
+    ensureNonNull("transport", mtransport);
+}
+
+// Public Methods ------------------------------------------------------------
+
+const QuantityType& PQDistributedRunner::eval(PairQuantity& pq)
+{
+    return this->eval(pq, pq.getStructure());
+}
+
+
+const QuantityType&
+PQDistributedRunner::eval(PairQuantity& pq, StructureAdapterPtr stru)
+{
+    mfailedworkers.clear();
+    const int nworkers = mtransport->countWorkers();
+    if (nworkers < 1)
+    {
+        const char* emsg =
+            "PQDistributedRunner requires at least one worker.";
+        throw invalid_argument(emsg);
+    }
+    pq.setStructure(stru);
+    // calculator and structure are shipped once per worker
+    boost::shared_ptr<PairQuantity> ppq(&pq, [](PairQuantity*) { });
+    const string job = MSG_JOB + serialization_tostring(ppq);
+    const int npart = mpartitions ? mpartitions :
+        (DEFAULT_PARTITIONS_PER_WORKER * nworkers);
+    DistributedEvaluation de;
+    de.results.resize(npart);
+    de.ndone = 0;
+    for (int part = 0; part < npart; ++part)  de.pending.push_back(part);
+    vector<thread> threads;
+    for (int widx = 0; widx < nworkers; ++widx)
+    {
+        threads.push_back(thread(runWorkerChannel,
+                    ref(*mtransport), widx, cref(job), ref(de)));
+    }
+    for (thread& t : threads)  t.join();
+    mfailedworkers = de.failed;
+    sort(mfailedworkers.begin(), mfailedworkers.end());
+    if (de.error)  rethrow_exception(de.error);
+    if (de.ndone < npart)
+    {
+        const char* emsg =
+            "All workers failed before finishing evaluation.";
+        throw PQTransportError(emsg);
+    }
+    for (const string& pdata : de.results)
+    {
+        pq.mergeParallelData(pdata, npart);
+    }
+    return pq.value();
+}
+
+// configuration
+
+void PQDistributedRunner::setPartitions(int npart)
+{
+    ensureNonNegative("partitions", npart);
+    mpartitions = npart;
+}
+
+
+const int& PQDistributedRunner::getPartitions() const
+{
+    return mpartitions;
+}
+
+
+const vector<int>& PQDistributedRunner::getFailedWorkers() const
+{
+    return mfailedworkers;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Worker Functions
+//////////////////////////////////////////////////////////////////////////////
+
+void servePQWorker(PQChannel& channel)
+{
+    boost::shared_ptr<PairQuantity> pq;
+    string joberror;
+    while (true)
+    {
+        string msg;
+        // close the channel on oversized or otherwise unreadable messages
+        try {
+            msg = channel.receive();
+        }
+        catch (exception&) {
+            return;
+        }
+        const char mtype = msg.empty() ? '\0' : msg[0];
+        // job requests are not answered, their errors are reported
+        // for the following tasks
+        if (mtype == MSG_JOB)
+        {
+            pq.reset();
+            joberror.clear();
+            try {
+                serialization_fromstring(pq, msg.substr(1));
+            }
+            catch (exception& e) {
+                joberror = e.what();
+            }
+            continue;
+        }
+        string reply;
+        try {
+            if (mtype != MSG_TASK)  throw invalid_argument("Unknown request.");
+            if (!joberror.empty())  throw runtime_error(joberror);
+            if (!pq)  throw logic_error("Task requested before the job.");
+            int part, npart;
+            istringstream task(msg.substr(1));
+            task >> part >> npart;
+            pq->setupParallelRun(part, npart);
+            pq->eval();
+            reply = MSG_DATA + pq->getParallelData();
+        }
+        catch (exception& e) {
+            reply = MSG_ERROR + string(e.what());
+        }
+        try {
+            channel.send(reply);
+        }
+        catch (PQTransportError&) {
+            return;
+        }
+    }
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
@@ -0,0 +1,86 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PQDistributedRunner -- evaluate PairQuantity on remote workers
+*
+* servePQWorker -- worker loop that answers PQDistributedRunner requests
+*
+*****************************************************************************/
+
+// The runner sends each worker the serialized PairQuantity together with
+// its structure once per evaluation.  The anchor sites are then split into
+// partitions as in PairQuantity::setupParallelRun, which are handed out to
+// the workers as they become free.  Partitions of a worker that fails,
+// including a worker that does not reply within the SocketTransport timeout,
+// are passed to the remaining workers.  Partial results are merged in the
+// order of partitions with PairQuantity::mergeParallelData so the value does
+// not depend on the scheduling.
+
+#ifndef PQDISTRIBUTEDRUNNER_HPP_INCLUDED
+#define PQDISTRIBUTEDRUNNER_HPP_INCLUDED
+
+#include <diffpy/srreal/PairQuantity.hpp>
+#include <diffpy/srreal/PQTransport.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class PQDistributedRunner
+{
+    public:
+
+        // constructor
+        explicit PQDistributedRunner(PQTransportPtr transport);
+
+        // methods
+        /// evaluate pq for its current structure
+        const QuantityType& eval(PairQuantity& pq);
+        template <class T>
+            const QuantityType& eval(PairQuantity& pq, const T& stru);
+        const QuantityType& eval(PairQuantity& pq, StructureAdapterPtr stru);
+
+        // configuration
+        /// number of anchor-site partitions, 4 per worker when zero
+        void setPartitions(int npart);
+        const int& getPartitions() const;
+        /// indices of workers that failed in the last evaluation
+        const std::vector<int>& getFailedWorkers() const;
+
+    private:
+
+        // data
+        PQTransportPtr mtransport;
+        int mpartitions;
+        std::vector<int> mfailedworkers;
+};
+
+/// Answer evaluation requests from a PQDistributedRunner on the channel
+/// until it is closed by the runner or a message cannot be received.
+/// The requests are trusted, see PQTransport.hpp.
+void servePQWorker(PQChannel& channel);
+
+// Template Public Methods ---------------------------------------------------
+
+template <class T>
+const QuantityType&
+PQDistributedRunner::eval(PairQuantity& pq, const T& stru)
+{
+    StructureAdapterPtr pstru = convertToStructureAdapter(stru);
+    return this->eval(pq, pstru);
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // PQDISTRIBUTEDRUNNER_HPP_INCLUDED
@@ -23,6 +23,14 @@
 
 #include <stdexcept>
 #include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <streambuf>
+#include <stdint.h>
+
+#include <boost/archive/archive_exception.hpp>
 
 #include <diffpy/serialization.ipp>
 #include <diffpy/srreal/PQEvaluator.hpp>
@@ -41,6 +49,181 @@ namespace {
 
 // tolerated load variance for splitting outer loop for parallel evaluation
 const double CPU_LOAD_VARIANCE = 0.1;
+// time only every n-th pair contribution when collecting statistics
+const long ACCUMULATION_TIMING_STRIDE = 64;
+
+/// Add bond counts and the bond generation time of one pair loop
+/// to the statistics.  Do nothing if statistics are disabled.
+class PairLoopStatistics
+{
+    public:
+
+        PairLoopStatistics(PQStatistics* stats) :
+            mstats(stats), mstart(0.0), maccumulationtime0(0.0)
+        {
+            if (!mstats)  return;
+            mstart = PQStatistics::timestamp();
+            maccumulationtime0 = mstats->accumulationtime;
+        }
+
+
+        void finish(const BaseBondGenerator& bnds)
+        {
+            if (!mstats)  return;
+            double looptime = PQStatistics::timestamp() - mstart;
+            double acctime = mstats->accumulationtime - maccumulationtime0;
+            mstats->bondtime += max(0.0, looptime - acctime);
+            mstats->bondsgenerated += bnds.countGeneratedBonds();
+            mstats->bondsrejected += bnds.countRejectedBonds();
+        }
+
+    private:
+
+        // data
+        PQStatistics* mstats;
+        double mstart;
+        double maccumulationtime0;
+};
+
+
+/// Output buffer that keeps only the size and the 64-bit FNV-1a hash of
+/// the written data.  Used to identify large archives in checkpoints.
+class SetupDigest : public streambuf
+{
+    public:
+
+        SetupDigest() : msize(0), mhash(FNV_OFFSET_BASIS)  { }
+
+
+        /// fixed-size hexadecimal digest of the data
+        string str() const
+        {
+            ostringstream rv;
+            rv << hex << setfill('0') << setw(16) << msize <<
+                setw(16) << mhash;
+            return rv.str();
+        }
+
+    protected:
+
+        virtual int_type overflow(int_type c)
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))  return c;
+            const char ch = traits_type::to_char_type(c);
+            this->xsputn(&ch, 1);
+            return c;
+        }
+
+
+        virtual streamsize xsputn(const char* s, streamsize n)
+        {
+            for (const char* p = s; p != s + n; ++p)
+            {
+                mhash = (mhash ^ uint64_t(static_cast<unsigned char>(*p))) *
+                    FNV_PRIME;
+            }
+            msize += n;
+            return n;
+        }
+
+    private:
+
+        static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+        static const uint64_t FNV_PRIME = 1099511628211ull;
+
+        // data
+        uint64_t msize;
+        uint64_t mhash;
+};
+
+
+/// Partial result and anchor-loop position of a full evaluation saved
+/// in a file.  The checkpoint is used only for identical signature of
+/// the structure and the calculator setup, which is stored as a digest.
+/// The partial result is stored with PairQuantity::getParallelData.
+class PairLoopCheckpoint
+{
+    public:
+
+        PairLoopCheckpoint(const string& filename, double interval,
+                const string& signature) :
+            mfilename(filename), minterval(interval),
+            msignature(signature),
+            mlastsave(PQStatistics::timestamp())
+        { }
+
+
+        /// load loop position and partial data, false if there is
+        /// no usable checkpoint
+        bool load(int& i0, long& n, string& pdata) const
+        {
+            ifstream fp(mfilename.c_str(), ios::binary);
+            if (!fp)  return false;
+            string signature;
+            int i0saved;
+            long nsaved;
+            string pdatasaved;
+            try {
+                diffpy::serialization::iarchive ia(fp, ios::binary);
+                ia >> signature >> i0saved >> nsaved >> pdatasaved;
+            }
+            catch (...) {
+                return false;
+            }
+            if (signature != msignature)  return false;
+            i0 = i0saved;
+            n = nsaved;
+            pdata.swap(pdatasaved);
+            return true;
+        }
+
+
+        bool due() const
+        {
+            return PQStatistics::timestamp() - mlastsave >= minterval;
+        }
+
+
+        /// write checkpoint to a temporary file renamed when complete
+        void save(const PairQuantity& pq, int i0, long n)
+        {
+            const string pdata = pq.getParallelData();
+            const string tmpname = mfilename + ".tmp";
+            {
+                ofstream fp(tmpname.c_str(), ios::binary);
+                diffpy::serialization::oarchive oa(fp, ios::binary);
+                oa << msignature << i0 << n << pdata;
+                if (!fp)
+                {
+                    string emsg = "Cannot write checkpoint '" +
+                        tmpname + "'.";
+                    throw runtime_error(emsg);
+                }
+            }
+            if (rename(tmpname.c_str(), mfilename.c_str()))
+            {
+                string emsg = "Cannot write checkpoint '" +
+                    mfilename + "'.";
+                throw runtime_error(emsg);
+            }
+            mlastsave = PQStatistics::timestamp();
+        }
+
+
+        void remove() const
+        {
+            std::remove(mfilename.c_str());
+        }
+
+    private:
+
+        // data
+        string mfilename;
+        double minterval;
+        string msignature;
+        double mlastsave;
+};
+
 
 SiteIndices
 complementary_indices(const int sz, const SiteIndices& indices0)
@@ -103,14 +286,41 @@ void PQEvaluatorBasic::updateValue(
     int cntsites = pq.mstructure->countSites();
     // loop counter
     long n = mcpuindex;
+    int i0first = 0;
+    // resume from a checkpoint of an identical evaluation
+    unique_ptr<PairLoopCheckpoint> checkpoint;
+    if (!pq.getCheckpointFile().empty())
+    {
+        checkpoint.reset(new PairLoopCheckpoint(pq.getCheckpointFile(),
+                    pq.getCheckpointInterval(),
+                    this->checkpointSignature(pq)));
+        string pdata;
+        if (checkpoint->load(i0first, n, pdata))
+        {
+            pq.executeParallelMerge(pdata);
+        }
+    }
     // split outer loop for many atoms.  The CPUs should have similar load.
     bool chop_outer = (mncpu <= ((cntsites - 1) * CPU_LOAD_VARIANCE + 1));
     bool chop_inner = !chop_outer;
     const bool hasmask = pq.hasMask();
     if (!this->isParallel())  chop_outer = chop_inner = false;
     const bool usefullsum = this->getFlag(USEFULLSUM);
-    for (int i0 = 0; i0 < cntsites; ++i0)
+    PQStatistics* stats = pq.activeStatistics();
+    PairLoopStatistics loopstats(stats);
+    PQProgress* progress = pq.activeProgress();
+    if (progress)  progress->start(cntsites);
+    for (int i0 = i0first; i0 < cntsites; ++i0)
     {
+        // save the state also before a requested cancellation
+        const bool cancelled = progress && progress->cancelRequested();
+        if (checkpoint && (cancelled || checkpoint->due()))
+        {
+            // the saved data must include the pending contributions
+            pq.flushPartialValue();
+            checkpoint->save(pq, i0, n);
+        }
+        if (progress)  progress->update(i0);
         if (chop_outer && (n++ % mncpu))    continue;
         bnds->selectAnchorSite(i0);
         int i1hi = usefullsum ? cntsites : (i0 + 1);
@@ -119,11 +329,19 @@ void PQEvaluatorBasic::updateValue(
         {
             if (chop_inner && (n++ % mncpu))    continue;
             int i1 = bnds->site1();
-            if (hasmask && !pq.getPairMask(i0, i1))   continue;
+            if (hasmask && !pq.getPairMask(i0, i1))
+            {
+                if (stats)  ++(stats->pairsmasked);
+                continue;
+            }
             int summationscale = (usefullsum || i0 == i1) ? 1 : 2;
-            pq.addPairContribution(*bnds, summationscale);
+            this->addPairContribution(pq, *bnds, summationscale, stats);
         }
     }
+    loopstats.finish(*bnds);
+    if (checkpoint)  checkpoint->remove();
+    if (progress)  progress->finish();
+    if (stats)  ++(stats->fullevaluations);
     mvalue_ticker.click();
 }
 
@@ -159,6 +377,48 @@ bool PQEvaluatorBasic::isParallel() const
     return mncpu > 1;
 }
 
+// Protected Methods ---------------------------------------------------------
+
+string PQEvaluatorBasic::checkpointSignature(const PairQuantity& pq) const
+{
+    // digest the calculator setup without value, evaluator or tickers,
+    // which differ between processes
+    SetupDigest digest;
+    ostream out(&digest);
+    try {
+        PairQuantity::SetupOnly setuponly;
+        eventticker::EventTicker::MaskedValues masked;
+        boost::shared_ptr<const PairQuantity> ppq(
+                &pq, [](const PairQuantity*) { });
+        diffpy::serialization::oarchive oa(out, ios::binary);
+        oa << ppq;
+    }
+    catch (boost::archive::archive_exception& e) {
+        string emsg = "Checkpoint requires serializable calculator (";
+        emsg += e.what();
+        emsg += ").";
+        throw logic_error(emsg);
+    }
+    out << mconfigflags << ' ' << mcpuindex << ' ' << mncpu;
+    return digest.str();
+}
+
+
+void PQEvaluatorBasic::addPairContribution(PairQuantity& pq,
+        const BaseBondGenerator& bnds, int summationscale,
+        PQStatistics* stats) const
+{
+    if (!stats || (stats->paircontributions++ % ACCUMULATION_TIMING_STRIDE))
+    {
+        pq.addPairContribution(bnds, summationscale);
+        return;
+    }
+    const double t0 = PQStatistics::timestamp();
+    pq.addPairContribution(bnds, summationscale);
+    const double dt = PQStatistics::timestamp() - t0;
+    stats->accumulationtime += ACCUMULATION_TIMING_STRIDE * dt;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // class PQEvaluatorOptimized
 //////////////////////////////////////////////////////////////////////////////
@@ -183,20 +443,24 @@ void PQEvaluatorOptimized::updateValue(
     mtypeused = OPTIMIZED;
     // revert to normal calculation if there is no structure or
     // if PairQuantity uses mask
-    if (pq.ticker() >= mvalue_ticker || !mlast_structure)
+    if (!mlast_structure)
     {
-        return this->updateValueCompletely(pq, stru);
+        return this->updateValueCompletely(pq, stru, "no previous structure");
+    }
+    if (pq.ticker() >= mvalue_ticker)
+    {
+        return this->updateValueCompletely(pq, stru, "configuration changed");
     }
     // do not do fast updates if they take more work
     StructureDifference sd = mlast_structure->diff(stru);
     if (!sd.allowsfastupdate())
     {
-        return this->updateValueCompletely(pq, stru);
+        return this->updateValueCompletely(pq, stru, "structure changed");
     }
     if ((this->getFlag(FIXEDSITEINDEX) || pq.hasPairMask()) &&
             sd.diffmethod != StructureDifference::Method::SIDEBYSIDE)
     {
-        return this->updateValueCompletely(pq, stru);
+        return this->updateValueCompletely(pq, stru, "site indices changed");
     }
     // Remove contributions from the extra sites in the old structure
     assert(sd.stru0 == mlast_structure);
@@ -221,8 +485,21 @@ void PQEvaluatorOptimized::updateValue(
     SiteIndices::const_iterator ii0;
     bool needsreselection = usefullsum;
     const bool hasmask = pq.hasMask();
+    PQStatistics* stats = pq.activeStatistics();
+    PairLoopStatistics loopstats0(stats);
+    // progress counts anchor sites of both the removal and addition loops
+    PQProgress* progress = pq.activeProgress();
+    int cntanchors = last_anchor - anchors.begin();
+    if (progress)
+    {
+        const int cntadded = sd.add1.empty() ? 0 :
+            (usefullsum ? sd.stru1->countSites() : int(sd.add1.size()));
+        progress->start(cntanchors + cntadded);
+        cntanchors = 0;
+    }
     for (ii0 = anchors.begin(); ii0 != last_anchor; ++ii0)
     {
+        if (progress)  progress->update(cntanchors++);
         if (n++ % mncpu)    continue;
         const int& i0 = *ii0;
         bnds0->selectAnchorSite(i0);
@@ -238,11 +515,16 @@ void PQEvaluatorOptimized::updateValue(
         for (bnds0->rewind(); !bnds0->finished(); bnds0->next())
         {
             int i1 = bnds0->site1();
-            if (hasmask && !pq.getPairMask(i0, i1))   continue;
+            if (hasmask && !pq.getPairMask(i0, i1))
+            {
+                if (stats)  ++(stats->pairsmasked);
+                continue;
+            }
             const int summationscale = (usefullsum || i0 == i1) ? -1 : -2;
-            pq.addPairContribution(*bnds0, summationscale);
+            this->addPairContribution(pq, *bnds0, summationscale, stats);
         }
     }
+    loopstats0.finish(*bnds0);
     // Add contributions from the new atoms in the updated structure
     // save current value to override the resetValue call from setStructure
     assert(sd.stru1);
@@ -253,7 +535,7 @@ void PQEvaluatorOptimized::updateValue(
     pq.setStructure(sd.stru1);
     if (pq.ticker() >= mvalue_ticker)
     {
-        return this->updateValueCompletely(pq, stru);
+        return this->updateValueCompletely(pq, stru, "custom configuration");
     }
     pq.restorePartialValue();
     int cntsites1 = sd.stru1->countSites();
@@ -271,8 +553,10 @@ void PQEvaluatorOptimized::updateValue(
         anchors.begin() : (anchors.end() - sd.add1.size());
     SiteIndices::const_iterator ii1;
     needsreselection = usefullsum;
+    PairLoopStatistics loopstats1(stats);
     for (ii1 = first_anchor; ii1 != anchors.end(); ++ii1)
     {
+        if (progress)  progress->update(cntanchors++);
         if (n++ % mncpu)    continue;
         const int& i0 = *ii1;
         bnds1->selectAnchorSite(i0);
@@ -288,19 +572,28 @@ void PQEvaluatorOptimized::updateValue(
         for (bnds1->rewind(); !bnds1->finished(); bnds1->next())
         {
             int i1 = bnds1->site1();
-            if (hasmask && !pq.getPairMask(i0, i1))   continue;
+            if (hasmask && !pq.getPairMask(i0, i1))
+            {
+                if (stats)  ++(stats->pairsmasked);
+                continue;
+            }
             const int summationscale = (usefullsum || i0 == i1) ? +1 : +2;
-            pq.addPairContribution(*bnds1, summationscale);
+            this->addPairContribution(pq, *bnds1, summationscale, stats);
         }
     }
+    loopstats1.finish(*bnds1);
+    if (progress)  progress->finish();
+    if (stats)  ++(stats->fastupdates);
     mlast_structure = pq.getStructure()->clone();
     mvalue_ticker.click();
 }
 
 
 void PQEvaluatorOptimized::updateValueCompletely(
-        PairQuantity& pq, StructureAdapterPtr stru)
+        PairQuantity& pq, StructureAdapterPtr stru, const char* reason)
 {
+    PQStatistics* stats = pq.activeStatistics();
+    if (stats)  ++(stats->fallbacks[reason]);
     this->PQEvaluatorBasic::updateValue(pq, stru);
     mlast_structure = pq.getStructure()->clone();
 }
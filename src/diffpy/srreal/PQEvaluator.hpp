@@ -32,6 +32,7 @@
 #include <diffpy/EventTicker.hpp>
 #include <diffpy/srreal/QuantityType.hpp>
 #include <diffpy/srreal/StructureAdapter.hpp>
+#include <diffpy/srreal/PQStatistics.hpp>
 
 namespace diffpy {
 namespace srreal {
@@ -73,6 +74,13 @@ class PQEvaluatorBasic
 
     protected:
 
+        // methods
+        /// identify structure and calculator setup of a checkpoint
+        std::string checkpointSignature(const PairQuantity& pq) const;
+        /// add pair contribution to pq and update the statistics if any
+        void addPairContribution(PairQuantity& pq,
+                const BaseBondGenerator& bnds, int summationscale,
+                PQStatistics* stats) const;
 
         // data
         /// per-bit storage of boolean configuration flags
@@ -113,7 +121,8 @@ class PQEvaluatorOptimized : public PQEvaluatorBasic
         StructureAdapterPtr mlast_structure;
 
         // helper method
-        void updateValueCompletely(PairQuantity&, StructureAdapterPtr);
+        void updateValueCompletely(PairQuantity&, StructureAdapterPtr,
+                const char* reason);
 
         // serialization
         friend class boost::serialization::access;
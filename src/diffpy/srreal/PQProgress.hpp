@@ -0,0 +1,100 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PQEvaluationCancelled -- exception thrown from a cancelled
+*     PairQuantity evaluation
+*
+* class PQProgress -- progress of anchor sites in a PairQuantity evaluation
+*     and a cooperative cancellation request
+*
+* PQProgress is shared between the evaluating thread and its observers.
+* The evaluators record the number of finished anchor sites before every
+* new anchor site and abort there when cancellation was requested.
+*
+*****************************************************************************/
+
+#ifndef PQPROGRESS_HPP_INCLUDED
+#define PQPROGRESS_HPP_INCLUDED
+
+#include <atomic>
+#include <stdexcept>
+
+namespace diffpy {
+namespace srreal {
+
+class PQEvaluationCancelled : public std::runtime_error
+{
+    public:
+
+        PQEvaluationCancelled() :
+            std::runtime_error("PairQuantity evaluation was cancelled.")
+        { }
+};
+
+
+class PQProgress
+{
+    public:
+
+        // constructor
+        PQProgress() : msitesdone(0), msitestotal(0), mcancel(false)  { }
+
+        // methods
+        /// number of anchor sites finished in the current pair loop
+        int sitesDone() const  { return msitesdone; }
+        /// number of anchor sites in the current pair loop
+        int sitesTotal() const  { return msitestotal; }
+        /// fraction of the finished anchor sites from 0 to 1
+        double fraction() const
+        {
+            const int total = msitestotal;
+            return total ? (double(msitesdone) / total) : 0.0;
+        }
+        /// request the evaluation to stop at the next anchor site
+        void cancel()  { mcancel = true; }
+        bool cancelRequested() const  { return mcancel; }
+
+        // interface for the evaluators
+        /// start a pair loop over cnt anchor sites
+        void start(int cnt)
+        {
+            msitesdone = 0;
+            msitestotal = cnt;
+            this->update(0);
+        }
+        /// record finished anchor sites and stop if cancelled
+        void update(int sitesdone)
+        {
+            msitesdone = sitesdone;
+            if (mcancel)  throw PQEvaluationCancelled();
+        }
+        /// mark all anchor sites finished
+        void finish()  { msitesdone = int(msitestotal); }
+
+    private:
+
+        // data
+        std::atomic<int> msitesdone;
+        std::atomic<int> msitestotal;
+        std::atomic<bool> mcancel;
+
+        // non-copyable
+        PQProgress(const PQProgress&);
+        PQProgress& operator=(const PQProgress&);
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // PQPROGRESS_HPP_INCLUDED
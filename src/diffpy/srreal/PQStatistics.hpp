@@ -0,0 +1,135 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2013 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* struct PQStatistics -- counters and timings of PairQuantity evaluations
+*
+* The statistics are collected only when enabled with
+* PairQuantity::setStatisticsEnabled.  The counters are plain integer
+* increments in the pair loops.  Accumulation time is estimated from
+* a sample of timed pair contributions, the bond generation time is
+* the rest of the pair loop time.  All times are in seconds.
+*
+*****************************************************************************/
+
+#ifndef PQSTATISTICS_HPP_INCLUDED
+#define PQSTATISTICS_HPP_INCLUDED
+
+#include <map>
+#include <string>
+#include <chrono>
+
+namespace diffpy {
+namespace srreal {
+
+struct PQStatistics
+{
+    // constructor
+    PQStatistics()  { this->clear(); }
+
+    // data
+    /// number of completed evaluations
+    long evaluations;
+    /// bond candidates visited by the bond generators
+    long bondsgenerated;
+    /// bond candidates rejected for being outside of the r-range
+    long bondsrejected;
+    /// bonds skipped due to pair or type mask
+    long pairsmasked;
+    /// number of added or subtracted pair contributions
+    long paircontributions;
+    /// r-points of the peak profiles evaluated in PDFCalculator
+    long peakpoints;
+    /// Q-points of the sine terms evaluated in the Debye summation
+    long qpointsevaluated;
+    /// Q-points skipped due to the debyeprecision cutoff
+    long qpointstruncated;
+    /// evaluations that summed all atom pairs from scratch
+    long fullevaluations;
+    /// fast updates done by PQEvaluatorOptimized
+    long fastupdates;
+    /// largest size in bytes of the value and work buffers
+    long bufferbytes;
+    /// reasons and counts of PQEvaluatorOptimized full evaluations
+    std::map<std::string, long> fallbacks;
+    /// time spent in the bond generators
+    double bondtime;
+    /// time spent in the pair contributions
+    double accumulationtime;
+    /// time spent in finishing the value and in the derived results
+    double postprocessingtime;
+
+    // methods
+    /// reset all counters and timings to zero
+    void clear()
+    {
+        evaluations = 0;
+        bondsgenerated = 0;
+        bondsrejected = 0;
+        pairsmasked = 0;
+        paircontributions = 0;
+        peakpoints = 0;
+        qpointsevaluated = 0;
+        qpointstruncated = 0;
+        fullevaluations = 0;
+        fastupdates = 0;
+        bufferbytes = 0;
+        fallbacks.clear();
+        bondtime = 0.0;
+        accumulationtime = 0.0;
+        postprocessingtime = 0.0;
+    }
+
+    /// monotonic clock time in seconds
+    static double timestamp()
+    {
+        using namespace std::chrono;
+        duration<double> t = steady_clock::now().time_since_epoch();
+        return t.count();
+    }
+};
+
+
+/// Add the lifetime of this object to the specified PQStatistics timing.
+/// Do nothing when the statistics pointer is NULL, i.e., disabled.
+class PQStatisticsTimer
+{
+    public:
+
+        PQStatisticsTimer(PQStatistics* stats, double PQStatistics::* field) :
+            mstats(stats), mfield(field),
+            mstart(stats ? PQStatistics::timestamp() : 0.0)
+        { }
+
+        ~PQStatisticsTimer()
+        {
+            if (!mstats)  return;
+            mstats->*mfield += PQStatistics::timestamp() - mstart;
+        }
+
+    private:
+
+        // data
+        PQStatistics* mstats;
+        double PQStatistics::* mfield;
+        double mstart;
+
+        // non-copyable
+        PQStatisticsTimer(const PQStatisticsTimer&);
+        PQStatisticsTimer& operator=(const PQStatisticsTimer&);
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // PQSTATISTICS_HPP_INCLUDED
@@ -0,0 +1,446 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PQTransportError -- failure of a connection to a remote worker
+*
+* class PQChannel -- abstract message channel to a remote worker
+*
+* class PQTransport -- abstract source of channels to a set of workers
+*
+* class SocketChannel -- PQChannel over a connected stream socket
+*
+* class SocketTransport -- PQTransport to workers listening at TCP or
+*     Unix-domain socket addresses
+*
+* class SocketListener -- worker-side socket that accepts channels
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdint.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include <boost/make_shared.hpp>
+
+#include <diffpy/srreal/PQTransport.hpp>
+#include <diffpy/validators.hpp>
+
+using namespace std;
+using namespace diffpy::validators;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+const size_t FRAME_HEADER_SIZE = 8;
+// received messages grow by chunks to allocate only the arrived data
+const size_t RECEIVE_CHUNK_SIZE = 1 << 24;
+
+
+void throwSystemError(const string& what)
+{
+    string emsg = what + ": " + strerror(errno);
+    throw PQTransportError(emsg);
+}
+
+
+/// split "tcp:HOST:PORT" or "unix:PATH" to the scheme and the rest
+void parseAddress(const string& address, string& scheme, string& location)
+{
+    string::size_type pc = address.find(':');
+    scheme = address.substr(0, pc);
+    location = (pc == string::npos) ? string() : address.substr(pc + 1);
+    if ((scheme != "tcp" && scheme != "unix") || location.empty())
+    {
+        string emsg = "Invalid socket address '" + address + "'.";
+        throw invalid_argument(emsg);
+    }
+}
+
+
+sockaddr_un unixSocketAddress(const string& path)
+{
+    sockaddr_un rv;
+    memset(&rv, 0, sizeof(rv));
+    rv.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(rv.sun_path))
+    {
+        string emsg = "Unix socket path '" + path + "' is too long.";
+        throw invalid_argument(emsg);
+    }
+    strcpy(rv.sun_path, path.c_str());
+    return rv;
+}
+
+
+/// resolve "HOST:PORT", an empty or "*" HOST is for passive sockets
+addrinfo* resolveTCPAddress(const string& location, bool passive)
+{
+    string::size_type pc = location.rfind(':');
+    if (pc == string::npos)
+    {
+        string emsg = "TCP address must have HOST:PORT format.";
+        throw invalid_argument(emsg);
+    }
+    string host = location.substr(0, pc);
+    string port = location.substr(pc + 1);
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (passive)  hints.ai_flags = AI_PASSIVE;
+    const char* phost = (host.empty() || host == "*") ? NULL : host.c_str();
+    addrinfo* rv = NULL;
+    int status = getaddrinfo(phost, port.c_str(), &hints, &rv);
+    if (status != 0)
+    {
+        string emsg = "Cannot resolve '" + location + "': " +
+            gai_strerror(status);
+        throw PQTransportError(emsg);
+    }
+    return rv;
+}
+
+
+int connectSocket(const string& address)
+{
+    string scheme, location;
+    parseAddress(address, scheme, location);
+    if (scheme == "unix")
+    {
+        sockaddr_un sa = unixSocketAddress(location);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)  throwSystemError("socket");
+        if (::connect(fd, (sockaddr*) &sa, sizeof(sa)) < 0)
+        {
+            close(fd);
+            throwSystemError("Cannot connect to " + address);
+        }
+        return fd;
+    }
+    addrinfo* ai0 = resolveTCPAddress(location, false);
+    int fd = -1;
+    for (addrinfo* ai = ai0; ai && fd < 0; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)  continue;
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)  break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(ai0);
+    if (fd < 0)  throwSystemError("Cannot connect to " + address);
+    return fd;
+}
+
+
+void writeAll(int fd, const char* data, size_t n)
+{
+    while (n > 0)
+    {
+        ssize_t cnt = ::send(fd, data, n, SEND_FLAGS);
+        if (cnt < 0 && errno == EINTR)  continue;
+        if (cnt < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            throw PQTransportError("Timed out sending a message.");
+        }
+        if (cnt <= 0)  throwSystemError("Failed message send");
+        data += cnt;
+        n -= cnt;
+    }
+}
+
+
+void readAll(int fd, char* data, size_t n)
+{
+    while (n > 0)
+    {
+        ssize_t cnt = ::recv(fd, data, n, 0);
+        if (cnt < 0 && errno == EINTR)  continue;
+        if (cnt < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            throw PQTransportError("Timed out waiting for a message.");
+        }
+        if (cnt < 0)  throwSystemError("Failed message receive");
+        if (cnt == 0)  throw PQTransportError("Connection closed.");
+        data += cnt;
+        n -= cnt;
+    }
+}
+
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// class SocketChannel
+//////////////////////////////////////////////////////////////////////////////
+
+// Class Constants -----------------------------------------------------------
+
+const uint64_t SocketChannel::DEFAULT_MAX_MESSAGE_SIZE = uint64_t(1) << 32;
+
+// Constructor ---------------------------------------------------------------
+
+SocketChannel::SocketChannel(int fd) :
+    mfd(fd),
+    mmaxmessagesize(DEFAULT_MAX_MESSAGE_SIZE)
+{
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(mfd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+
+SocketChannel::~SocketChannel()
+{
+    close(mfd);
+}
+
+// Public Methods ------------------------------------------------------------
+
+void SocketChannel::send(const string& message)
+{
+    char header[FRAME_HEADER_SIZE];
+    uint64_t n = message.size();
+    for (int i = FRAME_HEADER_SIZE - 1; i >= 0; --i, n >>= 8)
+    {
+        header[i] = char(n & 0xff);
+    }
+    writeAll(mfd, header, FRAME_HEADER_SIZE);
+    writeAll(mfd, message.data(), message.size());
+}
+
+
+string SocketChannel::receive()
+{
+    unsigned char header[FRAME_HEADER_SIZE];
+    readAll(mfd, (char*) header, FRAME_HEADER_SIZE);
+    uint64_t n = 0;
+    for (size_t i = 0; i < FRAME_HEADER_SIZE; ++i)  n = (n << 8) | header[i];
+    if (n > mmaxmessagesize)
+    {
+        ostringstream emsg;
+        emsg << "Message of " << n << " bytes exceeds the limit of " <<
+            mmaxmessagesize << " bytes.";
+        throw PQTransportError(emsg.str());
+    }
+    string rv;
+    while (rv.size() < n)
+    {
+        const size_t offset = rv.size();
+        rv.resize(offset + min<uint64_t>(n - offset, RECEIVE_CHUNK_SIZE));
+        readAll(mfd, &rv[offset], rv.size() - offset);
+    }
+    return rv;
+}
+
+
+void SocketChannel::setTimeout(double seconds)
+{
+    ensureNonNegative("timeout", seconds);
+    timeval tv;
+    tv.tv_sec = long(seconds);
+    tv.tv_usec = long(1e6 * (seconds - tv.tv_sec));
+    if (setsockopt(mfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0 ||
+        setsockopt(mfd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) < 0)
+    {
+        throwSystemError("setsockopt");
+    }
+}
+
+
+void SocketChannel::setMaxMessageSize(uint64_t n)
+{
+    mmaxmessagesize = n;
+}
+
+
+const uint64_t& SocketChannel::getMaxMessageSize() const
+{
+    return mmaxmessagesize;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// class SocketTransport
+//////////////////////////////////////////////////////////////////////////////
+
+// Class Constants -----------------------------------------------------------
+
+const double SocketTransport::DEFAULT_TIMEOUT = 600.0;
+
+// Constructor ---------------------------------------------------------------
+
+SocketTransport::SocketTransport(const vector<string>& addresses) :
+    maddresses(addresses),
+    mtimeout(DEFAULT_TIMEOUT)
+{
+    string scheme, location;
+    for (const string& a : maddresses)  parseAddress(a, scheme, location);
+}
+
+// Public Methods ------------------------------------------------------------
+
+
+int SocketTransport::countWorkers() const
+{
+    return maddresses.size();
+}
+
+
+PQChannelPtr SocketTransport::connect(int widx)
+{
+    int fd = connectSocket(maddresses.at(widx));
+    boost::shared_ptr<SocketChannel> rv =
+        boost::make_shared<SocketChannel>(fd);
+    if (mtimeout > 0.0)  rv->setTimeout(mtimeout);
+    return rv;
+}
+
+
+void SocketTransport::setTimeout(double seconds)
+{
+    ensureNonNegative("timeout", seconds);
+    mtimeout = seconds;
+}
+
+
+const double& SocketTransport::getTimeout() const
+{
+    return mtimeout;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// class SocketListener
+//////////////////////////////////////////////////////////////////////////////
+
+// Constructor ---------------------------------------------------------------
+
+SocketListener::SocketListener(const string& address) :
+    mfd(-1),
+    mmaxmessagesize(SocketChannel::DEFAULT_MAX_MESSAGE_SIZE)
+{
+    string scheme, location;
+    parseAddress(address, scheme, location);
+    if (scheme == "unix")
+    {
+        sockaddr_un sa = unixSocketAddress(location);
+        // replace stale socket from an earlier worker, but no other files
+        struct stat st;
+        if (stat(location.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        {
+            unlink(location.c_str());
+        }
+        mfd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (mfd < 0)  throwSystemError("socket");
+        if (bind(mfd, (sockaddr*) &sa, sizeof(sa)) < 0)
+        {
+            close(mfd);
+            throwSystemError("Cannot bind " + address);
+        }
+        munixpath = location;
+        maddress = address;
+    }
+    else
+    {
+        addrinfo* ai0 = resolveTCPAddress(location, true);
+        for (addrinfo* ai = ai0; ai && mfd < 0; ai = ai->ai_next)
+        {
+            mfd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (mfd < 0)  continue;
+            int one = 1;
+            setsockopt(mfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (bind(mfd, ai->ai_addr, ai->ai_addrlen) == 0)  break;
+            close(mfd);
+            mfd = -1;
+        }
+        freeaddrinfo(ai0);
+        if (mfd < 0)  throwSystemError("Cannot bind " + address);
+        sockaddr_storage sa;
+        socklen_t salen = sizeof(sa);
+        getsockname(mfd, (sockaddr*) &sa, &salen);
+        const int port = ntohs((sa.ss_family == AF_INET6) ?
+                ((sockaddr_in6*) &sa)->sin6_port :
+                ((sockaddr_in*) &sa)->sin_port);
+        ostringstream as;
+        as << "tcp:" << location.substr(0, location.rfind(':')) << ':' << port;
+        maddress = as.str();
+    }
+    if (listen(mfd, SOMAXCONN) < 0)
+    {
+        close(mfd);
+        throwSystemError("Cannot listen at " + address);
+    }
+}
+
+
+SocketListener::~SocketListener()
+{
+    close(mfd);
+    if (!munixpath.empty())  unlink(munixpath.c_str());
+}
+
+// Public Methods ------------------------------------------------------------
+
+
+const string& SocketListener::address() const
+{
+    return maddress;
+}
+
+
+PQChannelPtr SocketListener::accept()
+{
+    int fd;
+    do  { fd = ::accept(mfd, NULL, NULL); }
+    while (fd < 0 && errno == EINTR);
+    if (fd < 0)  throwSystemError("accept");
+    boost::shared_ptr<SocketChannel> rv(new SocketChannel(fd));
+    rv->setMaxMessageSize(mmaxmessagesize);
+    return rv;
+}
+
+
+void SocketListener::setMaxMessageSize(uint64_t n)
+{
+    mmaxmessagesize = n;
+}
+
+
+const uint64_t& SocketListener::getMaxMessageSize() const
+{
+    return mmaxmessagesize;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
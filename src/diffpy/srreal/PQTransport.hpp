@@ -0,0 +1,178 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PQTransportError -- failure of a connection to a remote worker
+*
+* class PQChannel -- abstract message channel to a remote worker
+*
+* class PQTransport -- abstract source of channels to a set of workers
+*
+* class SocketChannel -- PQChannel over a connected stream socket
+*
+* class SocketTransport -- PQTransport to workers listening at TCP or
+*     Unix-domain socket addresses
+*
+* class SocketListener -- worker-side socket that accepts channels
+*
+*****************************************************************************/
+
+// Socket addresses are written as "tcp:HOST:PORT" or "unix:PATH".
+// Messages are framed by their 8-byte big-endian length.  Frames longer
+// than the channel limit are rejected with PQTransportError.
+//
+// The channels are not authenticated and the workers deserialize boost
+// archives received from any peer.  Listen only at Unix-domain sockets or
+// at TCP addresses reachable from trusted hosts, such as "tcp:127.0.0.1:0"
+// or a private cluster network.  "tcp:*:PORT" accepts connections from
+// all network interfaces.
+
+#ifndef PQTRANSPORT_HPP_INCLUDED
+#define PQTRANSPORT_HPP_INCLUDED
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class PQTransportError : public std::runtime_error
+{
+    public:
+
+        explicit PQTransportError(const std::string& what) :
+            std::runtime_error(what)
+        { }
+};
+
+
+class PQChannel
+{
+    public:
+
+        virtual ~PQChannel()  { }
+
+        /// send one complete message, throw PQTransportError on failure
+        virtual void send(const std::string& message) = 0;
+        /// receive one complete message, throw PQTransportError on failure
+        /// or when the other side closes the channel
+        virtual std::string receive() = 0;
+};
+
+typedef boost::shared_ptr<PQChannel> PQChannelPtr;
+
+
+class PQTransport
+{
+    public:
+
+        virtual ~PQTransport()  { }
+
+        virtual int countWorkers() const = 0;
+        /// open channel to the worker at index widx,
+        /// throw PQTransportError when the worker is unavailable
+        virtual PQChannelPtr connect(int widx) = 0;
+};
+
+typedef boost::shared_ptr<PQTransport> PQTransportPtr;
+
+
+class SocketChannel : public PQChannel
+{
+    public:
+
+        /// take ownership of a connected socket descriptor
+        explicit SocketChannel(int fd);
+        ~SocketChannel();
+
+        // class constants
+        static const uint64_t DEFAULT_MAX_MESSAGE_SIZE;
+
+        virtual void send(const std::string& message);
+        virtual std::string receive();
+        /// limit the wait for sending or receiving data, no limit when zero
+        void setTimeout(double seconds);
+        /// largest accepted message in bytes
+        void setMaxMessageSize(uint64_t n);
+        const uint64_t& getMaxMessageSize() const;
+
+    private:
+
+        int mfd;
+        uint64_t mmaxmessagesize;
+
+        // non-copyable
+        SocketChannel(const SocketChannel&);
+        SocketChannel& operator=(const SocketChannel&);
+};
+
+
+class SocketTransport : public PQTransport
+{
+    public:
+
+        // class constants
+        static const double DEFAULT_TIMEOUT;
+
+        explicit SocketTransport(const std::vector<std::string>& addresses);
+
+        virtual int countWorkers() const;
+        virtual PQChannelPtr connect(int widx);
+        /// timeout in seconds for a worker reply on the opened channels,
+        /// no limit when zero.  Workers that time out are treated as failed
+        /// and must finish each partition within this time.
+        void setTimeout(double seconds);
+        const double& getTimeout() const;
+
+    private:
+
+        std::vector<std::string> maddresses;
+        double mtimeout;
+};
+
+
+class SocketListener
+{
+    public:
+
+        /// bind and listen at the address.  TCP port 0 selects a free port.
+        explicit SocketListener(const std::string& address);
+        ~SocketListener();
+
+        /// actual address including the selected TCP port
+        const std::string& address() const;
+        /// wait for the next connection
+        PQChannelPtr accept();
+        /// largest message accepted on the new channels
+        void setMaxMessageSize(uint64_t n);
+        const uint64_t& getMaxMessageSize() const;
+
+    private:
+
+        int mfd;
+        uint64_t mmaxmessagesize;
+        std::string maddress;
+        std::string munixpath;
+
+        // non-copyable
+        SocketListener(const SocketListener&);
+        SocketListener& operator=(const SocketListener&);
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // PQTRANSPORT_HPP_INCLUDED
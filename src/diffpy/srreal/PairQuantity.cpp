@@ -19,12 +19,16 @@
 #include <algorithm>
 #include <locale>
 #include <sstream>
+#include <stdint.h>
 
 #include <diffpy/srreal/PairQuantity.hpp>
+#include <diffpy/srreal/SharedMemorySegment.hpp>
 #include <diffpy/mathutils.hpp>
+#include <diffpy/validators.hpp>
 #include <diffpy/serialization.ipp>
 
 using namespace std;
+using namespace diffpy::validators;
 
 namespace diffpy {
 namespace srreal {
@@ -34,13 +38,34 @@ namespace srreal {
 const int PairQuantity::ALLATOMSINT = -1;
 const string PairQuantity::ALLATOMSSTR = "all";
 
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+const double DEFAULT_CHECKPOINT_INTERVAL = 600.0;
+
+/// objects are serialized without value and evaluator when set
+thread_local bool gsetuponly = false;
+
+string upcaseAllAtoms()
+{
+    string rv = PairQuantity::ALLATOMSSTR;
+    transform(rv.begin(), rv.end(), rv.begin(), ::toupper);
+    return rv;
+}
+
+}   // namespace
+
 // Constructor ---------------------------------------------------------------
 
 PairQuantity::PairQuantity() :
     mstructure(emptyStructureAdapter()),
     mrmin(0.0),
     mrmax(DEFAULT_BONDGENERATOR_RMAX),
-    mdefaultpairmask(true)
+    mdefaultpairmask(true),
+    mstatisticsenabled(false),
+    mprogress(NULL),
+    mcheckpointinterval(DEFAULT_CHECKPOINT_INTERVAL)
 {
     this->setEvaluatorType(BASIC);
     // attributes
@@ -60,12 +85,34 @@ const QuantityType& PairQuantity::eval()
 
 const QuantityType& PairQuantity::eval(StructureAdapterPtr stru)
 {
-    mevaluator->updateValue(*this, stru);
-    this->finishValue();
+    try {
+        mevaluator->updateValue(*this, stru);
+    }
+    // discard partial sums and force full evaluation next time
+    catch (PQEvaluationCancelled&) {
+        this->resetValue();
+        mticker.click();
+        throw;
+    }
+    PQStatistics* stats = this->activeStatistics();
+    {
+        PQStatisticsTimer tm(stats, &PQStatistics::postprocessingtime);
+        this->finishValue();
+    }
+    this->recordBufferBytes();
+    if (stats)  ++(stats->evaluations);
+    mvalue_ticker.click();
     return this->value();
 }
 
 
+PQAsyncEvaluationPtr PairQuantity::evalAsync(StructureAdapterPtr stru)
+{
+    PQAsyncEvaluationPtr rv(new PQAsyncEvaluation(*this, stru));
+    return rv;
+}
+
+
 void PairQuantity::setStructure(StructureAdapterPtr stru)
 {
     mstructure = stru.get() ? stru : emptyStructureAdapter();
@@ -95,14 +142,9 @@ const QuantityType& PairQuantity::value() const
 
 void PairQuantity::mergeParallelData(const string& pdata, int ncpu)
 {
-    if (mmergedvaluescount >= ncpu)
-    {
-        const char* emsg = "Number of merged values exceeds NCPU.";
-        throw runtime_error(emsg);
-    }
+    this->checkParallelMergeCount(ncpu);
     this->executeParallelMerge(pdata);
-    ++mmergedvaluescount;
-    if (mmergedvaluescount == ncpu)  this->finishValue();
+    this->finishParallelMerge(ncpu);
 }
 
 
@@ -115,6 +157,36 @@ string PairQuantity::getParallelData() const
 }
 
 
+void PairQuantity::writeParallelSegment(const string& name) const
+{
+    // segment starts with the array length padded to the double size
+    const size_t n = this->countParallelArray();
+    SharedMemorySegmentPtr seg = SharedMemorySegment::create(name,
+            sizeof(double) + n * sizeof(double));
+    double* pdata = static_cast<double*>(seg->data());
+    *reinterpret_cast<uint64_t*>(pdata) = n;
+    this->copyParallelArray(pdata + 1);
+}
+
+
+void PairQuantity::mergeParallelSegment(const string& name, int ncpu)
+{
+    this->checkParallelMergeCount(ncpu);
+    SharedMemorySegmentPtr seg = SharedMemorySegment::open(name);
+    seg->unlink();
+    const double* pdata = static_cast<const double*>(seg->data());
+    const uint64_t n = (seg->size() >= sizeof(double)) ?
+        *reinterpret_cast<const uint64_t*>(pdata) : 0;
+    if (seg->size() != sizeof(double) + n * sizeof(double))
+    {
+        const char* emsg = "Invalid size of the shared memory segment.";
+        throw runtime_error(emsg);
+    }
+    this->executeParallelArrayMerge(pdata + 1, n);
+    this->finishParallelMerge(ncpu);
+}
+
+
 void PairQuantity::setRmin(double rmin)
 {
     if (mrmin != rmin)  mticker.click();
@@ -177,6 +249,8 @@ PQEvaluatorType PairQuantity::getEvaluatorTypeUsed() const
 void PairQuantity::setupParallelRun(int cpuindex, int ncpu)
 {
     mevaluator->setupParallelRun(cpuindex, ncpu);
+    // a different partition of pairs cannot be updated incrementally
+    mticker.click();
 }
 
 
@@ -273,13 +347,7 @@ bool PairQuantity::getPairMask(int i, int j) const
 void PairQuantity::
 setTypeMask(string smbli, string smblj, bool mask)
 {
-    static string upcaseall;
-    if (upcaseall.empty())
-    {
-        upcaseall = ALLATOMSSTR;
-        transform(upcaseall.begin(), upcaseall.end(),
-                upcaseall.begin(), ::toupper);
-    }
+    static const string upcaseall = upcaseAllAtoms();
     // accept "ALL" (upper ALLATOMSSTR) for smbli and smblj
     if (upcaseall == smbli)  smbli = ALLATOMSSTR;
     if (upcaseall == smblj)  smblj = ALLATOMSSTR;
@@ -337,11 +405,61 @@ bool PairQuantity::getTypeMask(const string& smbli, const string& smblj) const
     return rv;
 }
 
+
+void PairQuantity::setStatisticsEnabled(bool flag)
+{
+    mstatisticsenabled = flag;
+}
+
+
+bool PairQuantity::getStatisticsEnabled() const
+{
+    return mstatisticsenabled;
+}
+
+
+const PQStatistics& PairQuantity::getStatistics() const
+{
+    return mstatistics;
+}
+
+
+void PairQuantity::resetStatistics()
+{
+    mstatistics.clear();
+}
+
+
+void PairQuantity::setCheckpointFile(const string& filename)
+{
+    mcheckpointfile = filename;
+}
+
+
+const string& PairQuantity::getCheckpointFile() const
+{
+    return mcheckpointfile;
+}
+
+
+void PairQuantity::setCheckpointInterval(double seconds)
+{
+    ensureNonNegative("checkpoint interval", seconds);
+    mcheckpointinterval = seconds;
+}
+
+
+const double& PairQuantity::getCheckpointInterval() const
+{
+    return mcheckpointinterval;
+}
+
 // Protected Methods ---------------------------------------------------------
 
 void PairQuantity::resizeValue(size_t sz)
 {
     mvalue.resize(sz);
+    mvalue_ticker.click();
 }
 
 
@@ -349,6 +467,7 @@ void PairQuantity::resetValue()
 {
     mmergedvaluescount = 0;
     fill(mvalue.begin(), mvalue.end(), 0.0);
+    mvalue_ticker.click();
 }
 
 
@@ -374,6 +493,29 @@ void PairQuantity::executeParallelMerge(const string& pdata)
 }
 
 
+size_t PairQuantity::countParallelArray() const
+{
+    return this->value().size();
+}
+
+
+void PairQuantity::copyParallelArray(double* pdata) const
+{
+    copy(this->value().begin(), this->value().end(), pdata);
+}
+
+
+void PairQuantity::executeParallelArrayMerge(const double* pdata, size_t n)
+{
+    if (n != mvalue.size())
+    {
+        throw invalid_argument("Merged data array must have the same size.");
+    }
+    transform(mvalue.begin(), mvalue.end(), pdata,
+            mvalue.begin(), plus<double>());
+}
+
+
 int PairQuantity::countSites() const
 {
     int rv = mstructure.get() ? mstructure->countSites() : 0;
@@ -402,6 +544,27 @@ bool PairQuantity::hasTypeMask() const
 }
 
 
+PQStatistics* PairQuantity::activeStatistics() const
+{
+    return mstatisticsenabled ? &mstatistics : NULL;
+}
+
+
+size_t PairQuantity::countBufferBytes() const
+{
+    return mvalue.capacity() * sizeof(QuantityType::value_type);
+}
+
+
+void PairQuantity::recordBufferBytes() const
+{
+    PQStatistics* stats = this->activeStatistics();
+    if (!stats)  return;
+    long nbytes = this->countBufferBytes();
+    stats->bufferbytes = max(stats->bufferbytes, nbytes);
+}
+
+
 void PairQuantity::stashPartialValue()
 {
     const char* emsg =
@@ -419,6 +582,29 @@ void PairQuantity::restorePartialValue()
 
 // Private Methods -----------------------------------------------------------
 
+void PairQuantity::checkParallelMergeCount(int ncpu) const
+{
+    if (mmergedvaluescount >= ncpu)
+    {
+        const char* emsg = "Number of merged values exceeds NCPU.";
+        throw runtime_error(emsg);
+    }
+}
+
+
+void PairQuantity::finishParallelMerge(int ncpu)
+{
+    ++mmergedvaluescount;
+    if (mmergedvaluescount == ncpu)
+    {
+        PQStatisticsTimer tm(this->activeStatistics(),
+                &PQStatistics::postprocessingtime);
+        this->finishValue();
+    }
+    mvalue_ticker.click();
+}
+
+
 void PairQuantity::updateMaskData()
 {
     int cntsites = this->countSites();
@@ -488,6 +674,27 @@ bool PairQuantity::setPairMaskValue(int i, int j, bool mask)
     return rv;
 }
 
+
+bool PairQuantity::setupOnly()
+{
+    return gsetuponly;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// class PairQuantity::SetupOnly
+//////////////////////////////////////////////////////////////////////////////
+
+PairQuantity::SetupOnly::SetupOnly() : mprevious(gsetuponly)
+{
+    gsetuponly = true;
+}
+
+
+PairQuantity::SetupOnly::~SetupOnly()
+{
+    gsetuponly = mprevious;
+}
+
 // Other functions -----------------------------------------------------------
 
 /// The purpose of this function is to support Python pickling of
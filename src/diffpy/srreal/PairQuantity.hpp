@@ -22,11 +22,15 @@
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/assume_abstract.hpp>
 #include <boost/serialization/utility.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/set.hpp>
 #include <boost/serialization/unordered_set.hpp>
 #include <boost/serialization/unordered_map.hpp>
 #include <boost/functional/hash.hpp>
 
 #include <diffpy/srreal/PQEvaluator.hpp>
+#include <diffpy/srreal/PQStatistics.hpp>
+#include <diffpy/srreal/PQAsyncEvaluation.hpp>
 #include <diffpy/srreal/StructureAdapter.hpp>
 #include <diffpy/srreal/QuantityType.hpp>
 #include <diffpy/Attributes.hpp>
@@ -53,9 +57,16 @@ class PairQuantity : public diffpy::Attributes
         const QuantityType& eval();
         template <class T> const QuantityType& eval(const T&);
         const QuantityType& eval(StructureAdapterPtr);
+        /// start evaluation in a background thread
+        template <class T> PQAsyncEvaluationPtr evalAsync(const T&);
+        PQAsyncEvaluationPtr evalAsync(StructureAdapterPtr);
         const QuantityType& value() const;
         void mergeParallelData(const std::string& pdata, int ncpu);
         virtual std::string getParallelData() const;
+        /// store partial result in a new shared memory segment
+        void writeParallelSegment(const std::string& name) const;
+        /// merge and remove a segment created by writeParallelSegment
+        void mergeParallelSegment(const std::string& name, int ncpu);
 
         // configuration
         template <class T> void setStructure(const T&);
@@ -76,14 +87,32 @@ class PairQuantity : public diffpy::Attributes
         bool getPairMask(int i, int j) const;
         void setTypeMask(std::string, std::string, bool mask);
         bool getTypeMask(const std::string&, const std::string&) const;
+        /// enable collection of the evaluation statistics
+        void setStatisticsEnabled(bool flag);
+        bool getStatisticsEnabled() const;
+        /// statistics accumulated since the last resetStatistics call
+        const PQStatistics& getStatistics() const;
+        void resetStatistics();
+        /// file for checkpoints of full evaluations, disabled when empty
+        void setCheckpointFile(const std::string& filename);
+        const std::string& getCheckpointFile() const;
+        /// minimum time in seconds between checkpoint saves
+        void setCheckpointInterval(double seconds);
+        const double& getCheckpointInterval() const;
 
         // ticker for any updates in configuration
         virtual eventticker::EventTicker& ticker() const  { return mticker; }
+        /// ticker for the last modification of the value array
+        const eventticker::EventTicker& valueTicker() const
+        {
+            return mvalue_ticker;
+        }
 
     protected:
 
         friend class PQEvaluatorBasic;
         friend class PQEvaluatorOptimized;
+        friend class PQAsyncEvaluation;
         friend StructureAdapterPtr
             replacePairQuantityStructure(PairQuantity&, StructureAdapterPtr);
 
@@ -93,15 +122,48 @@ class PairQuantity : public diffpy::Attributes
         virtual void configureBondGenerator(BaseBondGenerator&) const;
         virtual void addPairContribution(const BaseBondGenerator&, int) { }
         virtual void executeParallelMerge(const std::string& pdata);
+        // partial result as a flat array for the shared memory merge
+        virtual size_t countParallelArray() const;
+        virtual void copyParallelArray(double* pdata) const;
+        virtual void executeParallelArrayMerge(const double* pdata, size_t n);
         virtual void finishValue() { }
+        /// add contributions held outside of mvalue before it is saved
+        virtual void flushPartialValue() { }
         int countSites() const;
         // support methods for PQEvaluatorOptimized
         bool hasMask() const;
         bool hasPairMask() const;
         bool hasTypeMask() const;
+        /// statistics to be updated or NULL when they are disabled
+        PQStatistics* activeStatistics() const;
+        /// progress of an asynchronous evaluation or NULL
+        PQProgress* activeProgress() const  { return mprogress; }
+        /// memory in bytes held by the value and work buffers
+        virtual size_t countBufferBytes() const;
+        /// record buffer size in the active statistics
+        void recordBufferBytes() const;
         virtual void stashPartialValue();
         virtual void restorePartialValue();
 
+        /// PairQuantity objects in this thread are serialized without
+        /// their value and evaluator while an instance exists.  Masks are
+        /// written sorted so that equal setups give equal archives.
+        class SetupOnly
+        {
+            public:
+
+                SetupOnly();
+                ~SetupOnly();
+
+            private:
+
+                bool mprevious;
+
+                // non-copyable
+                SetupOnly(const SetupOnly&);
+                SetupOnly& operator=(const SetupOnly&);
+        };
+
         // data
         typedef std::unordered_set<
             std::pair<int,int>,
@@ -122,18 +184,50 @@ class PairQuantity : public diffpy::Attributes
         TypeMaskStorage mtypemask;
         int mmergedvaluescount;
         mutable eventticker::EventTicker mticker;
+        eventticker::EventTicker mvalue_ticker;
+        // evaluation statistics are diagnostic and not serialized
+        bool mstatisticsenabled;
+        mutable PQStatistics mstatistics;
+        // progress is attached only during evalAsync
+        PQProgress* mprogress;
+        // checkpoint setup is specific to the host and not serialized
+        std::string mcheckpointfile;
+        double mcheckpointinterval;
 
     private:
 
         // methods
+        void checkParallelMergeCount(int ncpu) const;
+        void finishParallelMerge(int ncpu);
         void updateMaskData();
         bool setPairMaskValue(int i, int j, bool mask);
+        // true within the scope of SetupOnly in this thread
+        static bool setupOnly();
 
         // serialization
         friend class boost::serialization::access;
         template<class Archive>
             void serialize(Archive& ar, const unsigned int version)
         {
+            if (PairQuantity::setupOnly())
+            {
+                std::set< std::pair<int,int> > pairmask(
+                        minvertpairmask.begin(), minvertpairmask.end());
+                std::map<int, bool> siteallmask(
+                        msiteallmask.begin(), msiteallmask.end());
+                std::map<std::pair<std::string,std::string>, bool> typemask(
+                        mtypemask.begin(), mtypemask.end());
+                ar & mstructure;
+                ar & mrmin;
+                ar & mrmax;
+                ar & mdefaultpairmask;
+                ar & pairmask;
+                ar & siteallmask;
+                ar & typemask;
+                ar & mmergedvaluescount;
+                ar & mticker;
+                return;
+            }
             ar & mvalue;
             ar & mstructure;
             ar & mrmin;
@@ -159,6 +253,14 @@ const QuantityType& PairQuantity::eval(const T& stru)
 }
 
 
+template <class T>
+PQAsyncEvaluationPtr PairQuantity::evalAsync(const T& stru)
+{
+    StructureAdapterPtr pstru = convertToStructureAdapter(stru);
+    return this->evalAsync(pstru);
+}
+
+
 template <class T>
 void PairQuantity::setStructure(const T& stru)
 {
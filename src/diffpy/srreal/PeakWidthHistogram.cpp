@@ -0,0 +1,304 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2013 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PeakWidthHistogram -- distance histogram of pair contributions
+*     binned by the peak width.
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include <algorithm>
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_fft_complex.h>
+
+#include <diffpy/srreal/PeakWidthHistogram.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Constants and Helpers -----------------------------------------------
+
+namespace {
+
+const char* EMSGFFT = "Fourier Transformation failed.";
+/// lower limit of the profile precision used for the error control
+const double MIN_HISTOGRAM_PRECISION = 1e-8;
+/// upper limit for the spacing of width classes in log(fwhm)
+const double MAX_LOGWIDTH_STEP = 0.1;
+/// number of samples for estimating the profile curvature
+const int CURVATURE_SAMPLES = 512;
+/// relative cost of one FFT convolution term to one direct summation term
+const double FFT_COST_FACTOR = 8.0;
+
+/// floor of the integer division for any sign of the numerator
+inline int floordiv(int a, int b)
+{
+    assert(b > 0);
+    return (a >= 0) ? (a / b) : -((-a + b - 1) / b);
+}
+
+}   // namespace
+
+// Constructor ---------------------------------------------------------------
+
+PeakWidthHistogram::PeakWidthHistogram() :
+    mrstep(0.0),
+    mlogwidthstep(MAX_LOGWIDTH_STEP),
+    mbinsizerel(0.0)
+{ }
+
+// Public Methods ------------------------------------------------------------
+
+void PeakWidthHistogram::setup(const PeakProfile& pkf, double rstep)
+{
+    assert(rstep > 0.0);
+    this->clear();
+    mrstep = rstep;
+    // estimate maximum second derivatives of the unit-width profile
+    // with respect to x and log(fwhm) relative to the peak maximum.
+    const double xlo = 0.98 * pkf.xboundlo(1.0);
+    const double xhi = 0.98 * pkf.xboundhi(1.0);
+    const double dx = 1e-3;
+    const double du = 1e-3;
+    const double wlo = exp(-du);
+    const double whi = exp(du);
+    double ymax = pkf(0.0, 1.0);
+    double cx = 0.0;
+    double cu = 0.0;
+    for (int i = 0; i <= CURVATURE_SAMPLES && xlo < xhi; ++i)
+    {
+        double x = xlo + i * (xhi - xlo) / CURVATURE_SAMPLES;
+        double y = pkf(x, 1.0);
+        ymax = max(ymax, y);
+        cx = max(cx, fabs(pkf(x - dx, 1.0) - 2 * y + pkf(x + dx, 1.0)));
+        cu = max(cu, fabs(pkf(x, wlo) - 2 * y + pkf(x, whi)));
+    }
+    cx = (ymax > 0.0) ? (cx / (dx * dx * ymax)) : 0.0;
+    cu = (ymax > 0.0) ? (cu / (du * du * ymax)) : 0.0;
+    // Error of the linear interpolation is h**2 / 8 * max|f''|.
+    // Split the profile precision between the width and distance binning.
+    const double eps = max(MIN_HISTOGRAM_PRECISION, pkf.getPrecision());
+    mlogwidthstep = (cu > 0.0) ?
+        min(MAX_LOGWIDTH_STEP, sqrt(4 * eps / cu)) : MAX_LOGWIDTH_STEP;
+    mbinsizerel = (cx > 0.0) ? sqrt(4 * eps / cx) : 1.0;
+}
+
+
+void PeakWidthHistogram::add(double distance, double fwhm, double weight)
+{
+    if (fwhm <= 0.0 || weight == 0.0)  return;
+    assert(mrstep > 0.0);
+    double t = log(fwhm) / mlogwidthstep;
+    int k = int(floor(t));
+    double frac = t - k;
+    this->deposit(this->getWidthClass(k), distance, (1 - frac) * weight);
+    this->deposit(this->getWidthClass(k + 1), distance, frac * weight);
+}
+
+
+void PeakWidthHistogram::flush(
+        const PeakProfile& pkf, QuantityType& y, int rlosteps)
+{
+    if (this->empty())  return;
+    QuantityType acc(y.size(), 0.0);
+    std::map<int, WidthClass>::const_iterator wci = mclasses.begin();
+    for (; wci != mclasses.end(); ++wci)
+    {
+        const WidthClass& wc = wci->second;
+        if (wc.weights.empty())  continue;
+        // sample the profile on the fine grid of the class
+        const double fwhm = exp(wci->first * mlogwidthstep);
+        const double& h = wc.binsize;
+        const int kernello = int(floor(pkf.xboundlo(fwhm) / h));
+        const int kernelhi = int(ceil(pkf.xboundhi(fwhm) / h));
+        vector<double> kernel;
+        kernel.reserve(kernelhi - kernello + 1);
+        for (int j = kernello; j <= kernelhi; ++j)
+        {
+            kernel.push_back(pkf(j * h, fwhm));
+        }
+        // pick the cheaper convolution method
+        const double nbins = wc.weights.size();
+        const double nnz = wc.weights.size() -
+            count(wc.weights.begin(), wc.weights.end(), 0.0);
+        const double costdirect =
+            nnz * (double(kernel.size()) / wc.finesteps + 1);
+        int npad = 1;
+        while (npad < nbins + kernel.size() - 1)  npad *= 2;
+        const double costfft = FFT_COST_FACTOR * npad * log2(2.0 * npad);
+        if (costdirect <= costfft)
+        {
+            this->convolveDirect(kernel, kernello, wc, rlosteps, acc);
+        }
+        else
+        {
+            this->convolveFFT(kernel, kernello, wc, rlosteps, acc);
+        }
+    }
+    // contributions to RDF are scaled by r / distance, where the
+    // distance division has been applied to the histogram weights.
+    for (size_t i = 0; i < y.size(); ++i)
+    {
+        y[i] += acc[i] * (rlosteps + int(i)) * mrstep;
+    }
+    this->clear();
+}
+
+
+void PeakWidthHistogram::clear()
+{
+    mclasses.clear();
+}
+
+
+bool PeakWidthHistogram::empty() const
+{
+    return mclasses.empty();
+}
+
+
+int PeakWidthHistogram::countWidthClasses() const
+{
+    return mclasses.size();
+}
+
+
+size_t PeakWidthHistogram::countBytes() const
+{
+    size_t rv = 0;
+    std::map<int, WidthClass>::const_iterator wci = mclasses.begin();
+    for (; wci != mclasses.end(); ++wci)
+    {
+        const WidthClass& wc = wci->second;
+        rv += sizeof(WidthClass) + wc.weights.capacity() * sizeof(double);
+    }
+    return rv;
+}
+
+// Private Methods -----------------------------------------------------------
+
+PeakWidthHistogram::WidthClass& PeakWidthHistogram::getWidthClass(int k)
+{
+    std::map<int, WidthClass>::iterator wci = mclasses.find(k);
+    if (wci != mclasses.end())  return wci->second;
+    WidthClass& wc = mclasses[k];
+    const double fwhm = exp(k * mlogwidthstep);
+    wc.finesteps = max(1, int(ceil(mrstep / (fwhm * mbinsizerel))));
+    wc.binsize = mrstep / wc.finesteps;
+    wc.binlo = 0;
+    return wc;
+}
+
+
+void PeakWidthHistogram::deposit(
+        WidthClass& wc, double distance, double weight)
+{
+    double t = distance / wc.binsize;
+    int b = int(floor(t));
+    double frac = t - b;
+    // extend the bin range to hold b and b + 1
+    if (wc.weights.empty())
+    {
+        wc.binlo = b;
+        wc.weights.assign(2, 0.0);
+    }
+    if (b < wc.binlo)
+    {
+        int n = max(wc.binlo - b, int(wc.weights.size()));
+        wc.weights.insert(wc.weights.begin(), n, 0.0);
+        wc.binlo -= n;
+    }
+    if (b + 1 >= wc.binlo + int(wc.weights.size()))
+    {
+        int n = max(b + 2 - wc.binlo, 2 * int(wc.weights.size()));
+        wc.weights.resize(n, 0.0);
+    }
+    double* w = &(wc.weights[b - wc.binlo]);
+    w[0] += (1 - frac) * weight;
+    w[1] += frac * weight;
+}
+
+
+void PeakWidthHistogram::convolveDirect(
+        const vector<double>& kernel, int kernello,
+        const WidthClass& wc, int rlosteps, QuantityType& acc) const
+{
+    const int m = wc.finesteps;
+    const int kernelhi = kernello + int(kernel.size()) - 1;
+    const int npts = acc.size();
+    for (size_t ib = 0; ib < wc.weights.size(); ++ib)
+    {
+        const double& w = wc.weights[ib];
+        if (w == 0.0)  continue;
+        const int b = wc.binlo + int(ib);
+        // output points at fine index p = (rlosteps + i) * m
+        // such that kernello <= p - b <= kernelhi
+        int i = max(0, floordiv(b + kernello + m - 1, m) - rlosteps);
+        int ilast = min(npts, floordiv(b + kernelhi, m) - rlosteps + 1);
+        if (i >= ilast)  continue;
+        const double* kp = &(kernel[0]) + (rlosteps + i) * m - b - kernello;
+        for (; i < ilast; ++i, kp += m)  acc[i] += w * (*kp);
+    }
+}
+
+
+void PeakWidthHistogram::convolveFFT(
+        const vector<double>& kernel, int kernello,
+        const WidthClass& wc, int rlosteps, QuantityType& acc) const
+{
+    const int m = wc.finesteps;
+    const int nbins = wc.weights.size();
+    const int nconv = nbins + int(kernel.size()) - 1;
+    int npad = 1;
+    while (npad < nconv)  npad *= 2;
+    // complex arrays with interleaved real and imaginary parts
+    vector<double> hc(2 * npad, 0.0);
+    vector<double> kc(2 * npad, 0.0);
+    for (int i = 0; i < nbins; ++i)  hc[2 * i] = wc.weights[i];
+    for (size_t i = 0; i < kernel.size(); ++i)  kc[2 * i] = kernel[i];
+    int status;
+    status = gsl_fft_complex_radix2_forward(&(hc[0]), 1, npad);
+    if (status != GSL_SUCCESS)  throw invalid_argument(EMSGFFT);
+    status = gsl_fft_complex_radix2_forward(&(kc[0]), 1, npad);
+    if (status != GSL_SUCCESS)  throw invalid_argument(EMSGFFT);
+    for (int i = 0; i < npad; ++i)
+    {
+        double re = hc[2 * i] * kc[2 * i] - hc[2 * i + 1] * kc[2 * i + 1];
+        double im = hc[2 * i] * kc[2 * i + 1] + hc[2 * i + 1] * kc[2 * i];
+        hc[2 * i] = re;
+        hc[2 * i + 1] = im;
+    }
+    status = gsl_fft_complex_radix2_inverse(&(hc[0]), 1, npad);
+    if (status != GSL_SUCCESS)  throw invalid_argument(EMSGFFT);
+    // convolution index q corresponds to fine index binlo + kernello + q
+    const int p0 = wc.binlo + kernello;
+    const int npts = acc.size();
+    int i = max(0, floordiv(p0 + m - 1, m) - rlosteps);
+    int ilast = min(npts, floordiv(p0 + nconv - 1, m) - rlosteps + 1);
+    for (; i < ilast; ++i)
+    {
+        int q = (rlosteps + i) * m - p0;
+        assert(0 <= q && q < nconv);
+        acc[i] += hc[2 * q];
+    }
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
@@ -0,0 +1,95 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2013 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PeakWidthHistogram -- distance histogram of pair contributions
+*     binned by the peak width.
+*
+* Pair weights are split linearly between two neighboring width classes
+* that are equidistant in log(fwhm) and between two neighboring bins of
+* a fine distance grid of the class.  Each class is then convolved with
+* the peak profile once, by direct summation or FFT, whatever is cheaper.
+* The class and bin spacings are set so that the interpolation errors
+* stay below the profile precision relative to the peak maximum.
+* The peak profile is assumed shape invariant, f(x, w) = f(x / w, 1) / w.
+*
+*****************************************************************************/
+
+#ifndef PEAKWIDTHHISTOGRAM_HPP_INCLUDED
+#define PEAKWIDTHHISTOGRAM_HPP_INCLUDED
+
+#include <map>
+#include <vector>
+
+#include <diffpy/srreal/PeakProfile.hpp>
+#include <diffpy/srreal/QuantityType.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class PeakWidthHistogram
+{
+    public:
+
+        // constructor
+        PeakWidthHistogram();
+
+        // methods
+        /// clear the histogram and adjust its spacings to the peak
+        /// profile precision and to the output r-grid step
+        void setup(const PeakProfile& pkf, double rstep);
+        /// add pair weight at the specified distance and peak width
+        void add(double distance, double fwhm, double weight);
+        /// add histogram convolved with the peak profile and multiplied
+        /// by r to y at r = (rlosteps + i) * rstep and clear the histogram
+        void flush(const PeakProfile& pkf, QuantityType& y, int rlosteps);
+        /// remove all pair weights
+        void clear();
+        /// return true when there are no pair weights
+        bool empty() const;
+        /// number of width classes in use
+        int countWidthClasses() const;
+        /// memory in bytes held by the width class grids
+        size_t countBytes() const;
+
+    private:
+
+        // types
+        struct WidthClass
+        {
+            int finesteps;
+            double binsize;
+            int binlo;
+            std::vector<double> weights;
+        };
+
+        // methods
+        WidthClass& getWidthClass(int k);
+        void deposit(WidthClass& wc, double distance, double weight);
+        void convolveDirect(const std::vector<double>& kernel, int kernello,
+                const WidthClass& wc, int rlosteps, QuantityType& acc) const;
+        void convolveFFT(const std::vector<double>& kernel, int kernello,
+                const WidthClass& wc, int rlosteps, QuantityType& acc) const;
+
+        // data
+        double mrstep;
+        double mlogwidthstep;
+        double mbinsizerel;
+        std::map<int, WidthClass> mclasses;
+
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // PEAKWIDTHHISTOGRAM_HPP_INCLUDED
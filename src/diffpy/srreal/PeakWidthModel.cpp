@@ -16,7 +16,12 @@
 *
 *****************************************************************************/
 
+#include <typeinfo>
+
 #include <diffpy/srreal/PeakWidthModel.hpp>
+#include <diffpy/srreal/ConstantPeakWidth.hpp>
+#include <diffpy/srreal/DebyeWallerPeakWidth.hpp>
+#include <diffpy/srreal/JeongPeakWidth.hpp>
 #include <diffpy/HasClassRegistry.ipp>
 #include <diffpy/validators.hpp>
 #include <diffpy/serialization.ipp>
@@ -60,6 +65,16 @@ const PeakWidthModelPtr& PeakWidthModelOwner::getPeakWidthModel() const
 }
 
 
+bool PeakWidthModelOwner::hasBondLengthPeakWidth() const
+{
+    if (!mpwmodel)  return false;
+    const std::type_info& tp = typeid(*mpwmodel);
+    return (tp == typeid(ConstantPeakWidth) ||
+            tp == typeid(DebyeWallerPeakWidth) ||
+            tp == typeid(JeongPeakWidth));
+}
+
+
 eventticker::EventTicker& PeakWidthModelOwner::ticker() const
 {
     if (mpwmodel)  mprivateticker.updateFrom(mpwmodel->ticker());
@@ -80,6 +80,10 @@ class PeakWidthModelOwner
         void setPeakWidthModelByType(const std::string& tp);
         PeakWidthModelPtr& getPeakWidthModel();
         const PeakWidthModelPtr& getPeakWidthModel() const;
+        /// true for the built-in models, whose peak widths depend only on
+        /// the bond length and mean square displacement.  Derived classes
+        /// may read bond vectors and thus exclude symmetry-unique bonds.
+        bool hasBondLengthPeakWidth() const;
         eventticker::EventTicker& ticker() const;
 
     private:
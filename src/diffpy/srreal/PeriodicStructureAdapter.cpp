@@ -22,7 +22,6 @@
 #include <cassert>
 
 #include <diffpy/serialization.ipp>
-#include <diffpy/srreal/PointsInSphere.hpp>
 #include <diffpy/srreal/StructureDifference.hpp>
 #include <diffpy/srreal/PeriodicStructureAdapter.hpp>
 
@@ -137,6 +136,7 @@ PeriodicStructureBondGenerator::PeriodicStructureBondGenerator(
 {
     mpstructure = dynamic_cast<const PeriodicStructureAdapter*>(adpt.get());
     assert(mpstructure);
+    this->releaseShell();
     int cntsites = mpstructure->countSites();
     mcartesian_positions_uc.reserve(cntsites);
     const Lattice& L = mpstructure->getLattice();
@@ -145,7 +145,7 @@ PeriodicStructureBondGenerator::PeriodicStructureBondGenerator(
     for (; ai != mpstructure->end(); ++ai)
     {
         xyzc = L.ucvCartesian(ai->xyz_cartn);
-        mcartesian_positions_uc.push_back(xyzc);
+        mcartesian_positions_uc.push_back(R3::toPOD(xyzc));
     }
 }
 
@@ -153,18 +153,18 @@ PeriodicStructureBondGenerator::PeriodicStructureBondGenerator(
 
 void PeriodicStructureBondGenerator::rewind()
 {
-    // Delay msphere instantiation to here instead of in constructor,
+    // Delay mshell lookup to here instead of in constructor,
     // so it is possible to use setRmin, setRmax.
-    if (!msphere.get())
+    if (!mshell)
     {
         const Lattice& L = mpstructure->getLattice();
         double buffzone = L.ucMaxDiagonalLength();
         double rsphmin = this->getRmin() - buffzone;
         double rsphmax = this->getRmax() + buffzone;
-        msphere.reset(new PointsInSphere(rsphmin, rsphmax, L));
+        mshell = getLatticeShell(L, rsphmin, rsphmax);
     }
     // BaseBondGenerator::rewind calls this->rewindSymmetry,
-    // which takes care of msphere configuration
+    // which takes care of mshell configuration
     this->BaseBondGenerator::rewind();
 }
 
@@ -172,22 +172,22 @@ void PeriodicStructureBondGenerator::rewind()
 void PeriodicStructureBondGenerator::selectAnchorSite(int anchor)
 {
     this->BaseBondGenerator::selectAnchorSite(anchor);
-    mr0 = mcartesian_positions_uc[anchor];
+    R3::assign(mr0, mcartesian_positions_uc[anchor]);
 }
 
 
 void PeriodicStructureBondGenerator::setRmin(double rmin)
 {
-    // destroy msphere so it will be created on rewind with new rmin
-    if (this->getRmin() != rmin)    msphere.reset();
+    // release mshell so it will be looked up on rewind with new rmin
+    if (this->getRmin() != rmin)    this->releaseShell();
     this->BaseBondGenerator::setRmin(rmin);
 }
 
 
 void PeriodicStructureBondGenerator::setRmax(double rmax)
 {
-    // destroy msphere so it will be created on rewind with new rmax
-    if (this->getRmax() != rmax)    msphere.reset();
+    // release mshell so it will be looked up on rewind with new rmax
+    if (this->getRmax() != rmax)    this->releaseShell();
     this->BaseBondGenerator::setRmax(rmax);
 }
 
@@ -195,19 +195,19 @@ void PeriodicStructureBondGenerator::setRmax(double rmax)
 
 bool PeriodicStructureBondGenerator::iterateSymmetry()
 {
-    msphere->next();
-    bool done = msphere->finished();
-    mrcsphere = done ? R3::zerovector :
-        mpstructure->getLattice().cartesian(msphere->mno());
+    ++mshellidx;
+    bool done = (mshellidx >= mshellend);
+    this->updateShellVector();
     return !done;
 }
 
 
 void PeriodicStructureBondGenerator::rewindSymmetry()
 {
-    msphere->rewind();
-    mrcsphere = msphere->finished() ? R3::zerovector :
-        mpstructure->getLattice().cartesian(msphere->mno());
+    // lattice vectors are iterated in the outer loop over all sites
+    mshellidx = 0;
+    mshellend = mshell->size();
+    this->updateShellVector();
     this->updater1();
 }
 
@@ -224,14 +224,41 @@ void PeriodicStructureBondGenerator::getNextBond()
     if (!this->finished())  this->updater1();
 }
 
+
+void PeriodicStructureBondGenerator::rewindShell(const R3::PODVector& r1uc)
+{
+    using mathutils::SQRT_DOUBLE_EPS;
+    // bond length differs from the lattice vector length at most by d
+    const double d = R3::norm(r1uc - R3::toPOD(mr0)) + SQRT_DOUBLE_EPS;
+    mshellidx = mshell->lowerBound(this->getRmin() - d);
+    mshellend = mshell->upperBound(this->getRmax() + d);
+    this->updateShellVector();
+}
+
 // Private Methods -----------------------------------------------------------
 
 void PeriodicStructureBondGenerator::updater1()
 {
-    mr1 = mrcsphere + mcartesian_positions_uc[this->site1()];
+    R3::assign(mr1, *mprcsphere + mcartesian_positions_uc[this->site1()]);
     this->updateDistance();
 }
 
+
+void PeriodicStructureBondGenerator::releaseShell()
+{
+    mshell.reset();
+    mshellidx = mshellend = 0;
+    this->updateShellVector();
+}
+
+
+void PeriodicStructureBondGenerator::updateShellVector()
+{
+    static const R3::PODVector zerovector = R3::podvector(0.0, 0.0, 0.0);
+    mprcsphere = (mshellidx < mshellend) ?
+        &(mshell->cartesian(mshellidx)) : &zerovector;
+}
+
 }   // namespace srreal
 }   // namespace diffpy
 
@@ -24,12 +24,11 @@
 
 #include <diffpy/srreal/AtomicStructureAdapter.hpp>
 #include <diffpy/srreal/Lattice.hpp>
+#include <diffpy/srreal/LatticeShell.hpp>
 
 namespace diffpy {
 namespace srreal {
 
-class PointsInSphere;
-
 class PeriodicStructureAdapter : public AtomicStructureAdapter
 {
     public:
@@ -92,19 +91,29 @@ class PeriodicStructureBondGenerator : public BaseBondGenerator
 
         // data
         const PeriodicStructureAdapter* mpstructure;
-        std::unique_ptr<PointsInSphere> msphere;
-        R3::Vector mrcsphere;
+        LatticeShellConstPtr mshell;
+        int mshellidx;
+        int mshellend;
+        /// current lattice vector in mshell
+        const R3::PODVector* mprcsphere;
 
         // methods
         virtual bool iterateSymmetry();
         virtual void rewindSymmetry();
         virtual void getNextBond();
         virtual void updater1();
+        /// select lattice vectors that may give bonds in range
+        /// to the unit cell position r1uc in the inner loop
+        void rewindShell(const R3::PODVector& r1uc);
 
     private:
 
         // data
-        std::vector<R3::Vector> mcartesian_positions_uc;
+        R3::PODVectorArray mcartesian_positions_uc;
+
+        // methods
+        void releaseShell();
+        void updateShellVector();
 };
 
 }   // namespace srreal
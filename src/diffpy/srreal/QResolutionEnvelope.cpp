@@ -67,6 +67,17 @@ double QResolutionEnvelope::operator()(const double& r) const
 }
 
 
+void QResolutionEnvelope::apply(const double* r, double* y, size_t n) const
+{
+    if (mqdamp <= 0.0)  return;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double rq = r[i] * mqdamp;
+        y[i] *= exp(-0.5 * rq * rq);
+    }
+}
+
+
 void QResolutionEnvelope::setQdamp(double sc)
 {
     mqdamp = sc;
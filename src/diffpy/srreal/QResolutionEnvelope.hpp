@@ -39,6 +39,7 @@ class QResolutionEnvelope : public PDFEnvelope
         // methods
         virtual const std::string& type() const;
         virtual double operator()(const double& r) const;
+        virtual void apply(const double* r, double* y, size_t n) const;
         void setQdamp(double sc);
         const double& getQdamp() const;
 
@@ -0,0 +1,65 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2013 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class QuantityCache -- storage of results derived from PairQuantity value.
+*
+*****************************************************************************/
+
+#include <diffpy/srreal/QuantityCache.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+//////////////////////////////////////////////////////////////////////////////
+// class QuantityCache
+//////////////////////////////////////////////////////////////////////////////
+
+// Public Methods ------------------------------------------------------------
+
+const QuantityType*
+QuantityCache::find(int key, const eventticker::EventTicker& tic) const
+{
+    if (mticker != tic)  return NULL;
+    std::unordered_map<int, QuantityType>::const_iterator ii;
+    ii = mitems.find(key);
+    const QuantityType* rv = (ii == mitems.end()) ? NULL : &(ii->second);
+    return rv;
+}
+
+
+const QuantityType&
+QuantityCache::store(int key, QuantityType item,
+        const eventticker::EventTicker& tic)
+{
+    if (mticker != tic)
+    {
+        mitems.clear();
+        mticker = tic;
+    }
+    QuantityType& rv = mitems[key];
+    rv.swap(item);
+    return rv;
+}
+
+
+void QuantityCache::clear()
+{
+    mitems.clear();
+    mticker = eventticker::EventTicker();
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
@@ -0,0 +1,62 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2013 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class QuantityCache -- storage of results derived from PairQuantity value.
+*
+* The cached items are valid for a single EventTicker value.  Any item
+* lookup with a different ticker value misses and the next store discards
+* all items that were saved for an older ticker.
+*
+*****************************************************************************/
+
+#ifndef QUANTITYCACHE_HPP_INCLUDED
+#define QUANTITYCACHE_HPP_INCLUDED
+
+#include <unordered_map>
+
+#include <diffpy/EventTicker.hpp>
+#include <diffpy/srreal/QuantityType.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class QuantityCache
+{
+    public:
+
+        // methods
+        /// return pointer to the item cached under key for the ticker
+        /// or NULL when it is not available
+        const QuantityType*
+            find(int key, const eventticker::EventTicker& tic) const;
+        /// save item under key for the ticker and return cached copy.
+        /// Discard all items cached for a different ticker value.
+        const QuantityType&
+            store(int key, QuantityType item,
+                    const eventticker::EventTicker& tic);
+        /// remove all cached items
+        void clear();
+
+    private:
+
+        // data
+        eventticker::EventTicker mticker;
+        std::unordered_map<int, QuantityType> mitems;
+
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // QUANTITYCACHE_HPP_INCLUDED
@@ -20,6 +20,9 @@
 #define R3LINALG_HPP_INCLUDED
 
 #include <algorithm>
+#include <type_traits>
+#include <vector>
+#include <boost/align/aligned_allocator.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
@@ -144,20 +147,71 @@ class Matrix : public ublas::matrix<double,
         }
 };
 
+/// Trivially copyable vector for the inner loops of bond generators.
+/// The storage is padded to 4 elements for 32-byte alignment, use
+/// PODVectorArray for dynamically allocated arrays.
+struct alignas(32) PODVector
+{
+    double data[4];
+
+    double& operator[](int i)  { return data[i]; }
+    constexpr const double& operator[](int i) const  { return data[i]; }
+};
+
+
+/// Trivially copyable 3x3 matrix in row-major order.
+struct alignas(32) PODMatrix
+{
+    double data[9];
+
+    double& operator()(int i, int j)  { return data[3 * i + j]; }
+    constexpr const double& operator()(int i, int j) const
+    {
+        return data[3 * i + j];
+    }
+};
+
+static_assert(std::is_trivially_copyable<PODVector>::value,
+        "PODVector must be trivially copyable");
+static_assert(std::is_trivially_copyable<PODMatrix>::value,
+        "PODMatrix must be trivially copyable");
+
+typedef std::vector<PODVector,
+        boost::alignment::aligned_allocator<PODVector, 32> > PODVectorArray;
+
 // Functions
 
 const Matrix& identity();
 const Matrix& zeromatrix();
 double determinant(const Matrix& A);
-const Matrix& inverse(const Matrix& A);
+Matrix inverse(const Matrix& A);
 
-const Vector& floor(const Vector&);
+Vector floor(const Vector&);
 template <class V> double norm(const V&);
 template <class V> double distance(const V& u, const V& v);
 template <class V> double dot(const V& u, const V& v);
 template <class V> Vector cross(const V& u, const V& v);
-template <class V> const Vector& mxvecproduct(const Matrix&, const V&);
-template <class V> const Vector& mxvecproduct(const V&, const Matrix&);
+template <class V> Vector mxvecproduct(const Matrix&, const V&);
+template <class V> Vector mxvecproduct(const V&, const Matrix&);
+
+// POD arithmetic and conversion from and to the ublas based types
+
+constexpr PODVector podvector(double x, double y, double z);
+constexpr PODVector operator+(const PODVector& u, const PODVector& v);
+constexpr PODVector operator-(const PODVector& u, const PODVector& v);
+constexpr PODVector operator*(const PODVector& u, double a);
+constexpr PODVector operator*(double a, const PODVector& u);
+constexpr double dot(const PODVector& u, const PODVector& v);
+constexpr PODVector mxvecproduct(const PODMatrix&, const PODVector&);
+constexpr PODVector mxvecproduct(const PODVector&, const PODMatrix&);
+/// quadratic form u * M * u
+constexpr double quadform(const PODMatrix& M, const PODVector& u);
+PODVector toPOD(const Vector&);
+PODMatrix toPOD(const Matrix&);
+Vector fromPOD(const PODVector&);
+Matrix fromPOD(const PODMatrix&);
+/// copy POD vector to an existing Vector without temporaries
+void assign(Vector& v, const PODVector& u);
 
 // Equality ------------------------------------------------------------------
 
@@ -199,15 +253,116 @@ size_t hash_value(const Matrix& A);
 // Inlined functions ---------------------------------------------------------
 
 inline
-const Vector& floor(const Vector& v)
+Vector floor(const Vector& v)
 {
-    static Vector res;
+    Vector res;
     Vector::const_iterator xi = v.begin();
     Vector::iterator xo = res.begin();
     for (; xi != v.end(); ++xi, ++xo)  *xo = std::floor(*xi);
     return res;
 }
 
+// POD functions -------------------------------------------------------------
+
+constexpr PODVector podvector(double x, double y, double z)
+{
+    return PODVector{{x, y, z, 0.0}};
+}
+
+
+constexpr PODVector operator+(const PODVector& u, const PODVector& v)
+{
+    return podvector(u[0] + v[0], u[1] + v[1], u[2] + v[2]);
+}
+
+
+constexpr PODVector operator-(const PODVector& u, const PODVector& v)
+{
+    return podvector(u[0] - v[0], u[1] - v[1], u[2] - v[2]);
+}
+
+
+constexpr PODVector operator*(const PODVector& u, double a)
+{
+    return podvector(u[0] * a, u[1] * a, u[2] * a);
+}
+
+
+constexpr PODVector operator*(double a, const PODVector& u)
+{
+    return u * a;
+}
+
+
+constexpr double dot(const PODVector& u, const PODVector& v)
+{
+    return u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+}
+
+
+constexpr PODVector mxvecproduct(const PODMatrix& M, const PODVector& u)
+{
+    return podvector(
+            M(0,0) * u[0] + M(0,1) * u[1] + M(0,2) * u[2],
+            M(1,0) * u[0] + M(1,1) * u[1] + M(1,2) * u[2],
+            M(2,0) * u[0] + M(2,1) * u[1] + M(2,2) * u[2]);
+}
+
+
+constexpr PODVector mxvecproduct(const PODVector& u, const PODMatrix& M)
+{
+    return podvector(
+            u[0] * M(0,0) + u[1] * M(1,0) + u[2] * M(2,0),
+            u[0] * M(0,1) + u[1] * M(1,1) + u[2] * M(2,1),
+            u[0] * M(0,2) + u[1] * M(1,2) + u[2] * M(2,2));
+}
+
+
+constexpr double quadform(const PODMatrix& M, const PODVector& u)
+{
+    return dot(u, mxvecproduct(M, u));
+}
+
+
+inline
+PODVector toPOD(const Vector& v)
+{
+    return podvector(v[0], v[1], v[2]);
+}
+
+
+inline
+PODMatrix toPOD(const Matrix& M)
+{
+    PODMatrix rv;
+    std::copy(M.data().begin(), M.data().end(), rv.data);
+    return rv;
+}
+
+
+inline
+Vector fromPOD(const PODVector& u)
+{
+    return Vector(u[0], u[1], u[2]);
+}
+
+
+inline
+Matrix fromPOD(const PODMatrix& M)
+{
+    const double* x = M.data;
+    return Matrix(x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7], x[8]);
+}
+
+
+inline
+void assign(Vector& v, const PODVector& u)
+{
+    v[0] = u[0];
+    v[1] = u[1];
+    v[2] = u[2];
+}
+
 // Template functions --------------------------------------------------------
 
 template <class V>
@@ -220,10 +375,7 @@ double norm(const V& u)
 template <class V>
 double distance(const V& u, const V& v)
 {
-    static R3::Vector duv;
-    duv[0] = u[0] - v[0];
-    duv[1] = u[1] - v[1];
-    duv[2] = u[2] - v[2];
+    R3::Vector duv(u[0] - v[0], u[1] - v[1], u[2] - v[2]);
     return R3::norm(duv);
 }
 
@@ -247,9 +399,9 @@ Vector cross(const V& u, const V& v)
 
 
 template <class V>
-const Vector& mxvecproduct(const Matrix& M, const V& u)
+Vector mxvecproduct(const Matrix& M, const V& u)
 {
-    static Vector res;
+    Vector res;
     res[0] = M(0,0)*u[0] + M(0,1)*u[1] + M(0,2)*u[2];
     res[1] = M(1,0)*u[0] + M(1,1)*u[1] + M(1,2)*u[2];
     res[2] = M(2,0)*u[0] + M(2,1)*u[1] + M(2,2)*u[2];
@@ -258,9 +410,9 @@ const Vector& mxvecproduct(const Matrix& M, const V& u)
 
 
 template <class V>
-const Vector& mxvecproduct(const V& u, const Matrix& M)
+Vector mxvecproduct(const V& u, const Matrix& M)
 {
-    static Vector res;
+    Vector res;
     res[0] = u[0]*M(0,0) + u[1]*M(1,0) + u[2]*M(2,0);
     res[1] = u[0]*M(0,1) + u[1]*M(1,1) + u[2]*M(2,1);
     res[2] = u[0]*M(0,2) + u[1]*M(1,2) + u[2]*M(2,2);
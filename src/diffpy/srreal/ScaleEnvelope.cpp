@@ -62,6 +62,14 @@ double ScaleEnvelope::operator()(const double& r) const
 }
 
 
+void ScaleEnvelope::apply(const double* r, double* y, size_t n) const
+{
+    const double sc = this->getScale();
+    if (sc == 1.0)  return;
+    for (size_t i = 0; i < n; ++i)  y[i] *= sc;
+}
+
+
 void ScaleEnvelope::setScale(double sc)
 {
     mscale = sc;
@@ -39,6 +39,7 @@ class ScaleEnvelope : public PDFEnvelope
         // methods
         const std::string& type() const;
         double operator()(const double& r) const;
+        void apply(const double* r, double* y, size_t n) const;
         void setScale(double sc);
         const double& getScale() const;
 
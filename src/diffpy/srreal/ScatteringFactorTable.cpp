@@ -23,6 +23,7 @@
 
 using namespace std;
 using diffpy::validators::ensureNonNull;
+using diffpy::validators::ensureNonNegative;
 
 namespace diffpy {
 
@@ -31,6 +32,15 @@ template class HasClassRegistry<srreal::ScatteringFactorTable>;
 
 namespace srreal {
 
+// Local Constants -----------------------------------------------------------
+
+namespace {
+
+/// limit on the number of arrays cached by lookupGrid
+const size_t MAX_CACHED_GRIDS = 64;
+
+}   // namespace
+
 // class ScatteringFactorTable -----------------------------------------------
 
 // public methods
@@ -62,6 +72,39 @@ double ScatteringFactorTable::lookup(const string& smbl, double q) const
 }
 
 
+QuantityType ScatteringFactorTable::lookupGrid(const string& smbl,
+        double qmin, double qstep, int n) const
+{
+    ensureNonNegative("n", n);
+    const GridKey key(smbl, qmin, qstep, n);
+    const eventticker::EventTicker tc = this->ticker();
+    {
+        lock_guard<mutex> lock(mgridcache.mutex);
+        if (mgridcache.ticker != tc)
+        {
+            mgridcache.arrays.clear();
+            mgridcache.ticker = tc;
+        }
+        map<GridKey, QuantityType>::const_iterator ii;
+        ii = mgridcache.arrays.find(key);
+        if (ii != mgridcache.arrays.end())  return ii->second;
+    }
+    // evaluate outside of the lock, lookup may throw for invalid symbol
+    QuantityType rv(n);
+    for (int i = 0; i < n; ++i)  rv[i] = this->lookup(smbl, qmin + i * qstep);
+    lock_guard<mutex> lock(mgridcache.mutex);
+    if (mgridcache.ticker == tc)
+    {
+        if (mgridcache.arrays.size() >= MAX_CACHED_GRIDS)
+        {
+            mgridcache.arrays.clear();
+        }
+        mgridcache.arrays[key] = rv;
+    }
+    return rv;
+}
+
+
 void ScatteringFactorTable::setCustomAs(
         const string& smbl, const string& srcsmbl)
 {
@@ -146,7 +189,7 @@ ScatteringFactorTableOwner::getScatteringFactorTable() const
 
 const string& ScatteringFactorTableOwner::getRadiationType() const
 {
-    static string empty;
+    static const string empty;
     const string& tp = msftable.get() ? msftable->radiationType() : empty;
     return tp;
 }
@@ -22,6 +22,9 @@
 #ifndef SCATTERINGFACTORTABLE_HPP_INCLUDED
 #define SCATTERINGFACTORTABLE_HPP_INCLUDED
 
+#include <map>
+#include <mutex>
+#include <tuple>
 #include <unordered_set>
 
 #include <boost/serialization/base_object.hpp>
@@ -32,6 +35,7 @@
 
 #include <diffpy/HasClassRegistry.hpp>
 #include <diffpy/EventTicker.hpp>
+#include <diffpy/srreal/QuantityType.hpp>
 
 namespace diffpy {
 namespace srreal {
@@ -47,6 +51,10 @@ class ScatteringFactorTable :
         // own methods
         virtual const std::string& radiationType() const = 0;
         double lookup(const std::string& smbl, double q=0.0) const;
+        /// scattering factors at q = qmin + i * qstep for i in [0, n).
+        /// The arrays are cached until the table changes.
+        QuantityType lookupGrid(const std::string& smbl,
+                double qmin, double qstep, int n) const;
         virtual double standardLookup(const std::string&, double) const = 0;
         void setCustomAs(const std::string& smbl, const std::string& srcsmbl);
         void setCustomAs(const std::string& smbl, const std::string& srcsmbl,
@@ -67,6 +75,25 @@ class ScatteringFactorTable :
 
     private:
 
+        // types
+        typedef std::tuple<std::string, double, double, int> GridKey;
+
+        /// thread-safe storage of the lookupGrid results, which starts
+        /// empty for copied tables
+        struct GridCache
+        {
+            GridCache()  { }
+            GridCache(const GridCache&)  { }
+            GridCache& operator=(const GridCache&)  { return *this; }
+
+            std::mutex mutex;
+            eventticker::EventTicker ticker;
+            std::map<GridKey, QuantityType> arrays;
+        };
+
+        // data
+        mutable GridCache mgridcache;
+
         // serialization
         friend class boost::serialization::access;
         template<class Archive>
@@ -0,0 +1,139 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class SharedMemorySegment -- named POSIX shared memory mapped to the
+*     process address space
+*
+*****************************************************************************/
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <diffpy/srreal/SharedMemorySegment.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+string segmentName(const string& name)
+{
+    string rv = (!name.empty() && name[0] == '/') ? name : ('/' + name);
+    if (rv.size() < 2 || rv.find('/', 1) != string::npos)
+    {
+        string emsg = "Invalid shared memory segment name '" + name + "'.";
+        throw invalid_argument(emsg);
+    }
+    return rv;
+}
+
+
+void throwSegmentError(const string& what, const string& name)
+{
+    string emsg = what + " '" + name + "': " + strerror(errno);
+    throw runtime_error(emsg);
+}
+
+}   // namespace
+
+// Factories -----------------------------------------------------------------
+
+SharedMemorySegmentPtr
+SharedMemorySegment::create(const string& name, size_t nbytes)
+{
+    SharedMemorySegmentPtr rv(new SharedMemorySegment);
+    rv->mname = segmentName(name);
+    const char* nm = rv->mname.c_str();
+    int fd = shm_open(nm, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0)  throwSegmentError("Cannot create shared memory", nm);
+    if (ftruncate(fd, nbytes) < 0)
+    {
+        int errsave = errno;
+        close(fd);
+        shm_unlink(nm);
+        errno = errsave;
+        throwSegmentError("Cannot resize shared memory", nm);
+    }
+    void* addr = nbytes ?
+        mmap(NULL, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : NULL;
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        shm_unlink(nm);
+        throwSegmentError("Cannot map shared memory", nm);
+    }
+    rv->maddress = addr;
+    rv->msize = nbytes;
+    return rv;
+}
+
+
+SharedMemorySegmentPtr SharedMemorySegment::open(const string& name)
+{
+    SharedMemorySegmentPtr rv(new SharedMemorySegment);
+    rv->mname = segmentName(name);
+    const char* nm = rv->mname.c_str();
+    int fd = shm_open(nm, O_RDONLY, 0);
+    if (fd < 0)  throwSegmentError("Cannot open shared memory", nm);
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        close(fd);
+        throwSegmentError("Cannot access shared memory", nm);
+    }
+    const size_t nbytes = st.st_size;
+    void* addr = nbytes ?
+        mmap(NULL, nbytes, PROT_READ, MAP_SHARED, fd, 0) : NULL;
+    close(fd);
+    if (addr == MAP_FAILED)  throwSegmentError("Cannot map shared memory", nm);
+    rv->maddress = addr;
+    rv->msize = nbytes;
+    return rv;
+}
+
+// Constructors --------------------------------------------------------------
+
+SharedMemorySegment::SharedMemorySegment() :
+    maddress(NULL), msize(0)
+{ }
+
+
+SharedMemorySegment::~SharedMemorySegment()
+{
+    if (maddress)  munmap(maddress, msize);
+}
+
+// Public Methods ------------------------------------------------------------
+
+void SharedMemorySegment::unlink()
+{
+    if (shm_unlink(mname.c_str()) < 0)
+    {
+        throwSegmentError("Cannot remove shared memory", mname);
+    }
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
@@ -0,0 +1,77 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class SharedMemorySegment -- named POSIX shared memory mapped to the
+*     process address space
+*
+*****************************************************************************/
+
+// The segment stays in the system after it is unmapped until it is removed
+// with unlink.  This lets a worker process write its partial result and
+// exit before the parent process merges it.
+
+#ifndef SHAREDMEMORYSEGMENT_HPP_INCLUDED
+#define SHAREDMEMORYSEGMENT_HPP_INCLUDED
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class SharedMemorySegment;
+typedef boost::shared_ptr<SharedMemorySegment> SharedMemorySegmentPtr;
+
+class SharedMemorySegment
+{
+    public:
+
+        // factories
+        /// create new writable segment, throw when the name already exists
+        static SharedMemorySegmentPtr
+            create(const std::string& name, size_t nbytes);
+        /// map existing segment for reading
+        static SharedMemorySegmentPtr open(const std::string& name);
+
+        // destructor
+        ~SharedMemorySegment();
+
+        // methods
+        /// segment name with the leading slash required by shm_open
+        const std::string& name() const  { return mname; }
+        void* data()  { return maddress; }
+        const void* data() const  { return maddress; }
+        size_t size() const  { return msize; }
+        /// remove the name from the system, the mapping remains valid
+        void unlink();
+
+    private:
+
+        // constructor
+        SharedMemorySegment();
+
+        // data
+        std::string mname;
+        void* maddress;
+        size_t msize;
+
+        // non-copyable
+        SharedMemorySegment(const SharedMemorySegment&);
+        SharedMemorySegment& operator=(const SharedMemorySegment&);
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // SHAREDMEMORYSEGMENT_HPP_INCLUDED
@@ -69,6 +69,19 @@ double SphericalShapeEnvelope::operator()(const double& r) const
 }
 
 
+void SphericalShapeEnvelope::apply(const double* r, double* y, size_t n) const
+{
+    if (mspdiameter <= 0.0)  return;
+    const double invd = 1.0 / mspdiameter;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double rd = r[i] * invd;
+        const double sc = 1.0 - 1.5 * rd + 0.5 * rd * rd * rd;
+        y[i] = (r[i] > mspdiameter) ? 0.0 : (y[i] * sc);
+    }
+}
+
+
 void SphericalShapeEnvelope::setSPDiameter(double spd)
 {
     mspdiameter = spd;
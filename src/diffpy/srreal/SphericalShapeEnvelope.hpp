@@ -41,6 +41,7 @@ class SphericalShapeEnvelope : public PDFEnvelope
         // methods
         virtual const std::string& type() const;
         virtual double operator()(const double& r) const;
+        virtual void apply(const double* r, double* y, size_t n) const;
         void setSPDiameter(double spd);
         const double& getSPDiameter() const;
 
@@ -63,6 +63,16 @@ double StepCutEnvelope::operator()(const double& r) const
 }
 
 
+void StepCutEnvelope::apply(const double* r, double* y, size_t n) const
+{
+    if (mstepcut <= 0.0)  return;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (r[i] > mstepcut)  y[i] = 0.0;
+    }
+}
+
+
 void StepCutEnvelope::setStepCut(double sc)
 {
     mstepcut = sc;
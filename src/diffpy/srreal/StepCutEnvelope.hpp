@@ -41,6 +41,7 @@ class StepCutEnvelope : public PDFEnvelope
 
         virtual const std::string& type() const;
         virtual double operator()(const double& r) const;
+        virtual void apply(const double* r, double* y, size_t n) const;
         void setStepCut(double sc);
         const double& getStepCut() const;
 
@@ -89,14 +89,8 @@ double meanSquareDisplacement(const R3::Matrix& Uijcartn,
         assert(eps_eq(Uijcartn(0,1), Uijcartn(1,0)));
         assert(eps_eq(Uijcartn(0,2), Uijcartn(2,0)));
         assert(eps_eq(Uijcartn(1,2), Uijcartn(2,1)));
-        static R3::Vector sn;
-        sn = s / R3::norm(s);
-        rv = Uijcartn(0,0) * sn(0) * sn(0) +
-             Uijcartn(1,1) * sn(1) * sn(1) +
-             Uijcartn(2,2) * sn(2) * sn(2) +
-             2 * Uijcartn(0,1) * sn(0) * sn(1) +
-             2 * Uijcartn(0,2) * sn(0) * sn(2) +
-             2 * Uijcartn(1,2) * sn(1) * sn(2);
+        const R3::PODVector sp = R3::toPOD(s);
+        rv = R3::quadform(R3::toPOD(Uijcartn), sp) / R3::dot(sp, sp);
     }
     else
     {
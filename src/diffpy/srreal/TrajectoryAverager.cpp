@@ -0,0 +1,252 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TrajectoryAverager -- running mean and variance of PairQuantity
+*     results over the frames of a trajectory
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+#include <diffpy/srreal/TrajectoryAverager.hpp>
+#include <diffpy/serialization.hpp>
+#include <diffpy/validators.hpp>
+
+using namespace std;
+using namespace diffpy::validators;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// Welford accumulator of the mean and the sum of squared deviations
+struct RunningStatistics
+{
+    int count;
+    QuantityType mean;
+    QuantityType sumsq;
+
+    RunningStatistics() : count(0)  { }
+
+    void add(const QuantityType& x)
+    {
+        if (!count)  mean.assign(x.size(), 0.0);
+        if (!count)  sumsq.assign(x.size(), 0.0);
+        if (x.size() != mean.size())
+        {
+            const char* emsg = "Frame results must have the same size.";
+            throw invalid_argument(emsg);
+        }
+        ++count;
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            const double dx = x[i] - mean[i];
+            mean[i] += dx / count;
+            sumsq[i] += dx * (x[i] - mean[i]);
+        }
+    }
+
+
+    /// merge statistics of the following frames
+    void combine(const RunningStatistics& other)
+    {
+        if (!other.count)  return;
+        if (!count)
+        {
+            *this = other;
+            return;
+        }
+        if (other.mean.size() != mean.size())
+        {
+            const char* emsg = "Frame results must have the same size.";
+            throw invalid_argument(emsg);
+        }
+        const int n = count + other.count;
+        const double wother = double(other.count) / n;
+        const double wsq = double(count) * other.count / n;
+        for (size_t i = 0; i < mean.size(); ++i)
+        {
+            const double dm = other.mean[i] - mean[i];
+            mean[i] += dm * wother;
+            sumsq[i] += other.sumsq[i] + dm * dm * wsq;
+        }
+        count = n;
+    }
+};
+
+
+void evalFrameBlock(boost::shared_ptr<PairQuantity> pq,
+        TrajectoryStructureAdapterPtr traj,
+        vector<int>::const_iterator first, vector<int>::const_iterator last,
+        const TrajectoryAverager::ResultFunction& result,
+        RunningStatistics& stats, exception_ptr& error)
+{
+    try {
+        for (; first != last; ++first)
+        {
+            traj->setFrame(*first);
+            pq->eval(traj);
+            stats.add(result(*pq));
+        }
+    }
+    catch (...) {
+        error = current_exception();
+    }
+}
+
+
+QuantityType pqValue(const PairQuantity& pq)
+{
+    return pq.value();
+}
+
+}   // namespace
+
+// Constructor ---------------------------------------------------------------
+
+TrajectoryAverager::TrajectoryAverager() :
+    mfirst(0), mlast(-1), mstride(1), mblocks(1), mcount(0)
+{ }
+
+// Public Methods ------------------------------------------------------------
+
+void TrajectoryAverager::eval(
+        PairQuantity& pq, const TrajectoryStructureAdapter& traj)
+{
+    this->eval(pq, traj, pqValue);
+}
+
+
+void TrajectoryAverager::eval(PairQuantity& pq,
+        const TrajectoryStructureAdapter& traj, ResultFunction result)
+{
+    const int nframes = traj.countFrames();
+    const int last = (mlast < 0) ? nframes : min(mlast, nframes);
+    vector<int> frames;
+    for (int f = mfirst; f < last; f += mstride)  frames.push_back(f);
+    const int nblocks = max(1, min(mblocks, int(frames.size())));
+    // every block gets its own copy of the calculator and of the adapter.
+    // Copies are created here as deserialization is not thread safe.
+    boost::shared_ptr<PairQuantity> ppq(&pq, [](PairQuantity*) { });
+    const string pqdata = serialization_tostring(ppq);
+    vector< boost::shared_ptr<PairQuantity> > pqblocks(nblocks);
+    vector<TrajectoryStructureAdapterPtr> trajblocks(nblocks);
+    for (int k = 0; k < nblocks; ++k)
+    {
+        serialization_fromstring(pqblocks[k], pqdata);
+        trajblocks[k] = boost::static_pointer_cast<
+            TrajectoryStructureAdapter>(traj.clone());
+    }
+    vector<RunningStatistics> stats(nblocks);
+    vector<exception_ptr> errors(nblocks);
+    vector<thread> threads;
+    for (int k = 0; k < nblocks; ++k)
+    {
+        vector<int>::const_iterator fb, fe;
+        fb = frames.begin() + (frames.size() * k) / nblocks;
+        fe = frames.begin() + (frames.size() * (k + 1)) / nblocks;
+        threads.push_back(thread(evalFrameBlock, pqblocks[k], trajblocks[k],
+                    fb, fe, cref(result), ref(stats[k]), ref(errors[k])));
+    }
+    for (thread& t : threads)  t.join();
+    for (const exception_ptr& e : errors)
+    {
+        if (e)  rethrow_exception(e);
+    }
+    RunningStatistics total;
+    for (const RunningStatistics& s : stats)  total.combine(s);
+    mcount = total.count;
+    mmean.swap(total.mean);
+    msumsq.swap(total.sumsq);
+}
+
+
+int TrajectoryAverager::countFrames() const
+{
+    return mcount;
+}
+
+
+const QuantityType& TrajectoryAverager::mean() const
+{
+    return mmean;
+}
+
+
+QuantityType TrajectoryAverager::variance() const
+{
+    QuantityType rv = msumsq;
+    if (mcount)
+    {
+        for (double& v : rv)  v /= mcount;
+    }
+    return rv;
+}
+
+// configuration
+
+void TrajectoryAverager::setFrameRange(int first, int last)
+{
+    ensureNonNegative("first", first);
+    mfirst = first;
+    mlast = last;
+}
+
+
+const int& TrajectoryAverager::getFirstFrame() const
+{
+    return mfirst;
+}
+
+
+const int& TrajectoryAverager::getLastFrame() const
+{
+    return mlast;
+}
+
+
+void TrajectoryAverager::setStride(int stride)
+{
+    ensureEpsilonPositive("stride", stride);
+    mstride = stride;
+}
+
+
+const int& TrajectoryAverager::getStride() const
+{
+    return mstride;
+}
+
+
+void TrajectoryAverager::setBlocks(int nblocks)
+{
+    ensureEpsilonPositive("blocks", nblocks);
+    mblocks = nblocks;
+}
+
+
+const int& TrajectoryAverager::getBlocks() const
+{
+    return mblocks;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
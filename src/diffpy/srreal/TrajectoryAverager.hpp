@@ -0,0 +1,87 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TrajectoryAverager -- running mean and variance of PairQuantity
+*     results over the frames of a trajectory
+*
+*****************************************************************************/
+
+// Frames are split into contiguous blocks evaluated in parallel threads,
+// each with its own copy of the PairQuantity.  Consecutive frames within
+// a block are fast updates when the calculator uses the OPTIMIZED
+// evaluator.  Block statistics are accumulated in one pass and combined
+// in the block order, so the results do not depend on the scheduling.
+
+#ifndef TRAJECTORYAVERAGER_HPP_INCLUDED
+#define TRAJECTORYAVERAGER_HPP_INCLUDED
+
+#include <functional>
+
+#include <diffpy/srreal/PairQuantity.hpp>
+#include <diffpy/srreal/TrajectoryStructureAdapter.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class TrajectoryAverager
+{
+    public:
+
+        // types
+        /// extract the averaged array from an evaluated PairQuantity
+        typedef std::function<QuantityType(const PairQuantity&)>
+            ResultFunction;
+
+        // constructor
+        TrajectoryAverager();
+
+        // methods
+        /// average pq value over the selected frames of the trajectory
+        void eval(PairQuantity& pq, const TrajectoryStructureAdapter& traj);
+        /// average arrays obtained with the result function
+        void eval(PairQuantity& pq, const TrajectoryStructureAdapter& traj,
+                ResultFunction result);
+        /// number of frames in the last average
+        int countFrames() const;
+        const QuantityType& mean() const;
+        /// variance of the frame results normalized by the frame count
+        QuantityType variance() const;
+
+        // configuration
+        /// range of frames from first to before last, all when last < 0
+        void setFrameRange(int first, int last);
+        const int& getFirstFrame() const;
+        const int& getLastFrame() const;
+        void setStride(int stride);
+        const int& getStride() const;
+        /// number of frame blocks evaluated in parallel threads
+        void setBlocks(int nblocks);
+        const int& getBlocks() const;
+
+    private:
+
+        // data
+        int mfirst;
+        int mlast;
+        int mstride;
+        int mblocks;
+        int mcount;
+        QuantityType mmean;
+        QuantityType msumsq;
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // TRAJECTORYAVERAGER_HPP_INCLUDED
@@ -0,0 +1,352 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TrajectoryFile -- read-only memory map of a binary trajectory with
+*     Cartesian coordinates of a fixed list of atoms
+*
+* class TrajectoryStructureAdapter -- adapter for one frame of a trajectory
+*     of a non-periodic structure
+*
+*****************************************************************************/
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <diffpy/srreal/TrajectoryStructureAdapter.hpp>
+#include <diffpy/srreal/StructureDifference.hpp>
+#include <diffpy/serialization.ipp>
+#include <diffpy/validators.hpp>
+
+using namespace std;
+using namespace diffpy::validators;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+const char TRAJECTORY_TAG[] = "DPYTRAJ1";
+const size_t TRAJECTORY_TAG_SIZE = 8;
+const size_t TRAJECTORY_HEADER_SIZE =
+    TRAJECTORY_TAG_SIZE + 2 * sizeof(uint64_t);
+
+
+void throwTrajectoryError(const string& what, const string& filename)
+{
+    string emsg = what + " '" + filename + "'.";
+    throw runtime_error(emsg);
+}
+
+
+bool samePosition(const R3::Vector& v0, const R3::Vector& v1)
+{
+    return v0[0] == v1[0] && v0[1] == v1[1] && v0[2] == v1[2];
+}
+
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// class TrajectoryFile
+//////////////////////////////////////////////////////////////////////////////
+
+// Constructor ---------------------------------------------------------------
+
+TrajectoryFile::TrajectoryFile(const string& filename) :
+    mfilename(filename), mnatoms(0), mnframes(0),
+    maddress(NULL), msize(0)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throwTrajectoryError(string("Cannot open trajectory file") +
+                " (" + strerror(errno) + ")", filename);
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || size_t(st.st_size) < TRAJECTORY_HEADER_SIZE)
+    {
+        close(fd);
+        throwTrajectoryError("Invalid trajectory file", filename);
+    }
+    msize = st.st_size;
+    maddress = mmap(NULL, msize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (maddress == MAP_FAILED)
+    {
+        maddress = NULL;
+        throwTrajectoryError("Cannot map trajectory file", filename);
+    }
+    const char* header = static_cast<const char*>(maddress);
+    uint64_t counts[2];
+    memcpy(counts, header + TRAJECTORY_TAG_SIZE, sizeof(counts));
+    // counts must fit in int and match the data size without overflow
+    bool valid = !memcmp(header, TRAJECTORY_TAG, TRAJECTORY_TAG_SIZE) &&
+        counts[0] <= uint64_t(INT_MAX) && counts[1] <= uint64_t(INT_MAX);
+    const uint64_t datasize = msize - TRAJECTORY_HEADER_SIZE;
+    const uint64_t framesize = 3 * sizeof(double) * counts[0];
+    if (valid && framesize)
+    {
+        valid = (counts[1] <= datasize / framesize) &&
+            (datasize == framesize * counts[1]);
+    }
+    else if (valid)
+    {
+        valid = (counts[1] == 0 && datasize == 0);
+    }
+    if (!valid)
+    {
+        munmap(maddress, msize);
+        maddress = NULL;
+        throwTrajectoryError("Invalid trajectory file", filename);
+    }
+    mnatoms = counts[0];
+    mnframes = counts[1];
+}
+
+
+TrajectoryFile::~TrajectoryFile()
+{
+    if (maddress)  munmap(maddress, msize);
+}
+
+// Public Methods ------------------------------------------------------------
+
+void TrajectoryFile::create(const string& filename,
+        int natoms, const vector<double>& xyz)
+{
+    ensureNonNegative("natoms", natoms);
+    const size_t framelength = 3 * size_t(natoms);
+    if (framelength ? (xyz.size() % framelength) : !xyz.empty())
+    {
+        const char* emsg = "Coordinates do not fill whole frames.";
+        throw invalid_argument(emsg);
+    }
+    uint64_t counts[2];
+    counts[0] = natoms;
+    counts[1] = framelength ? (xyz.size() / framelength) : 0;
+    ofstream fp(filename.c_str(), ios::binary);
+    fp.write(TRAJECTORY_TAG, TRAJECTORY_TAG_SIZE);
+    fp.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+    if (!xyz.empty())
+    {
+        fp.write(reinterpret_cast<const char*>(&xyz[0]),
+                xyz.size() * sizeof(double));
+    }
+    fp.close();
+    if (!fp)  throwTrajectoryError("Cannot write trajectory file", filename);
+}
+
+
+const double* TrajectoryFile::frameData(int idx) const
+{
+    if (idx < 0 || idx >= mnframes)
+    {
+        throw out_of_range("Trajectory frame index out of range.");
+    }
+    const char* frames =
+        static_cast<const char*>(maddress) + TRAJECTORY_HEADER_SIZE;
+    const double* rv = reinterpret_cast<const double*>(frames);
+    return rv + 3 * size_t(mnatoms) * idx;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// class TrajectoryStructureAdapter
+//////////////////////////////////////////////////////////////////////////////
+
+// Constructors --------------------------------------------------------------
+
+TrajectoryStructureAdapter::TrajectoryStructureAdapter() :
+    matoms(new AtomicStructureAdapter),
+    mframe(0),
+    mpositions(new PositionsStorage)
+{ }
+
+
+TrajectoryStructureAdapter::TrajectoryStructureAdapter(
+        TrajectoryFilePtr trajectory, AtomicStructureAdapterPtr atoms) :
+    mtrajectory(trajectory),
+    mframe(0)
+{
+    ensureNonNull("trajectory", mtrajectory);
+    ensureNonNull("atoms", atoms);
+    // private copy so that diff can compare templates by their address
+    matoms = boost::static_pointer_cast<AtomicStructureAdapter>(
+            atoms->clone());
+    if (matoms->countSites() != mtrajectory->countAtoms())
+    {
+        const char* emsg = "Atoms do not match the trajectory file.";
+        throw invalid_argument(emsg);
+    }
+    if (mtrajectory->countFrames())  this->setFrame(0);
+    else
+    {
+        mpositions.reset(new PositionsStorage(matoms->countSites()));
+        for (int i = 0; i < matoms->countSites(); ++i)
+        {
+            (*mpositions)[i] = matoms->at(i).xyz_cartn;
+        }
+    }
+}
+
+// Public Methods ------------------------------------------------------------
+
+StructureAdapterPtr TrajectoryStructureAdapter::clone() const
+{
+    // clones share the positions, setFrame allocates new storage
+    StructureAdapterPtr rv(new TrajectoryStructureAdapter(*this));
+    return rv;
+}
+
+
+BaseBondGeneratorPtr TrajectoryStructureAdapter::createBondGenerator() const
+{
+    BaseBondGeneratorPtr bnds(new BaseBondGenerator(shared_from_this()));
+    return bnds;
+}
+
+
+int TrajectoryStructureAdapter::countSites() const
+{
+    return mpositions->size();
+}
+
+
+double TrajectoryStructureAdapter::numberDensity() const
+{
+    return matoms->numberDensity();
+}
+
+
+const string& TrajectoryStructureAdapter::siteAtomType(int idx) const
+{
+    return matoms->siteAtomType(idx);
+}
+
+
+const R3::Vector&
+TrajectoryStructureAdapter::siteCartesianPosition(int idx) const
+{
+    assert(0 <= idx && idx < this->countSites());
+    return (*mpositions)[idx];
+}
+
+
+int TrajectoryStructureAdapter::siteMultiplicity(int idx) const
+{
+    return matoms->siteMultiplicity(idx);
+}
+
+
+double TrajectoryStructureAdapter::siteOccupancy(int idx) const
+{
+    return matoms->siteOccupancy(idx);
+}
+
+
+bool TrajectoryStructureAdapter::siteAnisotropy(int idx) const
+{
+    return matoms->siteAnisotropy(idx);
+}
+
+
+const R3::Matrix& TrajectoryStructureAdapter::siteCartesianUij(int idx) const
+{
+    return matoms->siteCartesianUij(idx);
+}
+
+
+StructureDifference
+TrajectoryStructureAdapter::diff(StructureAdapterConstPtr other) const
+{
+    StructureDifference sd = this->StructureAdapter::diff(other);
+    if (sd.stru0 == sd.stru1)  return sd;
+    typedef boost::shared_ptr<const TrajectoryStructureAdapter> TPtr;
+    TPtr pother = boost::dynamic_pointer_cast<TPtr::element_type>(other);
+    if (!pother || pother->matoms != matoms)  return sd;
+    // frames of the same atoms differ only in the moved sites
+    sd.diffmethod = StructureDifference::Method::SIDEBYSIDE;
+    sd.pop0.clear();
+    sd.add1.clear();
+    if (pother->mpositions == mpositions)  return sd;
+    const PositionsStorage& xyz0 = *mpositions;
+    const PositionsStorage& xyz1 = *(pother->mpositions);
+    assert(xyz0.size() == xyz1.size());
+    for (size_t i = 0; i < xyz0.size(); ++i)
+    {
+        if (samePosition(xyz0[i], xyz1[i]))  continue;
+        sd.pop0.push_back(i);
+        sd.add1.push_back(i);
+    }
+    return sd;
+}
+
+
+void TrajectoryStructureAdapter::setFrame(int idx)
+{
+    if (!mtrajectory)
+    {
+        const char* emsg = "Trajectory file is not available.";
+        throw logic_error(emsg);
+    }
+    const double* xyz = mtrajectory->frameData(idx);
+    // keep positions that are shared with the clones
+    if (!mpositions || !mpositions.unique())
+    {
+        mpositions.reset(new PositionsStorage(mtrajectory->countAtoms()));
+    }
+    PositionsStorage::iterator pi = mpositions->begin();
+    for (; pi != mpositions->end(); ++pi, xyz += 3)
+    {
+        (*pi)[0] = xyz[0];
+        (*pi)[1] = xyz[1];
+        (*pi)[2] = xyz[2];
+    }
+    mframe = idx;
+}
+
+
+int TrajectoryStructureAdapter::getFrame() const
+{
+    return mframe;
+}
+
+
+int TrajectoryStructureAdapter::countFrames() const
+{
+    return mtrajectory ? mtrajectory->countFrames() : 0;
+}
+
+
+const TrajectoryFilePtr& TrajectoryStructureAdapter::getTrajectory() const
+{
+    return mtrajectory;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+DIFFPY_INSTANTIATE_SERIALIZATION(diffpy::srreal::TrajectoryStructureAdapter)
+BOOST_CLASS_EXPORT_IMPLEMENT(diffpy::srreal::TrajectoryStructureAdapter)
+
+// End of file
@@ -0,0 +1,144 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TrajectoryFile -- read-only memory map of a binary trajectory with
+*     Cartesian coordinates of a fixed list of atoms
+*
+* class TrajectoryStructureAdapter -- adapter for one frame of a trajectory
+*     of a non-periodic structure
+*
+*****************************************************************************/
+
+// Trajectory file starts with the 8-byte tag "DPYTRAJ1" followed by
+// 64-bit counts of atoms and frames.  The frames follow as arrays of
+// x, y, z Cartesian coordinates per atom.  All numbers are stored in
+// the native byte order.
+//
+// Atom types, occupancies and displacement parameters are taken from
+// a copy of the template AtomicStructureAdapter, later changes of the
+// template have no effect on the adapter.  The adapter clones are cheap
+// as they share the template copy and the coordinates of the current
+// frame.  Consecutive frames are compared side by side so
+// PQEvaluatorOptimized only updates the moved atoms.
+
+#ifndef TRAJECTORYSTRUCTUREADAPTER_HPP_INCLUDED
+#define TRAJECTORYSTRUCTUREADAPTER_HPP_INCLUDED
+
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <diffpy/srreal/AtomicStructureAdapter.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class TrajectoryFile
+{
+    public:
+
+        // constructor
+        explicit TrajectoryFile(const std::string& filename);
+        ~TrajectoryFile();
+
+        // methods
+        /// write new trajectory file, xyz holds coordinates of all frames
+        static void create(const std::string& filename,
+                int natoms, const std::vector<double>& xyz);
+        const std::string& filename() const  { return mfilename; }
+        int countAtoms() const  { return mnatoms; }
+        int countFrames() const  { return mnframes; }
+        /// coordinates of all atoms in frame idx
+        const double* frameData(int idx) const;
+
+    private:
+
+        // data
+        std::string mfilename;
+        int mnatoms;
+        int mnframes;
+        void* maddress;
+        size_t msize;
+
+        // non-copyable
+        TrajectoryFile(const TrajectoryFile&);
+        TrajectoryFile& operator=(const TrajectoryFile&);
+};
+
+typedef boost::shared_ptr<const TrajectoryFile> TrajectoryFilePtr;
+
+
+class TrajectoryStructureAdapter : public StructureAdapter
+{
+    public:
+
+        // constructors
+        TrajectoryStructureAdapter();
+        TrajectoryStructureAdapter(TrajectoryFilePtr trajectory,
+                AtomicStructureAdapterPtr atoms);
+
+        // methods - overloaded
+        virtual StructureAdapterPtr clone() const;
+        virtual BaseBondGeneratorPtr createBondGenerator() const;
+        virtual int countSites() const;
+        virtual double numberDensity() const;
+        virtual const std::string& siteAtomType(int idx) const;
+        virtual const R3::Vector& siteCartesianPosition(int idx) const;
+        virtual int siteMultiplicity(int idx) const;
+        virtual double siteOccupancy(int idx) const;
+        virtual bool siteAnisotropy(int idx) const;
+        virtual const R3::Matrix& siteCartesianUij(int idx) const;
+        virtual StructureDifference diff(StructureAdapterConstPtr) const;
+
+        // methods - own
+        /// load coordinates of the frame idx
+        void setFrame(int idx);
+        int getFrame() const;
+        int countFrames() const;
+        const TrajectoryFilePtr& getTrajectory() const;
+
+    private:
+
+        // types
+        typedef std::vector<R3::Vector> PositionsStorage;
+
+        // data
+        TrajectoryFilePtr mtrajectory;
+        AtomicStructureAdapterPtr matoms;
+        int mframe;
+        boost::shared_ptr<PositionsStorage> mpositions;
+
+        // serialization saves only the current frame
+        friend class boost::serialization::access;
+        template<class Archive>
+            void serialize(Archive& ar, const unsigned int version)
+        {
+            ar & boost::serialization::base_object<StructureAdapter>(*this);
+            ar & matoms;
+            ar & mframe;
+            ar & mpositions;
+        }
+
+};
+
+typedef boost::shared_ptr<TrajectoryStructureAdapter>
+    TrajectoryStructureAdapterPtr;
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+BOOST_CLASS_EXPORT_KEY(diffpy::srreal::TrajectoryStructureAdapter)
+
+#endif  // TRAJECTORYSTRUCTUREADAPTER_HPP_INCLUDED
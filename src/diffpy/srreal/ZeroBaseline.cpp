@@ -53,6 +53,10 @@ double ZeroBaseline::operator()(const double& r) const
     return 0.0;
 }
 
+
+void ZeroBaseline::apply(const double* r, double* y, size_t n) const
+{ }
+
 // Registration --------------------------------------------------------------
 
 bool reg_ZeroBaseline = ZeroBaseline().registerThisType();
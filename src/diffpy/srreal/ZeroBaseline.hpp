@@ -38,6 +38,7 @@ class ZeroBaseline : public PDFBaseline
         // methods
         const std::string& type() const;
         double operator()(const double& r) const;
+        void apply(const double* r, double* y, size_t n) const;
 
     private:
 
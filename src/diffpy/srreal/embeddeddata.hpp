@@ -0,0 +1,109 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* Records of the runtime data tables that are compiled into the library
+* when built with "scons embed_data=True".  The arrays are defined in
+* a source file generated by site_scons/embeddeddata.py.
+*
+*****************************************************************************/
+
+#ifndef EMBEDDEDDATA_HPP_INCLUDED
+#define EMBEDDEDDATA_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <diffpy/features.hpp>
+
+namespace diffpy {
+namespace srreal {
+namespace embeddeddata {
+
+/// Waasmaier-Kirfel coefficients from f0_WaasKirf.dat
+struct WKFormulaRecord
+{
+    const char* symbol;
+    double a[5];
+    double c;
+    double b[5];
+};
+
+/// electron numbers of elements and ions from ionlist.dat
+struct ElectronNumberRecord
+{
+    const char* symbol;
+    int value;
+};
+
+/// neutron scattering lengths from nsftable.dat
+struct NeutronBCRecord
+{
+    const char* symbol;
+    double bc;
+};
+
+/// bond valence parameters from bvparm2011sel.cif
+struct BVParamRecord
+{
+    const char* atom0;
+    int valence0;
+    const char* atom1;
+    int valence1;
+    double Ro;
+    double B;
+    const char* ref_id;
+};
+
+/// Return true if the compiled-in tables should be used.  The data files
+/// are loaded instead when the DIFFPYRUNTIME variable is set, so that
+/// they can be overridden by the user.
+inline bool enabled()
+{
+#ifdef DIFFPY_HAS_EMBEDDED_DATA
+    return !std::getenv("DIFFPYRUNTIME");
+#else
+    return false;
+#endif
+}
+
+/// Runtime table as a map of symbols to values.  The tables below are
+/// loaded from the data files or built from the compiled-in arrays when
+/// embedded is true, so that the two sources can be compared.
+typedef std::map<std::string, std::vector<double> > TableValues;
+
+TableValues waasKirfTable(bool embedded);
+TableValues electronNumberTable(bool embedded);
+TableValues neutronBCTable(bool embedded);
+/// keys are "atom0 valence0 atom1 valence1 ref_id", values (Ro, B)
+TableValues bvParamTable(bool embedded);
+
+#ifdef DIFFPY_HAS_EMBEDDED_DATA
+extern const WKFormulaRecord wkformulas[];
+extern const size_t wkformulas_size;
+extern const ElectronNumberRecord electronnumbers[];
+extern const size_t electronnumbers_size;
+extern const NeutronBCRecord neutronbc[];
+extern const size_t neutronbc_size;
+extern const BVParamRecord bvparams[];
+extern const size_t bvparams_size;
+#endif
+
+}   // namespace embeddeddata
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // EMBEDDEDDATA_HPP_INCLUDED
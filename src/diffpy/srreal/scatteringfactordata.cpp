@@ -31,10 +31,12 @@
 
 #include <diffpy/srreal/scatteringfactordata.hpp>
 #include <diffpy/srreal/AtomUtils.hpp>
+#include <diffpy/srreal/embeddeddata.hpp>
 #include <diffpy/runtimepath.hpp>
 #include <diffpy/validators.hpp>
 
 using namespace std;
+namespace embeddeddata = diffpy::srreal::embeddeddata;
 
 // Helper classes and functions ----------------------------------------------
 
@@ -127,13 +129,11 @@ typedef unordered_set<WaasKirfFormula,
         wksmbl_hash, wksmbl_equal> SetOfWKFormulas;
 
 
-const SetOfWKFormulas& getWKFormulasSet()
+SetOfWKFormulas* loadWKFormulasSet()
 {
     using namespace diffpy::runtimepath;
     using diffpy::validators::ensureFileOK;
-    static unique_ptr<SetOfWKFormulas> the_set;
-    if (the_set)  return *the_set;
-    the_set.reset(new SetOfWKFormulas);
+    unique_ptr<SetOfWKFormulas> the_set(new SetOfWKFormulas);
     string wkfile = datapath("f0_WaasKirf.dat");
     ifstream fp(wkfile.c_str());
     ensureFileOK(wkfile, fp);
@@ -182,7 +182,35 @@ const SetOfWKFormulas& getWKFormulasSet()
             wk.symbol.clear();
         }
     }
-    return getWKFormulasSet();
+    return the_set.release();
+}
+
+
+SetOfWKFormulas* embeddedWKFormulasSet()
+{
+    unique_ptr<SetOfWKFormulas> the_set(new SetOfWKFormulas);
+#ifdef DIFFPY_HAS_EMBEDDED_DATA
+    using embeddeddata::wkformulas;
+    for (size_t i = 0; i < embeddeddata::wkformulas_size; ++i)
+    {
+        WaasKirfFormula wk;
+        wk.symbol = wkformulas[i].symbol;
+        copy(wkformulas[i].a, wkformulas[i].a + WKTerms, wk.a);
+        copy(wkformulas[i].b, wkformulas[i].b + WKTerms, wk.b);
+        wk.c = wkformulas[i].c;
+        the_set->insert(wk);
+    }
+#endif
+    return the_set.release();
+}
+
+
+const SetOfWKFormulas& getWKFormulasSet()
+{
+    // static initialization is thread safe and retried after exception
+    static unique_ptr<SetOfWKFormulas> the_set(embeddeddata::enabled() ?
+            embeddedWKFormulasSet() : loadWKFormulasSet());
+    return *the_set;
 }
 
 
@@ -219,48 +247,67 @@ SetOfWKFormulas::const_iterator findWKFormula(const string& smbl)
 
 typedef unordered_map<string,int> ElectronNumberStorage;
 
-ElectronNumberStorage& getElectronNumberTable()
+ElectronNumberStorage* loadElectronNumberTable()
 {
     using namespace diffpy::runtimepath;
     using diffpy::validators::ensureFileOK;
-    static unique_ptr<ElectronNumberStorage> entable;
+    unique_ptr<ElectronNumberStorage> entable(new ElectronNumberStorage);
     typedef ElectronNumberStorage::value_type ENPair;
-    if (!entable)
+    string ionfile = datapath("ionlist.dat");
+    ifstream fp0(ionfile.c_str());
+    ensureFileOK(ionfile, fp0);
+    LineReader line;
+    while (fp0 >> line)
     {
-        entable.reset(new ElectronNumberStorage);
-        string ionfile = datapath("ionlist.dat");
-        ifstream fp0(ionfile.c_str());
-        ensureFileOK(ionfile, fp0);
-        LineReader line;
-        while (fp0 >> line)
+        if (line.isignored())  continue;
+        istringstream fpline(line.line);
+        string element;
+        int z = 0;
+        fpline >> element >> z;
+        if (!fpline)
         {
-            if (line.isignored())  continue;
-            istringstream fpline(line.line);
-            string element;
-            int z = 0;
-            fpline >> element >> z;
-            if (!fpline)
-            {
-                throw line.format_error(ionfile,
-                        "Expected at least 2 columns for (symbol, Z).");
-            }
-            entable->insert(ENPair(element, z));
-            for (int v; fpline >> v;)
-            {
-                ostringstream smbl;
-                smbl << element << abs(v) << ((v > 0) ? '+' : '-');
-                entable->insert(ENPair(smbl.str(), z - v));
-            }
+            throw line.format_error(ionfile,
+                    "Expected at least 2 columns for (symbol, Z).");
         }
-        const size_t mintablesize = 447;
-        if (entable->size() < mintablesize)
+        entable->insert(ENPair(element, z));
+        for (int v; fpline >> v;)
         {
-            ostringstream emsg;
-            emsg << "Incomplete file.  Expected " << mintablesize <<
-                " items loaded " << entable->size() << ".";
-            throw line.format_error(ionfile, emsg.str());
+            ostringstream smbl;
+            smbl << element << abs(v) << ((v > 0) ? '+' : '-');
+            entable->insert(ENPair(smbl.str(), z - v));
         }
     }
+    const size_t mintablesize = 447;
+    if (entable->size() < mintablesize)
+    {
+        ostringstream emsg;
+        emsg << "Incomplete file.  Expected " << mintablesize <<
+            " items loaded " << entable->size() << ".";
+        throw line.format_error(ionfile, emsg.str());
+    }
+    return entable.release();
+}
+
+
+ElectronNumberStorage* embeddedElectronNumberTable()
+{
+    unique_ptr<ElectronNumberStorage> entable(new ElectronNumberStorage);
+#ifdef DIFFPY_HAS_EMBEDDED_DATA
+    using embeddeddata::electronnumbers;
+    for (size_t i = 0; i < embeddeddata::electronnumbers_size; ++i)
+    {
+        entable->emplace(electronnumbers[i].symbol, electronnumbers[i].value);
+    }
+#endif
+    return entable.release();
+}
+
+
+const ElectronNumberStorage& getElectronNumberTable()
+{
+    static unique_ptr<ElectronNumberStorage>
+        entable(embeddeddata::enabled() ?
+                embeddedElectronNumberTable() : loadElectronNumberTable());
     return *entable;
 }
 
@@ -268,14 +315,12 @@ ElectronNumberStorage& getElectronNumberTable()
 
 typedef unordered_map<string,double> NeutronBCStorage;
 
-const NeutronBCStorage& getNeutronBCTable()
+NeutronBCStorage* loadNeutronBCTable()
 {
     using namespace diffpy::runtimepath;
     using diffpy::validators::ensureFileOK;
     typedef NeutronBCStorage::value_type BCPair;
-    static unique_ptr<NeutronBCStorage> bctable;
-    if (bctable)  return *bctable;
-    bctable.reset(new NeutronBCStorage);
+    unique_ptr<NeutronBCStorage> bctable(new NeutronBCStorage);
     string nsffile = datapath("nsftable.dat");
     ifstream fp(nsffile.c_str());
     ensureFileOK(nsffile, fp);
@@ -343,7 +388,29 @@ const NeutronBCStorage& getNeutronBCTable()
     bctable->insert(BCPair("n", bctable->at("1-n")));
     bctable->insert(BCPair("D", bctable->at("2-H")));
     bctable->insert(BCPair("T", bctable->at("3-H")));
-    return getNeutronBCTable();
+    return bctable.release();
+}
+
+
+NeutronBCStorage* embeddedNeutronBCTable()
+{
+    unique_ptr<NeutronBCStorage> bctable(new NeutronBCStorage);
+#ifdef DIFFPY_HAS_EMBEDDED_DATA
+    using embeddeddata::neutronbc;
+    for (size_t i = 0; i < embeddeddata::neutronbc_size; ++i)
+    {
+        bctable->emplace(neutronbc[i].symbol, neutronbc[i].bc);
+    }
+#endif
+    return bctable.release();
+}
+
+
+const NeutronBCStorage& getNeutronBCTable()
+{
+    static unique_ptr<NeutronBCStorage> bctable(embeddeddata::enabled() ?
+            embeddedNeutronBCTable() : loadNeutronBCTable());
+    return *bctable;
 }
 
 }   // namespace
@@ -423,5 +490,51 @@ double bcneutron(const string& smbl)
     return it->second;
 }
 
+// Comparison of the data sources --------------------------------------------
+
+namespace embeddeddata {
+
+TableValues waasKirfTable(bool embedded)
+{
+    unique_ptr<SetOfWKFormulas> wkset(embedded ?
+            embeddedWKFormulasSet() : loadWKFormulasSet());
+    TableValues rv;
+    for (const WaasKirfFormula& wk : *wkset)
+    {
+        vector<double>& v = rv[wk.symbol];
+        v.assign(wk.a, wk.a + WKTerms);
+        v.push_back(wk.c);
+        v.insert(v.end(), wk.b, wk.b + WKTerms);
+    }
+    return rv;
+}
+
+
+TableValues electronNumberTable(bool embedded)
+{
+    unique_ptr<ElectronNumberStorage> entable(embedded ?
+            embeddedElectronNumberTable() : loadElectronNumberTable());
+    TableValues rv;
+    for (const ElectronNumberStorage::value_type& en : *entable)
+    {
+        rv[en.first].assign(1, en.second);
+    }
+    return rv;
+}
+
+
+TableValues neutronBCTable(bool embedded)
+{
+    unique_ptr<NeutronBCStorage> bctable(embedded ?
+            embeddedNeutronBCTable() : loadNeutronBCTable());
+    TableValues rv;
+    for (const NeutronBCStorage::value_type& bc : *bctable)
+    {
+        rv[bc.first].assign(1, bc.second);
+    }
+    return rv;
+}
+
+}   // namespace embeddeddata
 }   // namespace srreal
 }   // namespace diffpy
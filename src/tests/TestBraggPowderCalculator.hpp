@@ -0,0 +1,158 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestBraggPowderCalculator -- unit tests for BraggPowderCalculator
+*
+*****************************************************************************/
+
+#include <cxxtest/TestSuite.h>
+
+#include <boost/make_shared.hpp>
+
+#include <diffpy/srreal/BraggPowderCalculator.hpp>
+#include <diffpy/srreal/CrystalStructureAdapter.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+class TestBraggPowderCalculator : public CxxTest::TestSuite
+{
+    private:
+
+        boost::shared_ptr<BraggPowderCalculator> mbragg;
+        PeriodicStructureAdapterPtr mnickel;
+        double muiso;
+
+    public:
+
+        void setUp()
+        {
+            mbragg.reset(new BraggPowderCalculator);
+            mbragg->setScatteringFactorTableByType("neutron");
+            muiso = 0.005;
+            mnickel = makeNickelStructure(muiso);
+        }
+
+
+        void test_peak_intensity()
+        {
+            mbragg->setQstep(0.005);
+            mbragg->setQmax(4.0);
+            mbragg->eval(mnickel);
+            QuantityType qgrid = mbragg->getQgrid();
+            QuantityType iq = mbragg->getIntensity();
+            TS_ASSERT_EQUALS(qgrid.size(), iq.size());
+            // integrated intensity of the (111) peak
+            const double a = 3.52;
+            const double q111 = 2 * M_PI * sqrt(3.0) / a;
+            double area = 0.0;
+            double qpeak = 0.0;
+            double ipeak = 0.0;
+            for (size_t i = 0; i < qgrid.size(); ++i)
+            {
+                if (fabs(qgrid[i] - q111) > 0.2)  continue;
+                area += iq[i] * mbragg->getQstep();
+                if (iq[i] > ipeak)  qpeak = qgrid[i];
+                ipeak = max(ipeak, iq[i]);
+            }
+            TS_ASSERT_DELTA(q111, qpeak, mbragg->getQstep());
+            const double b = mbragg->getScatteringFactorTable()->
+                lookup("Ni", q111);
+            const double fhkl = 4 * b * exp(-0.5 * muiso * q111 * q111);
+            const double expected = 2 * M_PI * M_PI / (a * a * a * 4) *
+                8 * fhkl * fhkl / (q111 * q111);
+            TS_ASSERT_DELTA(1.0, area / expected, 1e-8);
+            // (110) reflection is extinct in the fcc lattice
+            const double q110 = 2 * M_PI * sqrt(2.0) / a;
+            TS_ASSERT_EQUALS(0.0, iq[int(round(q110 / mbragg->getQstep()))]);
+        }
+
+
+        void test_getF()
+        {
+            mbragg->setQmax(5.0);
+            mbragg->eval(mnickel);
+            QuantityType qgrid = mbragg->getQgrid();
+            QuantityType fq = mbragg->getF();
+            // only the self-scattering term remains between the peaks
+            const int k = int(round(2.5 / mbragg->getQstep()));
+            const double q = qgrid[k];
+            TS_ASSERT_DELTA(-q * exp(-muiso * q * q), fq[k], 1e-12);
+            // Qmin cuts the low-Q region
+            mbragg->setQmin(1.0);
+            mbragg->eval(mnickel);
+            fq = mbragg->getF();
+            TS_ASSERT_EQUALS(0.0, fq[10]);
+        }
+
+
+        void test_crystal_symmetry()
+        {
+            // 4/m point group with F-centering on a tetragonal cell
+            CrystalStructureAdapterPtr cstru =
+                boost::make_shared<CrystalStructureAdapter>();
+            cstru->setLatPar(5.0, 5.0, 7.0, 90, 90, 90);
+            R3::Matrix R4 = R3::zeromatrix();
+            R4(0, 1) = -1;  R4(1, 0) = 1;  R4(2, 2) = 1;
+            R3::Matrix R = R3::identity();
+            for (int p = 0; p < 4; ++p, R = R3::prod(R4, R))
+            {
+                R3::Matrix mR = R;
+                mR *= -1;
+                for (int c = 0; c < 4; ++c)
+                {
+                    R3::Vector t(0.5, 0.5, 0.5);
+                    if (c)  t[c - 1] = 0.0;
+                    else  t = R3::Vector(0.0, 0.0, 0.0);
+                    cstru->addSymOp(R, t);
+                    cstru->addSymOp(mR, t);
+                }
+            }
+            Atom a;
+            a.atomtype = "Ni";
+            a.xyz_cartn = R3::Vector(0.1, 0.2, 0.3);
+            a.anisotropy = true;
+            a.uij_cartn = R3::identity();
+            a.uij_cartn *= 0.004;
+            a.uij_cartn(2, 2) = 0.012;
+            cstru->toCartesian(a);
+            cstru->append(a);
+            a.atomtype = "O";
+            a.xyz_cartn = R3::Vector(0.0, 0.0, 1.75);
+            cstru->append(a);
+            TS_ASSERT_EQUALS(32, cstru->siteMultiplicity(0));
+            PeriodicStructureAdapterPtr p1 = expandToP1(*cstru);
+            mbragg->setQmax(8.0);
+            QuantityType icryst = mbragg->eval(cstru);
+            QuantityType ip1 = mbragg->eval(p1);
+            TS_ASSERT_EQUALS(ip1.size(), icryst.size());
+            const double imax = maxAbsValue(ip1);
+            const double dimax = maxAbsDifference(ip1, icryst);
+            TS_ASSERT_LESS_THAN(0.0, imax);
+            TS_ASSERT_LESS_THAN(dimax, 1e-10 * imax);
+        }
+
+
+        void test_nonperiodic()
+        {
+            AtomicStructureAdapterPtr stru =
+                boost::make_shared<AtomicStructureAdapter>();
+            stru->append(Atom());
+            TS_ASSERT_THROWS(mbragg->eval(stru), invalid_argument);
+        }
+
+};  // class TestBraggPowderCalculator
+
+// End of file
@@ -0,0 +1,143 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestComplexity -- scaling of the calculation costs with the
+*     structure size.  The checks use the PQStatistics counters so that
+*     they are independent of the timing noise.
+*
+*****************************************************************************/
+
+#include <cxxtest/TestSuite.h>
+
+#include <boost/make_shared.hpp>
+
+#include <diffpy/srreal/AtomicStructureAdapter.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+using namespace std;
+
+namespace {
+
+/// simple cubic cluster of n x n x n atoms
+AtomicStructureAdapterPtr cubicCluster(int n, double spacing)
+{
+    AtomicStructureAdapterPtr rv = boost::make_shared<AtomicStructureAdapter>();
+    Atom a;
+    a.atomtype = "C";
+    a.uij_cartn = R3::identity();
+    a.uij_cartn *= 0.005;
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            for (int k = 0; k < n; ++k)
+            {
+                a.xyz_cartn = R3::Vector(i, j, k);
+                a.xyz_cartn *= spacing;
+                rv->append(a);
+            }
+        }
+    }
+    return rv;
+}
+
+
+long pdfBufferBytes(StructureAdapterPtr stru, bool histogrammode)
+{
+    PDFCalculator pdfc;
+    pdfc.setRmax(10);
+    pdfc.setHistogramMode(histogrammode);
+    pdfc.setStatisticsEnabled(true);
+    pdfc.eval(stru);
+    return pdfc.getStatistics().bufferbytes;
+}
+
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// class TestComplexity
+//////////////////////////////////////////////////////////////////////////////
+
+class TestComplexity : public CxxTest::TestSuite
+{
+    private:
+
+        AtomicStructureAdapterPtr msmall;
+        AtomicStructureAdapterPtr mlarge;
+
+    public:
+
+        void setUp()
+        {
+            // 64 and 512 atoms
+            if (!msmall)  msmall = cubicCluster(4, 2.5);
+            if (!mlarge)  mlarge = cubicCluster(8, 2.5);
+        }
+
+
+        void test_optimized_single_atom_update()
+        {
+            AtomicStructureAdapterPtr stru[] = {msmall, mlarge};
+            for (int i = 0; i < 2; ++i)
+            {
+                PDFCalculator pdfc;
+                pdfc.setEvaluatorType(OPTIMIZED);
+                pdfc.setRmax(100);
+                pdfc.setStatisticsEnabled(true);
+                const PQStatistics& stats = pdfc.getStatistics();
+                AtomicStructureAdapterPtr s =
+                    boost::make_shared<AtomicStructureAdapter>(*stru[i]);
+                const long N = s->countSites();
+                pdfc.eval(s);
+                TS_ASSERT_EQUALS(N * (N - 1) / 2, stats.paircontributions);
+                pdfc.resetStatistics();
+                s->at(N / 2).xyz_cartn[0] += 0.1;
+                pdfc.eval(s);
+                TS_ASSERT_EQUALS(1, stats.fastupdates);
+                TS_ASSERT_EQUALS(0, stats.fullevaluations);
+                // remove and add back the N - 1 pairs of the shifted atom
+                TS_ASSERT_EQUALS(2 * (N - 1), stats.paircontributions);
+                TS_ASSERT_LESS_THAN_EQUALS(stats.bondsgenerated, 2 * N);
+            }
+        }
+
+
+        void test_pdf_buffer_bytes()
+        {
+            const long szd = sizeof(double);
+            PDFCalculator pdfc;
+            pdfc.setRmax(10);
+            const long npts = pdfc.getExtendedRgrid().size();
+            for (int hmode = 0; hmode < 2; ++hmode)
+            {
+                const long bsmall = pdfBufferBytes(msmall, hmode);
+                const long blarge = pdfBufferBytes(mlarge, hmode);
+                TS_ASSERT_LESS_THAN(0, bsmall);
+                // only the per-site data grow with the structure size
+                TS_ASSERT_LESS_THAN_EQUALS(blarge - bsmall, 2 * szd * 448);
+                if (hmode)  continue;
+                // calculated and stashed values and the site data
+                TS_ASSERT_LESS_THAN_EQUALS(blarge, szd * (4 * npts + 2 * 512));
+            }
+        }
+
+};  // class TestComplexity
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
@@ -0,0 +1,294 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestCrystalStructureAdapter -- unit tests for the expansion
+*     of asymmetric unit sites with the space group operations
+*
+*****************************************************************************/
+
+#include <cxxtest/TestSuite.h>
+
+#include <boost/make_shared.hpp>
+
+#include <diffpy/srreal/CrystalStructureAdapter.hpp>
+#include <diffpy/srreal/ConstantPeakWidth.hpp>
+#include <diffpy/srreal/DebyePDFCalculator.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include "test_helpers.hpp"
+
+namespace diffpy {
+namespace srreal {
+
+using namespace std;
+
+namespace {
+
+/// cubic crystal with the 192 symmetry operations of the Fm-3m group
+CrystalStructureAdapterPtr makeFm3mCrystal()
+{
+    CrystalStructureAdapterPtr rv =
+        boost::make_shared<CrystalStructureAdapter>();
+    rv->setLatPar(10, 10, 10, 90, 90, 90);
+    const int perms[6][3] = {
+        {0, 1, 2}, {1, 2, 0}, {2, 0, 1}, {0, 2, 1}, {2, 1, 0}, {1, 0, 2}};
+    for (int ic = 0; ic < 4; ++ic)
+    {
+        R3::Vector t(0.0, 0.0, 0.0);
+        if (ic)  t = R3::Vector(0.5, 0.5, 0.5);
+        if (ic)  t[ic - 1] = 0.0;
+        for (int ip = 0; ip < 6; ++ip)
+        {
+            for (int signs = 0; signs < 8; ++signs)
+            {
+                R3::Matrix R = R3::zeromatrix();
+                for (int i = 0; i < R3::Ndim; ++i)
+                {
+                    R(i, perms[ip][i]) = (signs & (1 << i)) ? -1 : 1;
+                }
+                rv->addSymOp(R, t);
+            }
+        }
+    }
+    return rv;
+}
+
+
+void appendFractional(CrystalStructureAdapterPtr stru,
+        double x, double y, double z)
+{
+    Atom a;
+    a.atomtype = "Ni";
+    a.xyz_cartn = R3::Vector(x, y, z);
+    stru->toCartesian(a);
+    stru->append(a);
+}
+
+
+/// peak width that depends on the bond direction
+class DirectionalPeakWidth : public ConstantPeakWidth
+{
+    public:
+
+        virtual PeakWidthModelPtr clone() const
+        {
+            return PeakWidthModelPtr(new DirectionalPeakWidth(*this));
+        }
+
+
+        virtual double calculate(const BaseBondGenerator& bnds) const
+        {
+            const double cx = fabs(bnds.r01()[0]) / bnds.distance();
+            return this->getWidth() * (0.5 + 0.5 * cx);
+        }
+
+};
+
+
+/// calculators with public configureBondGenerator
+class PDFCalculatorBonds : public PDFCalculator
+{
+    public:
+        using PDFCalculator::configureBondGenerator;
+};
+
+
+class DebyePDFCalculatorBonds : public DebyePDFCalculator
+{
+    public:
+        using DebyePDFCalculator::configureBondGenerator;
+};
+
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// class TestCrystalStructureAdapter
+//////////////////////////////////////////////////////////////////////////////
+
+class TestCrystalStructureAdapter : public CxxTest::TestSuite
+{
+    private:
+
+        CrystalStructureAdapterPtr mfm3m;
+
+    public:
+
+        void setUp()
+        {
+            mfm3m = makeFm3mCrystal();
+        }
+
+
+        void test_siteMultiplicity()
+        {
+            TS_ASSERT_EQUALS(192, mfm3m->countSymOps());
+            // Wyckoff positions of Fm-3m
+            const double wyckoff[][4] = {
+                {0, 0, 0, 4}, {0.5, 0.5, 0.5, 4}, {0.25, 0.25, 0.25, 8},
+                {0, 0.25, 0.25, 24}, {0.2, 0, 0, 24}, {0.1, 0.1, 0.1, 32},
+                {0.1, 0.25, 0.25, 48}, {0, 0.1, 0.1, 48}, {0, 0.1, 0.2, 96},
+                {0.1, 0.1, 0.3, 96}, {0.05, 0.1, 0.3, 192}};
+            const int n = sizeof(wyckoff) / sizeof(wyckoff[0]);
+            for (int i = 0; i < n; ++i)
+            {
+                const double* w = wyckoff[i];
+                appendFractional(mfm3m, w[0], w[1], w[2]);
+            }
+            for (int i = 0; i < n; ++i)
+            {
+                TS_ASSERT_EQUALS(int(wyckoff[i][3]),
+                        mfm3m->siteMultiplicity(i));
+            }
+        }
+
+
+        void test_near_special_position()
+        {
+            const double eps = 1e-6;
+            appendFractional(mfm3m, eps, -eps, 0.0);
+            appendFractional(mfm3m, 0.25 - eps, 0.25, 0.25 + eps);
+            appendFractional(mfm3m, 1.0 - eps, 0.5 + eps, 0.5);
+            TS_ASSERT_EQUALS(4, mfm3m->siteMultiplicity(0));
+            TS_ASSERT_EQUALS(8, mfm3m->siteMultiplicity(1));
+            TS_ASSERT_EQUALS(4, mfm3m->siteMultiplicity(2));
+            // sites farther than the symmetry precision are distinct
+            mfm3m->setSymmetryPrecision(1e-6);
+            TS_ASSERT_EQUALS(48, mfm3m->siteMultiplicity(0));
+            TS_ASSERT_EQUALS(96, mfm3m->siteMultiplicity(1));
+            TS_ASSERT_EQUALS(48, mfm3m->siteMultiplicity(2));
+        }
+
+
+        void test_moved_site_update()
+        {
+            appendFractional(mfm3m, 0.05, 0.1, 0.3);
+            appendFractional(mfm3m, 0.0, 0.0, 0.0);
+            const Atom* eq0 = &(mfm3m->getEquivalentAtoms(0)[0]);
+            TS_ASSERT_EQUALS(4, mfm3m->siteMultiplicity(1));
+            // moving site 1 off the special position must be noticed
+            Atom& a1 = mfm3m->at(1);
+            a1.xyz_cartn = R3::Vector(1.0, 1.0, 1.0);
+            TS_ASSERT_EQUALS(32, mfm3m->siteMultiplicity(1));
+            R3::Vector dxyz = a1.xyz_cartn -
+                mfm3m->getEquivalentAtoms(1)[0].xyz_cartn;
+            TS_ASSERT_DELTA(0.0, R3::norm(dxyz), 1e-12);
+            // only the moved site is expanded again
+            mfm3m->updateSymmetryPositions();
+            TS_ASSERT_EQUALS(eq0, &(mfm3m->getEquivalentAtoms(0)[0]));
+            TS_ASSERT_DELTA(9.5, mfm3m->getEquivalentAtoms(0)[1].xyz_cartn[0],
+                    1e-12);
+            // lattice change requires expansion of all sites
+            mfm3m->setLatPar(20, 20, 20, 90, 90, 90);
+            TS_ASSERT_EQUALS(192, mfm3m->siteMultiplicity(0));
+            TS_ASSERT_DELTA(19.5, mfm3m->getEquivalentAtoms(0)[1].xyz_cartn[0],
+                    1e-12);
+        }
+
+
+        void test_orbit_reduction()
+        {
+            appendFractional(mfm3m, 0.0, 0.0, 0.0);
+            appendFractional(mfm3m, 0.25, 0.25, 0.25);
+            appendFractional(mfm3m, 0.1, 0.2, 0.3);
+            for (int i = 0; i < mfm3m->countSites(); ++i)
+            {
+                Atom& a = mfm3m->at(i);
+                a.uij_cartn = R3::identity();
+                a.uij_cartn *= 0.005;
+            }
+            PeriodicStructureAdapterPtr p1 = expandToP1(*mfm3m);
+            // weighted symmetry-unique bonds match the full bond list
+            BaseBondGeneratorPtr bnds = mfm3m->createBondGenerator();
+            bnds->setRmax(7.0);
+            long nfull = 0;
+            for (int i = 0; i < mfm3m->countSites(); ++i)
+            {
+                bnds->selectAnchorSite(i);
+                for (bnds->rewind(); !bnds->finished(); bnds->next())
+                {
+                    nfull += bnds->multiplicity();
+                }
+            }
+            bnds->setOrbitReduction(true);
+            long nunique = 0;
+            long nweighted = 0;
+            for (int i = 0; i < mfm3m->countSites(); ++i)
+            {
+                bnds->selectAnchorSite(i);
+                for (bnds->rewind(); !bnds->finished(); bnds->next())
+                {
+                    nunique += 1;
+                    nweighted += bnds->multiplicity();
+                }
+            }
+            TS_ASSERT_EQUALS(nfull, nweighted);
+            TS_ASSERT_LESS_THAN(3 * nunique, nfull);
+            // PDF is the same as for the expanded P1 structure
+            PDFCalculator pdfc;
+            pdfc.setRmax(7.0);
+            pdfc.eval(mfm3m);
+            QuantityType gcryst = pdfc.getPDF();
+            pdfc.eval(p1);
+            QuantityType gp1 = pdfc.getPDF();
+            TS_ASSERT_EQUALS(gp1.size(), gcryst.size());
+            const double gmax = maxAbsValue(gp1);
+            const double dgmax = maxAbsDifference(gp1, gcryst);
+            TS_ASSERT_LESS_THAN(0.0, gmax);
+            TS_ASSERT_LESS_THAN(dgmax, 1e-8 * gmax);
+            // symmetry-unique bonds only for the built-in peak widths
+            PDFCalculatorBonds pdfcb;
+            DebyePDFCalculatorBonds dpdfcb;
+            bnds = mfm3m->createBondGenerator();
+            pdfcb.configureBondGenerator(*bnds);
+            TS_ASSERT(bnds->getOrbitReduction());
+            dpdfcb.configureBondGenerator(*bnds);
+            TS_ASSERT(bnds->getOrbitReduction());
+            DirectionalPeakWidth dpw;
+            pdfcb.setPeakWidthModel(dpw.clone());
+            pdfcb.configureBondGenerator(*bnds);
+            TS_ASSERT(!bnds->getOrbitReduction());
+            dpdfcb.setPeakWidthModel(dpw.clone());
+            bnds->setOrbitReduction(true);
+            dpdfcb.configureBondGenerator(*bnds);
+            TS_ASSERT(!bnds->getOrbitReduction());
+        }
+
+
+        void test_large_asymmetric_unit()
+        {
+            // enough symmetry images for the parallel expansion
+            const int nsites = 500;
+            for (int i = 0; i < nsites; ++i)
+            {
+                const double x = 0.001 + 0.4 * i / nsites;
+                appendFractional(mfm3m, x, 0.45 - 0.5 * x, 0.3);
+            }
+            appendFractional(mfm3m, 0.0, 0.0, 0.0);
+            for (int i = 0; i < nsites; ++i)
+            {
+                TS_ASSERT_EQUALS(192, mfm3m->siteMultiplicity(i));
+            }
+            TS_ASSERT_EQUALS(4, mfm3m->siteMultiplicity(nsites));
+            const CrystalStructureAdapter::AtomVector& eq =
+                mfm3m->getEquivalentAtoms(nsites / 2);
+            R3::Vector dxyz = eq[0].xyz_cartn -
+                mfm3m->siteCartesianPosition(nsites / 2);
+            TS_ASSERT_DELTA(0.0, R3::norm(dxyz), 1e-12);
+        }
+
+};  // class TestCrystalStructureAdapter
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
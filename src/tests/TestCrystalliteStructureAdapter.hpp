@@ -0,0 +1,181 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestCrystalliteStructureAdapter -- unit tests for crystallites
+*     cut from periodic structures
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <cxxtest/TestSuite.h>
+
+#include <boost/make_shared.hpp>
+
+#include <diffpy/srreal/CrystalliteStructureAdapter.hpp>
+#include <diffpy/srreal/CrystalStructureAdapter.hpp>
+#include <diffpy/srreal/DebyePDFCalculator.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+class TestCrystalliteStructureAdapter : public CxxTest::TestSuite
+{
+    private:
+
+        PeriodicStructureAdapterPtr mnickel;
+
+        /// all atoms of the crystallite as a finite structure
+        AtomicStructureAdapterPtr expandCrystallite(
+                const CrystalliteStructureAdapter& cryst)
+        {
+            AtomicStructureAdapterPtr rv =
+                boost::make_shared<AtomicStructureAdapter>();
+            const Lattice& L = cryst.getLattice();
+            for (const CrystalliteStructureAdapter::CellIndex& c :
+                    cryst.getCells())
+            {
+                R3::Vector t = L.cartesian(R3::Vector(c[0], c[1], c[2]));
+                for (Atom a : cryst)
+                {
+                    a.xyz_cartn += t;
+                    rv->append(a);
+                }
+            }
+            return rv;
+        }
+
+
+        /// total number of ordered cell pairs
+        long countCellPairs(const CrystalliteStructureAdapter& cryst)
+        {
+            CrystalliteStructureAdapter::CellDifferencesConstPtr cdiffs =
+                cryst.getCellDifferences();
+            long rv = 0;
+            for (size_t i = 0; i < cdiffs->count.size(); ++i)
+            {
+                rv += (cdiffs->length[i] > 0 ? 2 : 1) * cdiffs->count[i];
+            }
+            return rv;
+        }
+
+    public:
+
+        void setUp()
+        {
+            mnickel = makeNickelStructure(0.005);
+        }
+
+
+        void test_cellDifferences()
+        {
+            CrystalliteStructureAdapter cryst(mnickel);
+            TS_ASSERT_EQUALS(4, cryst.countSites());
+            TS_ASSERT_EQUALS(0, cryst.countCells());
+            TS_ASSERT_EQUALS(0u, cryst.getCellDifferences()->count.size());
+            cryst.setBoxShape(3, 4, 5);
+            TS_ASSERT_EQUALS(60, cryst.countCells());
+            TS_ASSERT_EQUALS(60, cryst.siteMultiplicity(0));
+            TS_ASSERT_EQUALS(3600, countCellPairs(cryst));
+            CrystalliteStructureAdapter::CellDifferencesConstPtr cdiffs =
+                cryst.getCellDifferences();
+            TS_ASSERT_EQUALS((5 * 7 * 9 + 1) / 2, int(cdiffs->count.size()));
+            TS_ASSERT_EQUALS(60, cdiffs->count[0]);
+            // duplicate cells are ignored
+            cryst.addCell(0, 0, 0);
+            TS_ASSERT_EQUALS(60, cryst.countCells());
+            cryst.setSphereShape(25.0);
+            const int ncells = cryst.countCells();
+            TS_ASSERT_LESS_THAN(100, ncells);
+            TS_ASSERT_EQUALS(long(ncells) * ncells, countCellPairs(cryst));
+        }
+
+
+        void test_sparse_cells()
+        {
+            CrystalliteStructureAdapter cryst(mnickel);
+            cryst.addCell(0, 0, 0);
+            cryst.addCell(0, 1000, 0);
+            cryst.addCell(1000, 1000, 1000);
+            cryst.addCell(0, 500, 0);
+            CrystalliteStructureAdapter::CellDifferencesConstPtr cdiffs =
+                cryst.getCellDifferences();
+            TS_ASSERT_EQUALS(16, countCellPairs(cryst));
+            TS_ASSERT_EQUALS(6u, cdiffs->count.size());
+            TS_ASSERT_EQUALS(4, cdiffs->count[0]);
+            TS_ASSERT_EQUALS(0.0, cdiffs->length[0]);
+            // (0, 500, 0) appears twice
+            TS_ASSERT_EQUALS(2, cdiffs->count[1]);
+            TS_ASSERT_DELTA(500 * 3.52, cdiffs->length[1], 1e-8);
+            TS_ASSERT_EQUALS(1, cdiffs->count[2]);
+            TS_ASSERT_DELTA(1000 * 3.52, cdiffs->length[2], 1e-8);
+            TS_ASSERT_DELTA(1000 * 3.52 * sqrt(3.0),
+                    cdiffs->length.back(), 1e-8);
+        }
+
+
+        void test_debye_sum()
+        {
+            CrystalliteStructureAdapterPtr cryst =
+                boost::make_shared<CrystalliteStructureAdapter>(mnickel);
+            cryst->setSphereShape(15.0);
+            AtomicStructureAdapterPtr cluster = expandCrystallite(*cryst);
+            TS_ASSERT_EQUALS(4 * cryst->countCells(), cluster->countSites());
+            DebyePDFCalculator dbpdf;
+            dbpdf.setRmax(20.0);
+            dbpdf.eval(cluster);
+            QuantityType f0 = dbpdf.getF();
+            dbpdf.eval(cryst);
+            QuantityType f1 = dbpdf.getF();
+            TS_ASSERT_EQUALS(f0.size(), f1.size());
+            const double fmax = maxAbsValue(f0);
+            const double dfmax = maxAbsDifference(f0, f1);
+            TS_ASSERT_LESS_THAN(0.0, fmax);
+            TS_ASSERT_LESS_THAN(dfmax, 1e-10 * fmax);
+        }
+
+
+        void test_crystal_source()
+        {
+            CrystalStructureAdapterPtr cstru =
+                boost::make_shared<CrystalStructureAdapter>();
+            cstru->setLatPar(4, 5, 6, 90, 90, 90);
+            cstru->addSymOp(R3::identity(), R3::Vector(0, 0, 0));
+            R3::Matrix minusone = R3::identity();
+            minusone *= -1;
+            cstru->addSymOp(minusone, R3::Vector(0.5, 0.5, 0.5));
+            Atom a;
+            a.atomtype = "C";
+            a.xyz_cartn = R3::Vector(0.1, 0.2, 0.3);
+            cstru->toCartesian(a);
+            cstru->append(a);
+            CrystalliteStructureAdapter cryst(cstru);
+            TS_ASSERT_EQUALS(2, cryst.countSites());
+            R3::Vector dxyz = cryst.siteCartesianPosition(1) -
+                cstru->getEquivalentAtoms(0)[1].xyz_cartn;
+            TS_ASSERT_DELTA(0.0, R3::norm(dxyz), 1e-12);
+        }
+
+
+        void test_nonperiodic()
+        {
+            AtomicStructureAdapterPtr stru =
+                boost::make_shared<AtomicStructureAdapter>();
+            TS_ASSERT_THROWS(CrystalliteStructureAdapter cryst(stru),
+                    invalid_argument);
+        }
+
+};  // class TestCrystalliteStructureAdapter
+
+// End of file
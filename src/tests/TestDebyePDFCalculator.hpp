@@ -147,6 +147,52 @@ class TestDebyePDFCalculator : public CxxTest::TestSuite
         }
 
 
+        void test_cachedResults()
+        {
+            mpdfc->setRmax(8.0);
+            mpdfc->eval(mstru10);
+            const QuantityType pdf0 = mpdfc->getPDF();
+            const QuantityType f0 = mpdfc->getF();
+            TS_ASSERT(pdf0 == mpdfc->getPDF());
+            TS_ASSERT(f0 == mpdfc->getF());
+            mpdfc->setDoubleAttr("scale", 2.0);
+            QuantityType pdf1 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            for (size_t i = 0; i < pdf0.size(); ++i)
+            {
+                TS_ASSERT_EQUALS(2 * pdf0[i], pdf1[i]);
+            }
+            mpdfc->setDoubleAttr("scale", 1.0);
+            mpdfc->setQmin(2.0);
+            TS_ASSERT(pdf0 != mpdfc->getPDF());
+            TS_ASSERT(f0 == mpdfc->getF());
+            mpdfc->setQmin(0.0);
+            TS_ASSERT(pdf0 == mpdfc->getPDF());
+            mpdfc->eval(mstru9);
+            TS_ASSERT(pdf0 != mpdfc->getPDF());
+            TS_ASSERT(f0 != mpdfc->getF());
+        }
+
+
+        void test_statistics()
+        {
+            mpdfc->setStatisticsEnabled(true);
+            // sine terms at high Q are damped below debyeprecision
+            mpdfc->setQmax(100.0);
+            mpdfc->eval(mstru10);
+            const PQStatistics& stats = mpdfc->getStatistics();
+            TS_ASSERT_EQUALS(45, stats.paircontributions);
+            const int nqpts = mpdfc->getQgrid().size();
+            TS_ASSERT_EQUALS(45 * nqpts,
+                    stats.qpointsevaluated + stats.qpointstruncated);
+            TS_ASSERT_LESS_THAN(0, stats.qpointstruncated);
+            mpdfc->setDebyePrecision(0.0);
+            mpdfc->resetStatistics();
+            mpdfc->eval(mstru10);
+            TS_ASSERT_EQUALS(0, stats.qpointstruncated);
+        }
+
+
         void test_getQgrid()
         {
             TS_ASSERT_EQUALS(92u, mpdfc->getQgrid().size());
@@ -0,0 +1,71 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestEmbeddedData -- compare the compiled-in data tables with
+*     the runtime data files
+*
+*****************************************************************************/
+
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/embeddeddata.hpp>
+
+using namespace std;
+using namespace diffpy::srreal;
+
+class TestEmbeddedData : public CxxTest::TestSuite
+{
+    private:
+
+        /// check that both tables have the same symbols and values
+        void compareTables(const embeddeddata::TableValues& tfile,
+                const embeddeddata::TableValues& tembedded)
+        {
+            TS_ASSERT_LESS_THAN(0u, tfile.size());
+            TS_ASSERT_EQUALS(tfile.size(), tembedded.size());
+            embeddeddata::TableValues::const_iterator ii, jj;
+            for (ii = tfile.begin(); ii != tfile.end(); ++ii)
+            {
+                jj = tembedded.find(ii->first);
+                TS_ASSERT(jj != tembedded.end());
+                if (jj == tembedded.end())  continue;
+                const vector<double>& v0 = ii->second;
+                const vector<double>& v1 = jj->second;
+                TS_ASSERT_EQUALS(v0.size(), v1.size());
+                for (size_t k = 0; k < v0.size() && k < v1.size(); ++k)
+                {
+                    TS_ASSERT_EQUALS(v0[k], v1[k]);
+                }
+            }
+        }
+
+    public:
+
+        void test_tables()
+        {
+#ifdef DIFFPY_HAS_EMBEDDED_DATA
+            compareTables(embeddeddata::waasKirfTable(false),
+                    embeddeddata::waasKirfTable(true));
+            compareTables(embeddeddata::electronNumberTable(false),
+                    embeddeddata::electronNumberTable(true));
+            compareTables(embeddeddata::neutronBCTable(false),
+                    embeddeddata::neutronBCTable(true));
+            compareTables(embeddeddata::bvParamTable(false),
+                    embeddeddata::bvParamTable(true));
+#endif
+        }
+
+};  // class TestEmbeddedData
+
+// End of file
@@ -0,0 +1,97 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2013 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestEventTicker -- unit tests for the EventTicker class
+*
+*****************************************************************************/
+
+#include <set>
+#include <thread>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/EventTicker.hpp>
+#include "serialization_helpers.hpp"
+
+using diffpy::eventticker::EventTicker;
+
+//////////////////////////////////////////////////////////////////////////////
+// class TestEventTicker
+//////////////////////////////////////////////////////////////////////////////
+
+class TestEventTicker : public CxxTest::TestSuite
+{
+    public:
+
+        void test_click()
+        {
+            EventTicker tc0, tc1;
+            TS_ASSERT_EQUALS(tc0, tc1);
+            TS_ASSERT_EQUALS(EventTicker::value_type(0, 0), tc0.value());
+            tc0.click();
+            TS_ASSERT(tc1 < tc0);
+            tc1.click();
+            TS_ASSERT(tc0 < tc1);
+            tc0.updateFrom(tc1);
+            TS_ASSERT_EQUALS(tc1, tc0);
+        }
+
+
+        void test_click_threads()
+        {
+            const int nthreads = 4;
+            const int nclicks = 1000;
+            EventTicker tc0;
+            tc0.click();
+            std::vector<EventTicker> tickers(nthreads * nclicks);
+            std::vector<std::thread> workers;
+            for (int i = 0; i < nthreads; ++i)
+            {
+                EventTicker* tci = &(tickers[i * nclicks]);
+                workers.push_back(std::thread([tci, nclicks]() {
+                            for (int j = 0; j < nclicks; ++j)  tci[j].click();
+                            }));
+            }
+            for (int i = 0; i < nthreads; ++i)  workers[i].join();
+            // clicks are unique, newer than the earlier click in main
+            // thread and increasing within each thread
+            std::set<EventTicker::value_type> allticks;
+            for (size_t i = 0; i < tickers.size(); ++i)
+            {
+                allticks.insert(tickers[i].value());
+                TS_ASSERT(tc0 < tickers[i]);
+                if (i % nclicks)  TS_ASSERT(tickers[i - 1] < tickers[i]);
+            }
+            TS_ASSERT_EQUALS(tickers.size(), allticks.size());
+            // the next click in main thread is newer than all of them
+            EventTicker tc1;
+            tc1.click();
+            TS_ASSERT(tc1.value() > *allticks.rbegin());
+        }
+
+
+        void test_serialization()
+        {
+            EventTicker tc0;
+            tc0.click();
+            EventTicker tc1 = dumpandload(tc0);
+            TS_ASSERT_EQUALS(tc0, tc1);
+            EventTicker tc2;
+            tc2.click();
+            TS_ASSERT(tc1 < tc2);
+        }
+
+};  // class TestEventTicker
+
+// End of file
@@ -0,0 +1,79 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestLatticeShell -- unit tests for the LatticeShell class
+*     and the getLatticeShell function
+*
+*****************************************************************************/
+
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/LatticeShell.hpp>
+#include <diffpy/srreal/PointsInSphere.hpp>
+
+using namespace diffpy::srreal;
+
+class TestLatticeShell : public CxxTest::TestSuite
+{
+    private:
+
+        Lattice mlattice;
+
+    public:
+
+        void setUp()
+        {
+            mlattice.setLatPar(3, 4, 5, 80, 90, 100);
+        }
+
+
+        void test_vectors()
+        {
+            LatticeShell shell(mlattice, 2.0, 12.0);
+            int cnt = 0;
+            PointsInSphere sph(2.0, 12.0, mlattice);
+            for (sph.rewind(); !sph.finished(); sph.next())  ++cnt;
+            TS_ASSERT_EQUALS(cnt, shell.size());
+            for (int i = 0; i < shell.size(); ++i)
+            {
+                TS_ASSERT_DELTA(shell.r(i), R3::norm(shell.cartesian(i)),
+                        1e-12);
+                if (i)  TS_ASSERT_LESS_THAN_EQUALS(shell.r(i - 1), shell.r(i));
+            }
+            TS_ASSERT_EQUALS(0, shell.lowerBound(0.0));
+            TS_ASSERT_EQUALS(shell.size(), shell.upperBound(12.0));
+            int i5 = shell.lowerBound(5.0);
+            TS_ASSERT_LESS_THAN(0, i5);
+            TS_ASSERT_LESS_THAN(shell.r(i5 - 1), 5.0);
+            TS_ASSERT_LESS_THAN_EQUALS(5.0, shell.r(i5));
+        }
+
+
+        void test_getLatticeShell()
+        {
+            LatticeShellConstPtr sh0 = getLatticeShell(mlattice, 0.0, 10.0);
+            LatticeShellConstPtr sh1 = getLatticeShell(mlattice, 0.0, 10.0);
+            TS_ASSERT_EQUALS(sh0.get(), sh1.get());
+            TS_ASSERT_DIFFERS(sh0.get(),
+                    getLatticeShell(mlattice, 0.0, 11.0).get());
+            // the same cell with rotated base vectors
+            Lattice L1(mlattice.vb(), mlattice.vc(), mlattice.va());
+            LatticeShellConstPtr sh2 = getLatticeShell(L1, 0.0, 10.0);
+            TS_ASSERT_DIFFERS(sh0.get(), sh2.get());
+            TS_ASSERT_EQUALS(sh0->size(), sh2->size());
+        }
+
+};  // class TestLatticeShell
+
+// End of file
@@ -0,0 +1,216 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestNUFFTDebyeSum -- unit tests for the gridded Debye sum
+*
+*****************************************************************************/
+
+#include <cxxtest/TestSuite.h>
+
+#include <boost/make_shared.hpp>
+
+#include <diffpy/srreal/NUFFTDebyeSum.hpp>
+#include <diffpy/srreal/AtomicStructureAdapter.hpp>
+#include <diffpy/srreal/PeriodicStructureAdapter.hpp>
+
+using namespace std;
+using namespace diffpy::srreal;
+
+class TestNUFFTDebyeSum : public CxxTest::TestSuite
+{
+    private:
+
+        boost::shared_ptr<NUFFTDebyeSum> mnufft;
+        AtomicStructureAdapterPtr mcluster;
+
+        /// Debye sum over distinct pairs evaluated atom by atom
+        QuantityType directDebyeSum() const
+        {
+            const ScatteringFactorTablePtr& sftable =
+                mnufft->getScatteringFactorTable();
+            QuantityType qgrid = mnufft->getQgrid();
+            QuantityType rv(qgrid.size(), 0.0);
+            for (size_t kq = 1; kq < qgrid.size(); ++kq)
+            {
+                const double q = qgrid[kq];
+                for (const Atom& a0 : *mcluster)
+                {
+                    const double w0 = a0.occupancy *
+                        sftable->lookup(a0.atomtype, q) *
+                        exp(-0.5 * a0.uij_cartn(0, 0) * q * q);
+                    for (const Atom& a1 : *mcluster)
+                    {
+                        if (&a0 == &a1)  continue;
+                        const double w1 = a1.occupancy *
+                            sftable->lookup(a1.atomtype, q) *
+                            exp(-0.5 * a1.uij_cartn(0, 0) * q * q);
+                        const double r =
+                            R3::distance(a0.xyz_cartn, a1.xyz_cartn);
+                        rv[kq] += w0 * w1 * sin(q * r) / r;
+                    }
+                }
+            }
+            return rv;
+        }
+
+    public:
+
+        void setUp()
+        {
+            mnufft.reset(new NUFFTDebyeSum);
+            mnufft->setQmax(6.0);
+            mnufft->setQstep(0.1);
+            // small rocksalt-like cluster with two displacement classes
+            mcluster = boost::make_shared<AtomicStructureAdapter>();
+            for (int i = 0; i < 4; ++i)
+            {
+                for (int j = 0; j < 4; ++j)
+                {
+                    for (int k = 0; k < 4; ++k)
+                    {
+                        Atom a;
+                        a.atomtype = ((i + j + k) % 2) ? "Cl" : "Na";
+                        a.xyz_cartn = R3::Vector(i, j, k);
+                        a.xyz_cartn *= 2.82;
+                        a.uij_cartn = R3::identity();
+                        a.uij_cartn *= (i == 0) ? 0.02 : 0.008;
+                        a.occupancy = (k == 3) ? 0.5 : 1.0;
+                        mcluster->append(a);
+                    }
+                }
+            }
+        }
+
+
+        void test_value()
+        {
+            QuantityType expected = this->directDebyeSum();
+            QuantityType value = mnufft->eval(mcluster);
+            TS_ASSERT_EQUALS(expected.size(), value.size());
+            TS_ASSERT_EQUALS(60u, value.size());
+            double vmax = 0.0;
+            double dvmax = 0.0;
+            for (size_t i = 0; i < value.size() && i < expected.size(); ++i)
+            {
+                vmax = max(vmax, fabs(expected[i]));
+                dvmax = max(dvmax, fabs(value[i] - expected[i]));
+            }
+            TS_ASSERT_LESS_THAN(0.0, vmax);
+            TS_ASSERT_LESS_THAN(dvmax, 1e-5 * vmax);
+            // coarse precision gives larger deviations
+            mnufft->setNUFFTPrecision(1e-2);
+            value = mnufft->eval(mcluster);
+            double dvmax2 = 0.0;
+            for (size_t i = 0; i < value.size() && i < expected.size(); ++i)
+            {
+                dvmax2 = max(dvmax2, fabs(value[i] - expected[i]));
+            }
+            TS_ASSERT_LESS_THAN(dvmax, dvmax2);
+            TS_ASSERT_LESS_THAN(dvmax2, 1e-1 * vmax);
+        }
+
+
+        void test_getF()
+        {
+            mnufft->setQmin(1.0);
+            mnufft->eval(mcluster);
+            QuantityType fq = mnufft->getF();
+            QuantityType value = mnufft->value();
+            TS_ASSERT_EQUALS(0.0, fq[5]);
+            TS_ASSERT_EQUALS(0.0, value[5]);
+            const int kq = 30;
+            const double q = mnufft->getQgrid()[kq];
+            const ScatteringFactorTablePtr& sftable =
+                mnufft->getScatteringFactorTable();
+            double sfsum = 0.0;
+            double totocc = 0.0;
+            for (const Atom& a : *mcluster)
+            {
+                sfsum += a.occupancy * sftable->lookup(a.atomtype, q);
+                totocc += a.occupancy;
+            }
+            const double sfavg = sfsum / totocc;
+            TS_ASSERT_DELTA(value[kq] / (sfavg * sfavg * totocc), fq[kq],
+                    1e-10 * fabs(fq[kq]));
+        }
+
+
+        void test_grid_memory()
+        {
+            const double gridbytes = mnufft->estimateGridMemory(mcluster);
+            TS_ASSERT_LESS_THAN(0.0, gridbytes);
+            QuantityType value0 = mnufft->eval(mcluster);
+            // 4 species are evaluated with 2 grids in memory
+            mnufft->setMaxGridMemory(2.5 * gridbytes);
+            QuantityType value1 = mnufft->eval(mcluster);
+            TS_ASSERT_EQUALS(value0, value1);
+            mnufft->setMaxGridMemory(1.5 * gridbytes);
+            TS_ASSERT_THROWS(mnufft->eval(mcluster), runtime_error);
+            TS_ASSERT_THROWS(mnufft->setMaxGridMemory(-1), invalid_argument);
+            // grid follows the extent along each axis
+            AtomicStructureAdapterPtr chain =
+                boost::make_shared<AtomicStructureAdapter>();
+            Atom a;
+            a.atomtype = "Na";
+            for (int i = 0; i < 4; ++i)
+            {
+                a.xyz_cartn = R3::Vector(2.82 * i, 0.0, 0.0);
+                chain->append(a);
+            }
+            TS_ASSERT_LESS_THAN(mnufft->estimateGridMemory(chain),
+                    0.2 * gridbytes);
+        }
+
+
+        void test_uisostep()
+        {
+            // every atom has its own Uiso
+            int k = 0;
+            for (Atom& a : *mcluster)
+            {
+                a.uij_cartn += R3::identity() * 1e-6 * (k++);
+            }
+            TS_ASSERT_THROWS(mnufft->eval(mcluster), invalid_argument);
+            mnufft->setUisoStep(1e-3);
+            QuantityType value = mnufft->eval(mcluster);
+            QuantityType expected = this->directDebyeSum();
+            double vmax = 0.0;
+            double dvmax = 0.0;
+            for (size_t i = 0; i < value.size() && i < expected.size(); ++i)
+            {
+                vmax = max(vmax, fabs(expected[i]));
+                dvmax = max(dvmax, fabs(value[i] - expected[i]));
+            }
+            TS_ASSERT_LESS_THAN(dvmax, 2e-3 * vmax);
+            TS_ASSERT_THROWS(mnufft->setUisoStep(-1), invalid_argument);
+        }
+
+
+        void test_invalid_structure()
+        {
+            PeriodicStructureAdapterPtr pstru =
+                boost::make_shared<PeriodicStructureAdapter>();
+            pstru->setLatPar(4, 4, 4, 90, 90, 90);
+            pstru->append(Atom());
+            TS_ASSERT_THROWS(mnufft->eval(pstru), invalid_argument);
+            AtomicStructureAdapterPtr empty =
+                boost::make_shared<AtomicStructureAdapter>();
+            QuantityType value = mnufft->eval(empty);
+            TS_ASSERT_EQUALS(60u, value.size());
+            TS_ASSERT_EQUALS(0.0, *max_element(value.begin(), value.end()));
+        }
+
+};  // class TestNUFFTDebyeSum
+
+// End of file
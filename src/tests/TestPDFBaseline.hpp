@@ -78,6 +78,20 @@ class TestPDFBaseline : public CxxTest::TestSuite
         }
 
 
+        void test_apply()
+        {
+            const double r[] = {0.0, 1.0, 2.0};
+            double y[] = {1.0, 1.0, 1.0};
+            mz->apply(r, y, 3);
+            TS_ASSERT_EQUALS(1.0, y[2]);
+            mcl->setSlope(-2);
+            ml->apply(r, y, 3);
+            TS_ASSERT_EQUALS(1.0, y[0]);
+            TS_ASSERT_EQUALS(-1.0, y[1]);
+            TS_ASSERT_EQUALS(-3.0, y[2]);
+        }
+
+
         void test_serialization()
         {
             mcl->setSlope(0.3);
@@ -16,12 +16,15 @@
 *
 *****************************************************************************/
 
+#include <algorithm>
+#include <thread>
 #include <cxxtest/TestSuite.h>
 
 #include <diffpy/srreal/StructureAdapter.hpp>
 #include <diffpy/srreal/PDFCalculator.hpp>
 #include <diffpy/srreal/JeongPeakWidth.hpp>
 #include <diffpy/srreal/ConstantPeakWidth.hpp>
+#include <diffpy/srreal/CroppedGaussianProfile.hpp>
 #include <diffpy/srreal/QResolutionEnvelope.hpp>
 #include <diffpy/serialization.hpp>
 #include "test_helpers.hpp"
@@ -29,6 +32,32 @@
 using namespace std;
 using namespace diffpy::srreal;
 
+// Local helper classes ------------------------------------------------------
+
+namespace {
+
+/// built-in type that is evaluated through the generic PDF kernel
+template <class T>
+class GenericKernelType : public T
+{
+    public:
+
+        typename T::SharedPtr create() const
+        {
+            return typename T::SharedPtr(new GenericKernelType);
+        }
+
+        typename T::SharedPtr clone() const
+        {
+            return typename T::SharedPtr(new GenericKernelType(*this));
+        }
+
+};
+
+}   // namespace
+
+// ---------------------------------------------------------------------------
+
 class TestPDFCalculator : public CxxTest::TestSuite
 {
     private:
@@ -176,6 +205,181 @@ class TestPDFCalculator : public CxxTest::TestSuite
         }
 
 
+        void test_cachedResults()
+        {
+            StructureAdapterPtr catio3;
+            catio3 = loadTestPeriodicStructure("CaTiO3.stru");
+            mpdfc->setRmax(5.0);
+            mpdfc->setQmax(20);
+            mpdfc->eval(catio3);
+            const QuantityType pdf0 = mpdfc->getPDF();
+            const QuantityType f0 = mpdfc->getF();
+            TS_ASSERT(pdf0 == mpdfc->getPDF());
+            TS_ASSERT(f0 == mpdfc->getF());
+            // envelopes are applied to the cached data
+            mpdfc->setDoubleAttr("scale", 2.0);
+            QuantityType pdf1 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            for (size_t i = 0; i < pdf0.size(); ++i)
+            {
+                TS_ASSERT_EQUALS(2 * pdf0[i], pdf1[i]);
+            }
+            mpdfc->setDoubleAttr("scale", 1.0);
+            // baseline change must invalidate the cache
+            const double slope0 = mpdfc->getDoubleAttr("slope");
+            mpdfc->setDoubleAttr("slope", slope0 - 1.0);
+            TS_ASSERT(pdf0 != mpdfc->getPDF());
+            TS_ASSERT(f0 != mpdfc->getF());
+            mpdfc->setDoubleAttr("slope", slope0);
+            TS_ASSERT(pdf0 == mpdfc->getPDF());
+            // Q-range change must invalidate the cache
+            mpdfc->setQmin(1.0);
+            TS_ASSERT(pdf0 != mpdfc->getPDF());
+            mpdfc->setQmin(0.0);
+            mpdfc->setQmax(10);
+            TS_ASSERT(f0.size() > mpdfc->getF().size());
+            mpdfc->setQmax(20);
+            TS_ASSERT(f0 == mpdfc->getF());
+            // new value must invalidate the cache
+            mpdfc->eval(memptystru);
+            QuantityType pdf2 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(0.0, *min_element(pdf2.begin(), pdf2.end()));
+            TS_ASSERT_EQUALS(0.0, *max_element(pdf2.begin(), pdf2.end()));
+        }
+
+
+        void test_pairKernels()
+        {
+            StructureAdapterPtr catio3;
+            catio3 = loadTestPeriodicStructure("CaTiO3.stru");
+            mpdfc->setRmax(10.0);
+            const double eps = mpdfc->getPeakProfile()->getPrecision();
+            // gaussian profile and jeong peak width
+            mpdfc->eval(catio3);
+            QuantityType pdf0 = mpdfc->getPDF();
+            PeakProfilePtr pkf(new GenericKernelType<GaussianProfile>);
+            pkf->setPrecision(eps);
+            mpdfc->setPeakProfile(pkf);
+            mpdfc->eval(catio3);
+            QuantityType pdf1 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            for (size_t i = 0; i < pdf0.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+            }
+            // cropped gaussian profile and constant peak width
+            mpdfc->setPeakProfileByType("croppedgaussian");
+            mpdfc->setDoubleAttr("peakprecision", eps);
+            mpdfc->setPeakWidthModelByType("constant");
+            mpdfc->setDoubleAttr("width", 0.1);
+            mpdfc->eval(catio3);
+            QuantityType pdf2 = mpdfc->getPDF();
+            pkf.reset(new GenericKernelType<CroppedGaussianProfile>);
+            pkf->setPrecision(eps);
+            mpdfc->setPeakProfile(pkf);
+            PeakWidthModelPtr pwm(new GenericKernelType<ConstantPeakWidth>);
+            pwm->setDoubleAttr("width", 0.1);
+            mpdfc->setPeakWidthModel(pwm);
+            mpdfc->eval(catio3);
+            QuantityType pdf3 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(pdf2.size(), pdf3.size());
+            for (size_t i = 0; i < pdf2.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf2[i], pdf3[i], meps);
+            }
+            TS_ASSERT(pdf0 != pdf2);
+        }
+
+
+        void test_lookupTableProfile()
+        {
+            StructureAdapterPtr catio3;
+            catio3 = loadTestPeriodicStructure("CaTiO3.stru");
+            mpdfc->setRmax(10.0);
+            mpdfc->eval(catio3);
+            QuantityType pdf0 = mpdfc->getPDF();
+            const double eps = mpdfc->getPeakProfile()->getPrecision();
+            mpdfc->setPeakProfileByType("gaussian-lut");
+            mpdfc->setDoubleAttr("peakprecision", eps);
+            mpdfc->eval(catio3);
+            QuantityType pdf1 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            const double gmax = *max_element(pdf0.begin(), pdf0.end());
+            for (size_t i = 0; i < pdf0.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], 1e-4 * gmax);
+            }
+        }
+
+
+        void test_concurrentEval()
+        {
+            const int nthreads = 4;
+            StructureAdapterPtr stru[nthreads];
+            PDFCalculator pdfc[nthreads];
+            QuantityType pdf[nthreads];
+            std::thread workers[nthreads];
+            const char* strufiles[2] = {"CaTiO3.stru", "NaCl.stru"};
+            for (int i = 0; i < nthreads; ++i)
+            {
+                stru[i] = loadTestPeriodicStructure(strufiles[i % 2]);
+                pdfc[i].setRmax(10.0);
+                pdfc[i].setScatteringFactorTableByType(
+                        (i < 2) ? "xray" : "neutron");
+                workers[i] = std::thread([&, i]() {
+                        pdf[i] = pdfc[i].eval(stru[i]);
+                        });
+            }
+            for (int i = 0; i < nthreads; ++i)  workers[i].join();
+            for (int i = 0; i < nthreads; ++i)
+            {
+                PDFCalculator pc;
+                pc.setRmax(10.0);
+                pc.setScatteringFactorTableByType(
+                        (i < 2) ? "xray" : "neutron");
+                TS_ASSERT_EQUALS(pc.eval(stru[i]), pdf[i]);
+            }
+        }
+
+
+        void test_histogramMode()
+        {
+            StructureAdapterPtr catio3;
+            catio3 = loadTestPeriodicStructure("CaTiO3.stru");
+            mpdfc->setRmax(10.0);
+            TS_ASSERT(!mpdfc->getHistogramMode());
+            mpdfc->eval(catio3);
+            QuantityType pdf0 = mpdfc->getPDF();
+            QuantityType rdf0 = mpdfc->getRDF();
+            mpdfc->setHistogramMode(true);
+            TS_ASSERT(mpdfc->getHistogramMode());
+            mpdfc->eval(catio3);
+            QuantityType pdf1 = mpdfc->getPDF();
+            QuantityType rdf1 = mpdfc->getRDF();
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            // interpolation errors are within the peak precision
+            const double eps = mpdfc->getPeakProfile()->getPrecision();
+            const double rdfmax = *max_element(rdf0.begin(), rdf0.end());
+            for (size_t i = 0; i < rdf0.size(); ++i)
+            {
+                TS_ASSERT_DELTA(rdf0[i], rdf1[i], eps * rdfmax);
+            }
+            const double gmax = *max_element(pdf0.begin(), pdf0.end());
+            for (size_t i = 0; i < pdf0.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], eps * gmax);
+            }
+            // histogram mode is preserved in serialization
+            PDFCalculator pdfc1;
+            diffpy::serialization_fromstring(pdfc1,
+                    diffpy::serialization_tostring(*mpdfc));
+            TS_ASSERT(pdfc1.getHistogramMode());
+            mpdfc->setHistogramMode(false);
+            mpdfc->eval(catio3);
+            TS_ASSERT_EQUALS(pdf0, mpdfc->getPDF());
+        }
+
+
         void test_getQgrid()
         {
             TS_ASSERT_EQUALS(1024u, mpdfc->getQgrid().size());
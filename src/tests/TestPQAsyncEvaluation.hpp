@@ -0,0 +1,135 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestPQAsyncEvaluation -- unit tests for PairQuantity::evalAsync,
+*     its progress and cancellation
+*
+*****************************************************************************/
+
+#include <atomic>
+#include <thread>
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/AtomicStructureAdapter.hpp>
+#include <diffpy/srreal/PairCounter.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+namespace {
+
+/// PairCounter that holds pair contributions until released.
+/// It supports the OPTIMIZED evaluator.
+class HeldPairCounter : public PairCounter
+{
+    public:
+
+        HeldPairCounter() : released(false)  { }
+        atomic<bool> released;
+
+    protected:
+
+        virtual void addPairContribution(
+                const BaseBondGenerator& bnds, int summationscale)
+        {
+            while (!released)  this_thread::yield();
+            this->PairCounter::addPairContribution(bnds, summationscale);
+        }
+
+        virtual void stashPartialValue()  { mstash = mvalue; }
+        virtual void restorePartialValue()  { mvalue = mstash; }
+
+    private:
+
+        QuantityType mstash;
+};
+
+}   // namespace
+
+class TestPQAsyncEvaluation : public CxxTest::TestSuite
+{
+    private:
+
+        AtomicStructureAdapterPtr mline100;
+
+    public:
+
+        void setUp()
+        {
+            if (!mline100)
+            {
+                mline100.reset(new AtomicStructureAdapter);
+                Atom a;
+                for (int i = 0; i < 100; ++i)
+                {
+                    a.xyz_cartn = R3::Vector(1.0*i, 0.0, 0.0);
+                    mline100->append(a);
+                }
+            }
+        }
+
+
+        void test_eval()
+        {
+            StructureAdapterPtr catio3 =
+                loadTestPeriodicStructure("CaTiO3.stru");
+            PDFCalculator pdfc0, pdfc1;
+            QuantityType g0 = pdfc0.eval(catio3);
+            PQAsyncEvaluationPtr ae = pdfc1.evalAsync(catio3);
+            const QuantityType& g1 = ae->get();
+            TS_ASSERT(ae->ready());
+            TS_ASSERT_EQUALS(g0, g1);
+            TS_ASSERT_EQUALS(catio3->countSites(),
+                    ae->progress().sitesTotal());
+            TS_ASSERT_EQUALS(catio3->countSites(),
+                    ae->progress().sitesDone());
+            TS_ASSERT_EQUALS(1.0, ae->progress().fraction());
+            // the calculator can be used normally afterwards
+            TS_ASSERT_EQUALS(g0, pdfc1.eval(catio3));
+        }
+
+
+        void test_cancel()
+        {
+            HeldPairCounter pcount;
+            pcount.setEvaluatorType(OPTIMIZED);
+            pcount.setRmax(10.2);
+            pcount.released = true;
+            TS_ASSERT_EQUALS(10 * 100 - 55, pcount(mline100));
+            // cancel a fast update of a shifted atom
+            AtomicStructureAdapterPtr line1(
+                    new AtomicStructureAdapter(*mline100));
+            line1->at(50).xyz_cartn[1] = 3.0;
+            pcount.released = false;
+            PQAsyncEvaluationPtr ae = pcount.evalAsync(line1);
+            ae->cancel();
+            TS_ASSERT(ae->progress().cancelRequested());
+            pcount.released = true;
+            TS_ASSERT_THROWS(ae->get(), PQEvaluationCancelled);
+            TS_ASSERT(ae->ready());
+            TS_ASSERT_LESS_THAN(ae->progress().sitesDone(),
+                    ae->progress().sitesTotal());
+            TS_ASSERT_EQUALS(0.0, pcount.value()[0]);
+            // partial sums are not reused by the next evaluation
+            PairCounter pcount0;
+            pcount0.setRmax(10.2);
+            TS_ASSERT_EQUALS(pcount0(line1), pcount(line1));
+            TS_ASSERT_EQUALS(BASIC, pcount.getEvaluatorTypeUsed());
+        }
+
+};  // class TestPQAsyncEvaluation
+
+// End of file
@@ -0,0 +1,221 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestPQDistributedRunner -- unit tests for distributed evaluation
+*     with socket workers running in child processes
+*
+*****************************************************************************/
+
+#include <csignal>
+#include <sstream>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <cxxtest/TestSuite.h>
+
+#include <boost/make_shared.hpp>
+
+#include <diffpy/srreal/PQDistributedRunner.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+class TestPQDistributedRunner : public CxxTest::TestSuite
+{
+    private:
+
+        StructureAdapterPtr mcatio3;
+        PDFCalculator mpdfc;
+        vector<pid_t> mworkers;
+        vector< boost::shared_ptr<SocketListener> > mlisteners;
+        vector<string> maddresses;
+
+        enum WorkerMode { SERVE, DROPOUT, STALL };
+
+        /// start worker process, which may exit or stop responding
+        /// after receiving a task
+        void startWorker(const string& address, WorkerMode mode=SERVE)
+        {
+            mlisteners.push_back(
+                    boost::make_shared<SocketListener>(address));
+            SocketListener& listener = *mlisteners.back();
+            maddresses.push_back(listener.address());
+            pid_t pid = fork();
+            if (pid == 0)
+            {
+                try {
+                    while (true)
+                    {
+                        PQChannelPtr channel = listener.accept();
+                        if (mode != SERVE)
+                        {
+                            channel->receive();
+                            channel->receive();
+                            if (mode == STALL)  pause();
+                            break;
+                        }
+                        servePQWorker(*channel);
+                    }
+                }
+                catch (...) { }
+                _exit(0);
+            }
+            mworkers.push_back(pid);
+        }
+
+
+        string unixAddress(int idx) const
+        {
+            ostringstream rv;
+            rv << "unix:/tmp/diffpy-pqworker-" << getpid() << '-' << idx;
+            return rv.str();
+        }
+
+
+        double maxRelativeDifference(const QuantityType& v0,
+                const QuantityType& v1) const
+        {
+            TS_ASSERT_EQUALS(v0.size(), v1.size());
+            double vmax = 0.0;
+            double dvmax = 0.0;
+            for (size_t i = 0; i < v0.size() && i < v1.size(); ++i)
+            {
+                vmax = max(vmax, fabs(v0[i]));
+                dvmax = max(dvmax, fabs(v1[i] - v0[i]));
+            }
+            return (vmax > 0.0) ? (dvmax / vmax) : dvmax;
+        }
+
+    public:
+
+        void setUp()
+        {
+            if (!mcatio3)  mcatio3 = loadTestPeriodicStructure("CaTiO3.stru");
+            mpdfc.setRmax(8.0);
+            mworkers.clear();
+            maddresses.clear();
+        }
+
+
+        void tearDown()
+        {
+            for (pid_t pid : mworkers)
+            {
+                kill(pid, SIGTERM);
+                waitpid(pid, NULL, 0);
+            }
+            mlisteners.clear();
+        }
+
+
+        void test_eval()
+        {
+            this->startWorker(this->unixAddress(0));
+            this->startWorker(this->unixAddress(1));
+            this->startWorker("tcp:127.0.0.1:0");
+            PQTransportPtr transport =
+                boost::make_shared<SocketTransport>(maddresses);
+            PQDistributedRunner runner(transport);
+            QuantityType g0 = mpdfc.eval(mcatio3);
+            PDFCalculator pdfc1;
+            pdfc1.setRmax(8.0);
+            QuantityType g1 = runner.eval(pdfc1, mcatio3);
+            TS_ASSERT(runner.getFailedWorkers().empty());
+            TS_ASSERT_LESS_THAN(maxRelativeDifference(g0, g1), 1e-10);
+            TS_ASSERT_LESS_THAN(maxRelativeDifference(
+                        mpdfc.getPDF(), pdfc1.getPDF()), 1e-10);
+            // workers accept repeated evaluations
+            runner.setPartitions(5);
+            g1 = runner.eval(pdfc1);
+            TS_ASSERT_LESS_THAN(maxRelativeDifference(g0, g1), 1e-10);
+        }
+
+
+        void test_worker_failure()
+        {
+            this->startWorker(this->unixAddress(0));
+            this->startWorker(this->unixAddress(1), DROPOUT);
+            PQTransportPtr transport =
+                boost::make_shared<SocketTransport>(maddresses);
+            PQDistributedRunner runner(transport);
+            QuantityType g0 = mpdfc.eval(mcatio3);
+            PDFCalculator pdfc1;
+            pdfc1.setRmax(8.0);
+            QuantityType g1 = runner.eval(pdfc1, mcatio3);
+            TS_ASSERT_EQUALS(1u, runner.getFailedWorkers().size());
+            TS_ASSERT_EQUALS(1, runner.getFailedWorkers().at(0));
+            TS_ASSERT_LESS_THAN(maxRelativeDifference(g0, g1), 1e-10);
+        }
+
+
+        void test_stalled_worker()
+        {
+            this->startWorker(this->unixAddress(0));
+            this->startWorker(this->unixAddress(1), STALL);
+            boost::shared_ptr<SocketTransport> transport =
+                boost::make_shared<SocketTransport>(maddresses);
+            TS_ASSERT_LESS_THAN(0.0, transport->getTimeout());
+            transport->setTimeout(0.5);
+            PQDistributedRunner runner(transport);
+            QuantityType g0 = mpdfc.eval(mcatio3);
+            PDFCalculator pdfc1;
+            pdfc1.setRmax(8.0);
+            QuantityType g1 = runner.eval(pdfc1, mcatio3);
+            TS_ASSERT_EQUALS(1u, runner.getFailedWorkers().size());
+            TS_ASSERT_EQUALS(1, runner.getFailedWorkers().at(0));
+            TS_ASSERT_LESS_THAN(maxRelativeDifference(g0, g1), 1e-10);
+        }
+
+
+        void test_oversized_message()
+        {
+            int fds[2];
+            TS_ASSERT_EQUALS(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+            SocketChannel peer(fds[0]);
+            SocketChannel channel(fds[1]);
+            channel.setMaxMessageSize(10);
+            TS_ASSERT_EQUALS(10u, channel.getMaxMessageSize());
+            peer.send("0123456789");
+            TS_ASSERT_EQUALS("0123456789", channel.receive());
+            peer.send("0123456789A");
+            TS_ASSERT_THROWS(channel.receive(), PQTransportError);
+            // worker closes the channel on a bogus frame length
+            int wfds[2];
+            TS_ASSERT_EQUALS(0, socketpair(AF_UNIX, SOCK_STREAM, 0, wfds));
+            SocketChannel worker(wfds[1]);
+            const unsigned char header[8] = {0x7f, 0xff, 0xff, 0xff};
+            TS_ASSERT_EQUALS(8, write(wfds[0], header, 8));
+            TS_ASSERT_THROWS_NOTHING(servePQWorker(worker));
+            close(wfds[0]);
+        }
+
+
+        void test_no_workers()
+        {
+            vector<string> addresses(1, this->unixAddress(9));
+            PQTransportPtr transport =
+                boost::make_shared<SocketTransport>(addresses);
+            PQDistributedRunner runner(transport);
+            TS_ASSERT_THROWS(runner.eval(mpdfc, mcatio3), PQTransportError);
+            TS_ASSERT_EQUALS(1u, runner.getFailedWorkers().size());
+            vector<string> badaddress(1, "udp:localhost:8000");
+            TS_ASSERT_THROWS(SocketTransport tbad(badaddress),
+                    invalid_argument);
+        }
+
+};  // class TestPQDistributedRunner
+
+// End of file
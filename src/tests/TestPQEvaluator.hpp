@@ -19,7 +19,10 @@
 #include <cxxtest/TestSuite.h>
 
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <functional>
+#include <unistd.h>
 #include <boost/make_shared.hpp>
 
 #include <diffpy/srreal/PQEvaluator.hpp>
@@ -28,6 +31,7 @@
 #include <diffpy/srreal/PairCounter.hpp>
 #include <diffpy/srreal/PDFCalculator.hpp>
 #include <diffpy/srreal/OverlapCalculator.hpp>
+#include <diffpy/srreal/BondCalculator.hpp>
 #include "test_helpers.hpp"
 
 namespace diffpy {
@@ -47,6 +51,52 @@ class BadPairCounter : public PairCounter
         virtual void restorePartialValue()  { }
 };
 
+// pair counter with support for OPTIMIZED evaluation
+
+class OptimizedPairCounter : public PairCounter
+{
+    protected:
+
+        virtual void stashPartialValue()  { mstashedvalue = mvalue; }
+        virtual void restorePartialValue()  { mvalue.swap(mstashedvalue); }
+
+    private:
+
+        QuantityType mstashedvalue;
+};
+
+// calculator that fails after a number of pair contributions
+
+template <class PQ>
+class InterruptedPQ : public PQ
+{
+    public:
+
+        InterruptedPQ() : mcountdown(-1)  { }
+        void interruptAfter(int cnt)  { mcountdown = cnt; }
+
+    protected:
+
+        virtual void addPairContribution(
+                const BaseBondGenerator& bnds, int summationscale)
+        {
+            if (mcountdown-- == 0)  throw runtime_error("interrupted");
+            this->PQ::addPairContribution(bnds, summationscale);
+        }
+
+    private:
+
+        int mcountdown;
+
+        // checkpoint signature needs the calculator serialization
+        friend class boost::serialization::access;
+        template<class Archive>
+            void serialize(Archive& ar, const unsigned int version)
+        {
+            ar & boost::serialization::base_object<PQ>(*this);
+        }
+};
+
 //////////////////////////////////////////////////////////////////////////////
 // class TestPQEvaluator
 //////////////////////////////////////////////////////////////////////////////
@@ -171,6 +221,19 @@ class TestPQEvaluator : public CxxTest::TestSuite
         }
 
 
+        void test_PDF_histogram_mode()
+        {
+            mpdfcb.setHistogramMode(true);
+            mpdfco.setHistogramMode(true);
+            mpdfco.eval(mstru10);
+            TS_ASSERT(allclose(mzeros, this->pdfcdiff(mstru9)));
+            TS_ASSERT_EQUALS(OPTIMIZED, mpdfco.getEvaluatorTypeUsed());
+            mstru10d1->at(0).xyz_cartn[1] = 0.5;
+            TS_ASSERT(allclose(mzeros, this->pdfcdiff(mstru10d1)));
+            TS_ASSERT_EQUALS(OPTIMIZED, mpdfco.getEvaluatorTypeUsed());
+        }
+
+
         void test_PDF_type_mask()
         {
             mpdfcb.setTypeMask("O2-", "all", false);
@@ -288,11 +351,170 @@ class TestPQEvaluator : public CxxTest::TestSuite
             TS_ASSERT_EQUALS(CHECK, badcounter.getEvaluatorTypeUsed());
         }
 
+
+        void test_statistics()
+        {
+            OptimizedPairCounter pc;
+            pc.setEvaluatorType(OPTIMIZED);
+            TS_ASSERT(!pc.getStatisticsEnabled());
+            pc(mstru10);
+            TS_ASSERT_EQUALS(0, pc.getStatistics().evaluations);
+            TS_ASSERT_EQUALS(0, pc.getStatistics().bondsgenerated);
+            pc.setStatisticsEnabled(true);
+            pc.setRmax(3.5);
+            TS_ASSERT_EQUALS(24, pc(mstru10));
+            const PQStatistics& stats = pc.getStatistics();
+            TS_ASSERT_EQUALS(1, stats.evaluations);
+            TS_ASSERT_EQUALS(1, stats.fullevaluations);
+            TS_ASSERT_EQUALS(0, stats.fastupdates);
+            TS_ASSERT_EQUALS(1u, stats.fallbacks.size());
+            TS_ASSERT_EQUALS(1, stats.fallbacks.at("configuration changed"));
+            TS_ASSERT_EQUALS(55, stats.bondsgenerated);
+            TS_ASSERT_EQUALS(21, stats.bondsrejected);
+            TS_ASSERT_EQUALS(24, stats.paircontributions);
+            TS_ASSERT_EQUALS(0, stats.pairsmasked);
+            TS_ASSERT(stats.bondtime >= 0.0);
+            TS_ASSERT(stats.accumulationtime >= 0.0);
+            // fast update touches only pairs of the changed atom
+            pc.resetStatistics();
+            pc(mstru10d1);
+            TS_ASSERT_EQUALS(1, stats.fastupdates);
+            TS_ASSERT_EQUALS(0, stats.fullevaluations);
+            TS_ASSERT_EQUALS(6, stats.paircontributions);
+            // masked pairs are counted
+            pc.resetStatistics();
+            pc.setPairMask(0, 1, false);
+            TS_ASSERT_EQUALS(23, pc(mstru10d1));
+            TS_ASSERT_EQUALS(1, stats.pairsmasked);
+            TS_ASSERT_EQUALS(23, stats.paircontributions);
+            TS_ASSERT_EQUALS(1, stats.fallbacks.at("configuration changed"));
+            // PDFCalculator counts the peak points
+            mpdfco.setStatisticsEnabled(true);
+            mpdfco.eval(mstru10);
+            TS_ASSERT_EQUALS(1, mpdfco.getStatistics().fallbacks.at(
+                        "no previous structure"));
+            TS_ASSERT_LESS_THAN(0, mpdfco.getStatistics().peakpoints);
+            mpdfco.getPDF();
+            TS_ASSERT(mpdfco.getStatistics().postprocessingtime > 0.0);
+        }
+
+
+
+        void test_checkpoint()
+        {
+            ostringstream fnm;
+            fnm << "/tmp/diffpy-checkpoint-" << getpid() << ".dat";
+            const string filename = fnm.str();
+            StructureAdapterPtr catio3 =
+                loadTestPeriodicStructure("CaTiO3.stru");
+            InterruptedPQ<PDFCalculator> pdfc0;
+            pdfc0.setRmax(8.0);
+            pdfc0.setStatisticsEnabled(true);
+            QuantityType g0 = pdfc0.eval(catio3);
+            const long npairs = pdfc0.getStatistics().paircontributions;
+            InterruptedPQ<PDFCalculator> pdfc1;
+            pdfc1.setRmax(8.0);
+            pdfc1.setCheckpointFile(filename);
+            pdfc1.setCheckpointInterval(0.0);
+            pdfc1.interruptAfter(npairs / 2);
+            TS_ASSERT_THROWS(pdfc1.eval(catio3), runtime_error);
+            TS_ASSERT(ifstream(filename.c_str()));
+            // checkpoint holds only a digest of the structure and setup
+            ifstream fpck(filename.c_str(), ios::binary | ios::ate);
+            TS_ASSERT_LESS_THAN(long(fpck.tellg()),
+                    long(pdfc0.getParallelData().size()) + 256);
+            // checkpoint is not used for a different configuration
+            InterruptedPQ<PDFCalculator> pdfc2;
+            pdfc2.setRmax(7.0);
+            pdfc2.setCheckpointFile(filename);
+            pdfc2.setCheckpointInterval(1e6);
+            pdfc2.interruptAfter(0);
+            TS_ASSERT_THROWS(pdfc2.eval(catio3), runtime_error);
+            // non-numeric setup counts as well, full evaluations are
+            // interrupted just before the end
+            InterruptedPQ<PDFCalculator> pdfc2s;
+            pdfc2s.setRmax(8.0);
+            pdfc2s.setScatteringFactorTableByType("electronnumber");
+            pdfc2s.setCheckpointFile(filename);
+            pdfc2s.setCheckpointInterval(1e6);
+            pdfc2s.interruptAfter(npairs - 1);
+            TS_ASSERT_THROWS(pdfc2s.eval(catio3), runtime_error);
+            InterruptedPQ<PDFCalculator> pdfc2h;
+            pdfc2h.setRmax(8.0);
+            pdfc2h.setHistogramMode(true);
+            pdfc2h.setCheckpointFile(filename);
+            pdfc2h.setCheckpointInterval(1e6);
+            pdfc2h.interruptAfter(npairs - 1);
+            TS_ASSERT_THROWS(pdfc2h.eval(catio3), runtime_error);
+            // resumed evaluation gives the identical result
+            InterruptedPQ<PDFCalculator> pdfc3;
+            pdfc3.setRmax(8.0);
+            pdfc3.setCheckpointFile(filename);
+            pdfc3.setStatisticsEnabled(true);
+            QuantityType g3 = pdfc3.eval(catio3);
+            TS_ASSERT_EQUALS(g0, g3);
+            TS_ASSERT_LESS_THAN(pdfc3.getStatistics().paircontributions,
+                    npairs);
+            TS_ASSERT(!ifstream(filename.c_str()));
+            // pending contributions of the histogram mode are saved too
+            PDFCalculator pdfh0;
+            pdfh0.setRmax(8.0);
+            pdfh0.setHistogramMode(true);
+            QuantityType h0 = pdfh0.eval(catio3);
+            InterruptedPQ<PDFCalculator> pdfh1;
+            pdfh1.setRmax(8.0);
+            pdfh1.setHistogramMode(true);
+            pdfh1.setCheckpointFile(filename);
+            pdfh1.setCheckpointInterval(0.0);
+            pdfh1.interruptAfter(300);
+            TS_ASSERT_THROWS(pdfh1.eval(catio3), runtime_error);
+            InterruptedPQ<PDFCalculator> pdfh2;
+            pdfh2.setRmax(8.0);
+            pdfh2.setHistogramMode(true);
+            pdfh2.setCheckpointFile(filename);
+            QuantityType h2 = pdfh2.eval(catio3);
+            TS_ASSERT(!ifstream(filename.c_str()));
+            TS_ASSERT_EQUALS(h0.size(), h2.size());
+            for (size_t i = 0; i < h0.size(); ++i)
+            {
+                TS_ASSERT_DELTA(h0[i], h2[i], 1e-6);
+            }
+            // bond lists are resumed as well
+            BondCalculator bnds;
+            bnds.setRmax(5.0);
+            bnds.setStatisticsEnabled(true);
+            QuantityType d0 = bnds.eval(catio3);
+            const long nbonds = bnds.getStatistics().paircontributions;
+            InterruptedPQ<BondCalculator> bnds0;
+            bnds0.setRmax(5.0);
+            bnds0.setCheckpointFile(filename);
+            bnds0.setCheckpointInterval(0.0);
+            bnds0.interruptAfter(100);
+            TS_ASSERT_THROWS(bnds0.eval(catio3), runtime_error);
+            InterruptedPQ<BondCalculator> bnds1;
+            bnds1.setRmax(5.0);
+            bnds1.setCheckpointFile(filename);
+            bnds1.setStatisticsEnabled(true);
+            QuantityType d1 = bnds1.eval(catio3);
+            const long nresumed = bnds1.getStatistics().paircontributions;
+            TS_ASSERT(!ifstream(filename.c_str()));
+            TS_ASSERT_EQUALS(d0, d1);
+            TS_ASSERT_EQUALS(bnds.sites0(), bnds1.sites0());
+            TS_ASSERT_LESS_THAN(nresumed, nbonds);
+            TS_ASSERT_THROWS(bnds1.setCheckpointInterval(-1),
+                    invalid_argument);
+        }
+
 };  // class TestPQEvaluator
 
 }   // namespace srreal
 }   // namespace diffpy
 
+BOOST_CLASS_EXPORT(diffpy::srreal::InterruptedPQ<
+        diffpy::srreal::PDFCalculator>)
+BOOST_CLASS_EXPORT(diffpy::srreal::InterruptedPQ<
+        diffpy::srreal::BondCalculator>)
+
 using diffpy::srreal::TestPQEvaluator;
 
 // End of file
@@ -24,6 +24,7 @@
 #include <diffpy/srreal/PeakProfile.hpp>
 #include <diffpy/srreal/GaussianProfile.hpp>
 #include <diffpy/srreal/CroppedGaussianProfile.hpp>
+#include <diffpy/srreal/LookupTableProfile.hpp>
 #include "serialization_helpers.hpp"
 
 using namespace std;
@@ -161,6 +162,50 @@ class TestPeakProfile : public CxxTest::TestSuite
             TS_ASSERT_EQUALS((*mpkgcrop)(0.1, 0.2), (*pk2)(0.1, 0.2));
         }
 
+
+        void test_lookupTable()
+        {
+            PeakProfilePtr pklut = PeakProfile::createByType("gaussian-lut");
+            TS_ASSERT_EQUALS("gaussian-lut", pklut->type());
+            TS_ASSERT_EQUALS("croppedgaussian-lut", PeakProfile::createByType(
+                        "croppedgaussian-lut")->clone()->type());
+            TS_ASSERT_EQUALS(2, pklut->namesOfDoubleAttributes().size());
+            const double accuracy = 1e-6;
+            TS_ASSERT_EQUALS(accuracy, pklut->getDoubleAttr("lutaccuracy"));
+            pklut->setPrecision(1e-8);
+            mpkgauss->setPrecision(1e-8);
+            TS_ASSERT_EQUALS(mpkgauss->xboundlo(0.3), pklut->xboundlo(0.3));
+            TS_ASSERT_EQUALS(mpkgauss->xboundhi(0.3), pklut->xboundhi(0.3));
+            const double ymax = (*mpkgauss)(0, 0.3);
+            for (double x = -0.5; x < 0.5; x += 0.00123)
+            {
+                TS_ASSERT_DELTA((*mpkgauss)(x, 0.3), (*pklut)(x, 0.3),
+                        accuracy * ymax);
+            }
+            TS_ASSERT_EQUALS(0.0, (*pklut)(0.0, 0.0));
+            TS_ASSERT_EQUALS(0.0, (*pklut)(1.0, 0.3));
+            // tighter accuracy requires a larger table
+            LookupTableProfile& lut = static_cast<LookupTableProfile&>(*pklut);
+            const int npts = lut.countTablePoints();
+            pklut->setDoubleAttr("lutaccuracy", 1e-8);
+            TS_ASSERT(lut.countTablePoints() > npts);
+            TS_ASSERT_THROWS(pklut->setDoubleAttr("lutaccuracy", 0.0),
+                    invalid_argument);
+            TS_ASSERT_THROWS(pklut->setDoubleAttr("lutaccuracy", 1e-20),
+                    invalid_argument);
+            TS_ASSERT_EQUALS(1e-8, pklut->getDoubleAttr("lutaccuracy"));
+            // clone and serialization
+            PeakProfilePtr pk1 = pklut->clone();
+            PeakProfilePtr pk2 = dumpandload(pklut);
+            TS_ASSERT_EQUALS("gaussian-lut", pk2->type());
+            TS_ASSERT_EQUALS(1e-8, pk2->getDoubleAttr("lutaccuracy"));
+            TS_ASSERT_EQUALS(1e-8, pk2->getPrecision());
+            TS_ASSERT_EQUALS((*pklut)(0.1, 0.2), (*pk1)(0.1, 0.2));
+            TS_ASSERT_EQUALS((*pklut)(0.1, 0.2), (*pk2)(0.1, 0.2));
+            pk1->setPrecision(1e-3);
+            TS_ASSERT(pklut->xboundhi(1) != pk1->xboundhi(1));
+        }
+
 };  // class TestPeakProfile
 
 // End of file
@@ -134,6 +134,35 @@ public:
     }
 
 
+    void test_POD()
+    {
+        R3::Matrix M(
+                0.459631856585519, 0.726448904209060, 0.085844209317482,
+                0.806838095807669, 0.240116998848762, 0.305032463662873,
+                0.019487235483683, 0.580605953831255, 0.726077578738676);
+        R3::Vector v(
+                0.608652521912322, 0.519716469261062, 0.842577887601566);
+        const R3::PODMatrix pM = R3::toPOD(M);
+        const R3::PODVector pv = R3::toPOD(v);
+        TS_ASSERT_EQUALS(M, R3::fromPOD(pM));
+        TS_ASSERT_EQUALS(v, R3::fromPOD(pv));
+        TS_ASSERT(allclose(R3::mxvecproduct(M, v),
+                    R3::fromPOD(R3::mxvecproduct(pM, pv))));
+        TS_ASSERT(allclose(R3::mxvecproduct(v, M),
+                    R3::fromPOD(R3::mxvecproduct(pv, pM))));
+        TS_ASSERT_DELTA(R3::dot(v, R3::mxvecproduct(M, v)),
+                R3::quadform(pM, pv), precision);
+        TS_ASSERT_DELTA(R3::norm(v), R3::norm(pv), precision);
+        R3::Vector w;
+        R3::assign(w, 2.0 * pv - pv);
+        TS_ASSERT(allclose(v, w));
+        // arithmetic is usable in constant expressions
+        constexpr R3::PODVector u = R3::podvector(1, 2, 3);
+        static_assert(R3::dot(u, u + u) == 28, "invalid constexpr dot");
+        TS_ASSERT_EQUALS(32u, sizeof(R3::PODVector));
+    }
+
+
 };  // class TestR3linalg
 
 // End of file
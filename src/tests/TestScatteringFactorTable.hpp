@@ -131,6 +131,32 @@ class TestScatteringFactorTable : public CxxTest::TestSuite
         }
 
 
+        void test_lookupGrid()
+        {
+            msftb = ScatteringFactorTable::createByType("X");
+            QuantityType fc = msftb->lookupGrid("C", 1.0, 0.5, 4);
+            TS_ASSERT_EQUALS(4u, fc.size());
+            for (int i = 0; i < 4; ++i)
+            {
+                TS_ASSERT_EQUALS(msftb->lookup("C", 1.0 + i * 0.5), fc[i]);
+            }
+            TS_ASSERT(msftb->lookupGrid("C", 1.0, 0.5, 0).empty());
+            TS_ASSERT_THROWS(msftb->lookupGrid("C", 1.0, 0.5, -1),
+                    invalid_argument);
+            TS_ASSERT_THROWS(msftb->lookupGrid("", 1.0, 0.5, 4),
+                    invalid_argument);
+            // cached arrays must be updated for custom values
+            const double fc0 = msftb->lookup("C");
+            msftb->setCustomAs("C", "C", 6.3);
+            QuantityType fc1 = msftb->lookupGrid("C", 1.0, 0.5, 4);
+            TS_ASSERT_DELTA(fc[2] * 6.3 / fc0, fc1[2], meps);
+            msftb->resetCustom("C");
+            TS_ASSERT_EQUALS(fc, msftb->lookupGrid("C", 1.0, 0.5, 4));
+            ScatteringFactorTablePtr sftb1 = msftb->clone();
+            TS_ASSERT_EQUALS(fc, sftb1->lookupGrid("C", 1.0, 0.5, 4));
+        }
+
+
         void test_SFTXray()
         {
             msftb = ScatteringFactorTable::createByType("X");
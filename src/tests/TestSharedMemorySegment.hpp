@@ -0,0 +1,176 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestSharedMemorySegment -- unit tests for SharedMemorySegment and
+*     the shared memory merge of parallel PairQuantity results
+*
+*****************************************************************************/
+
+#include <cstring>
+#include <sstream>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/SharedMemorySegment.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/srreal/BondCalculator.hpp>
+#include <diffpy/srreal/OverlapCalculator.hpp>
+#include "test_helpers.hpp"
+#include "serialization_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+class TestSharedMemorySegment : public CxxTest::TestSuite
+{
+    private:
+
+        StructureAdapterPtr mcatio3;
+        StructureAdapterPtr mnacl;
+
+        string segmentName(int idx) const
+        {
+            ostringstream rv;
+            rv << "diffpy-test-" << getpid() << '-' << idx;
+            return rv.str();
+        }
+
+
+        /// evaluate ncpu partitions of pq0 and merge them in pq1.
+        /// The partition at cpuindex 1 is computed in a child process.
+        void mergeSegments(PairQuantity& pq0, PairQuantity& pq1,
+                StructureAdapterPtr stru, int ncpu)
+        {
+            boost::shared_ptr<PairQuantity> ppq0(&pq0, [](PairQuantity*){});
+            for (int cpuindex = 0; cpuindex < ncpu; ++cpuindex)
+            {
+                const string nm = this->segmentName(cpuindex);
+                pid_t pid = (cpuindex == 1) ? fork() : -1;
+                if (pid > 0)
+                {
+                    int status = -1;
+                    waitpid(pid, &status, 0);
+                    TS_ASSERT_EQUALS(0, status);
+                    continue;
+                }
+                int rv = 0;
+                try {
+                    boost::shared_ptr<PairQuantity> pq = dumpandload(ppq0);
+                    pq->setupParallelRun(cpuindex, ncpu);
+                    pq->eval(stru);
+                    pq->writeParallelSegment(nm);
+                }
+                catch (...) {
+                    rv = 1;
+                }
+                if (pid == 0)  _exit(rv);
+                TS_ASSERT_EQUALS(0, rv);
+            }
+            pq1.setStructure(stru);
+            for (int cpuindex = 0; cpuindex < ncpu; ++cpuindex)
+            {
+                pq1.mergeParallelSegment(this->segmentName(cpuindex), ncpu);
+            }
+        }
+
+    public:
+
+        void setUp()
+        {
+            if (!mcatio3)  mcatio3 = loadTestPeriodicStructure("CaTiO3.stru");
+            if (!mnacl)  mnacl = loadTestPeriodicStructure("NaCl.stru");
+        }
+
+
+        void test_segment()
+        {
+            const string nm = this->segmentName(0);
+            SharedMemorySegmentPtr seg0 =
+                SharedMemorySegment::create(nm, 3 * sizeof(double));
+            TS_ASSERT_EQUALS('/' + nm, seg0->name());
+            TS_ASSERT_EQUALS(3 * sizeof(double), seg0->size());
+            double* p0 = static_cast<double*>(seg0->data());
+            p0[0] = 1.0;  p0[1] = 2.0;  p0[2] = 3.0;
+            TS_ASSERT_THROWS(SharedMemorySegment::create(nm, 8),
+                    runtime_error);
+            SharedMemorySegmentPtr seg1 = SharedMemorySegment::open(nm);
+            TS_ASSERT_EQUALS(3 * sizeof(double), seg1->size());
+            const double* p1 = static_cast<const double*>(seg1->data());
+            TS_ASSERT_EQUALS(0, memcmp(p0, p1, 3 * sizeof(double)));
+            seg1->unlink();
+            // mapping remains valid after unlink
+            TS_ASSERT_EQUALS(3.0, p1[2]);
+            TS_ASSERT_THROWS(SharedMemorySegment::open(nm), runtime_error);
+            TS_ASSERT_THROWS(seg0->unlink(), runtime_error);
+            TS_ASSERT_THROWS(SharedMemorySegment::open("a/b"),
+                    invalid_argument);
+        }
+
+
+        void test_merge_pdf()
+        {
+            PDFCalculator pdfc0;
+            pdfc0.setRmax(8.0);
+            QuantityType g0 = pdfc0.eval(mcatio3);
+            PDFCalculator pdfc1;
+            pdfc1.setRmax(8.0);
+            this->mergeSegments(pdfc0, pdfc1, mcatio3, 3);
+            QuantityType g1 = pdfc1.value();
+            TS_ASSERT_EQUALS(g0.size(), g1.size());
+            for (size_t i = 0; i < g0.size(); ++i)
+            {
+                TS_ASSERT_DELTA(g0[i], g1[i], 1e-8);
+            }
+            // segments are removed after the merge
+            TS_ASSERT_THROWS(SharedMemorySegment::open(this->segmentName(0)),
+                    runtime_error);
+            // extra merge is rejected
+            TS_ASSERT_THROWS(pdfc1.mergeParallelData(
+                        pdfc0.getParallelData(), 3), runtime_error);
+        }
+
+
+        void test_merge_bonds()
+        {
+            BondCalculator bnds0;
+            bnds0.setRmax(5.0);
+            QuantityType d0 = bnds0.eval(mnacl);
+            BondCalculator bnds1;
+            bnds1.setRmax(5.0);
+            this->mergeSegments(bnds0, bnds1, mnacl, 3);
+            TS_ASSERT_EQUALS(d0, bnds1.value());
+            TS_ASSERT_EQUALS(bnds0.sites0(), bnds1.sites0());
+            TS_ASSERT_EQUALS(bnds0.sites1(), bnds1.sites1());
+        }
+
+
+        void test_merge_overlap()
+        {
+            OverlapCalculator olc0;
+            olc0.getAtomRadiiTable()->setCustom("Na1+", 1.5);
+            olc0.getAtomRadiiTable()->setCustom("Cl1-", 1.8);
+            olc0.eval(mnacl);
+            OverlapCalculator olc1;
+            olc1.getAtomRadiiTable()->setCustom("Na1+", 1.5);
+            olc1.getAtomRadiiTable()->setCustom("Cl1-", 1.8);
+            this->mergeSegments(olc0, olc1, mnacl, 3);
+            TS_ASSERT_EQUALS(olc0.value().size(), olc1.value().size());
+            TS_ASSERT_DELTA(olc0.totalSquareOverlap(),
+                    olc1.totalSquareOverlap(), 1e-10);
+        }
+
+};  // class TestSharedMemorySegment
+
+// End of file
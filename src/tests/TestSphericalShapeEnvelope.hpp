@@ -77,6 +77,22 @@ class TestSphericalShapeEnvelope : public CxxTest::TestSuite
         }
 
 
+        void test_apply()
+        {
+            const PDFEnvelope& fne = *menvelope;
+            menvelope->setDoubleAttr("spdiameter", 10.0);
+            const double r[] = {0.0, 2.5, 5.0, 9.99, 10.0, 12.0};
+            double y[] = {1.0, 2.0, 2.0, 1.0, 1.0, 3.0};
+            fne.apply(r, y, 6);
+            TS_ASSERT_EQUALS(1.0, y[0]);
+            TS_ASSERT_DELTA(2 * fne(2.5), y[1], 1e-12);
+            TS_ASSERT_DELTA(2 * 0.3125, y[2], 1e-8);
+            TS_ASSERT_DELTA(fne(9.99), y[3], 1e-12);
+            TS_ASSERT_EQUALS(0.0, y[4]);
+            TS_ASSERT_EQUALS(0.0, y[5]);
+        }
+
+
         void test_serialization()
         {
             menvelope->setDoubleAttr("spdiameter", 13.1);
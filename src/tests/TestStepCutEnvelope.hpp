@@ -78,6 +78,23 @@ class TestStepCutEnvelope : public CxxTest::TestSuite
         }
 
 
+        void test_apply()
+        {
+            const PDFEnvelope& fne = *menvelope;
+            const double r[] = {0.0, 1.0, 1.0001, 2.0};
+            double y[] = {3.0, 3.0, 3.0, 3.0};
+            fne.apply(r, y, 4);
+            TS_ASSERT_EQUALS(3.0, y[2]);
+            TS_ASSERT_EQUALS(3.0, y[3]);
+            menvelope->setDoubleAttr("stepcut", 1.0);
+            fne.apply(r, y, 4);
+            TS_ASSERT_EQUALS(3.0, y[0]);
+            TS_ASSERT_EQUALS(3.0, y[1]);
+            TS_ASSERT_EQUALS(0.0, y[2]);
+            TS_ASSERT_EQUALS(0.0, y[3]);
+        }
+
+
         void test_serialization()
         {
             menvelope->setDoubleAttr("stepcut", 13.1);
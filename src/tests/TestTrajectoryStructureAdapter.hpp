@@ -0,0 +1,272 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2016 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestTrajectoryStructureAdapter -- unit tests for trajectory frames
+*     and their averages with TrajectoryAverager
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdint.h>
+#include <unistd.h>
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/TrajectoryStructureAdapter.hpp>
+#include <diffpy/srreal/TrajectoryAverager.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/srreal/StructureDifference.hpp>
+#include "serialization_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+class TestTrajectoryStructureAdapter : public CxxTest::TestSuite
+{
+    private:
+
+        static const int NATOMS = 20;
+        static const int NFRAMES = 7;
+        string mfilename;
+        vector<double> mxyz;
+        AtomicStructureAdapterPtr matoms;
+        TrajectoryStructureAdapterPtr mtraj;
+
+        /// write trajectory header with the specified counts and nbytes
+        /// of zero coordinate data
+        void writeRawTrajectory(uint64_t natoms, uint64_t nframes,
+                size_t nbytes) const
+        {
+            ofstream fp(mfilename.c_str(), ios::binary);
+            const uint64_t counts[2] = {natoms, nframes};
+            fp.write("DPYTRAJ1", 8);
+            fp.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+            fp.write(string(nbytes, '\0').data(), nbytes);
+        }
+
+
+        /// structure of the frame as independent AtomicStructureAdapter
+        AtomicStructureAdapterPtr frameAtoms(int frame) const
+        {
+            AtomicStructureAdapterPtr rv(new AtomicStructureAdapter(*matoms));
+            const double* xyz = &mxyz[3 * NATOMS * frame];
+            for (int i = 0; i < NATOMS; ++i, xyz += 3)
+            {
+                rv->at(i).xyz_cartn = R3::Vector(xyz[0], xyz[1], xyz[2]);
+            }
+            return rv;
+        }
+
+    public:
+
+        void setUp()
+        {
+            ostringstream fnm;
+            fnm << "/tmp/diffpy-trajectory-" << getpid() << ".dat";
+            mfilename = fnm.str();
+            matoms.reset(new AtomicStructureAdapter);
+            Atom a;
+            a.atomtype = "Ni";
+            a.uij_cartn = R3::identity() * 0.005;
+            for (int i = 0; i < NATOMS; ++i)
+            {
+                a.xyz_cartn = R3::Vector(2.5 * (i % 3),
+                        2.5 * ((i / 3) % 3), 2.5 * (i / 9));
+                matoms->append(a);
+            }
+            // every frame moves two atoms
+            mxyz.clear();
+            for (int f = 0; f < NFRAMES; ++f)
+            {
+                for (int i = 0; i < NATOMS; ++i)
+                {
+                    R3::Vector xyz = matoms->at(i).xyz_cartn;
+                    const bool moved = (i == f || i == (3 * f + 5) % NATOMS);
+                    if (moved)  xyz[0] += 0.1 * sin(f + i);
+                    mxyz.insert(mxyz.end(), xyz.begin(), xyz.end());
+                }
+                for (int i = 0; i < NATOMS; ++i)
+                {
+                    const double* pf = &mxyz[3 * NATOMS * f + 3 * i];
+                    matoms->at(i).xyz_cartn =
+                        R3::Vector(pf[0], pf[1], pf[2]);
+                }
+            }
+            TrajectoryFile::create(mfilename, NATOMS, mxyz);
+            TrajectoryFilePtr tf(new TrajectoryFile(mfilename));
+            mtraj.reset(new TrajectoryStructureAdapter(tf, matoms));
+        }
+
+
+        void tearDown()
+        {
+            remove(mfilename.c_str());
+        }
+
+
+        void test_frames()
+        {
+            TS_ASSERT_EQUALS(NFRAMES, mtraj->countFrames());
+            TS_ASSERT_EQUALS(NATOMS, mtraj->countSites());
+            TS_ASSERT_EQUALS(0, mtraj->getFrame());
+            mtraj->setFrame(3);
+            TS_ASSERT_EQUALS(3, mtraj->getFrame());
+            AtomicStructureAdapterPtr a3 = this->frameAtoms(3);
+            for (int i = 0; i < NATOMS; ++i)
+            {
+                TS_ASSERT_EQUALS(a3->siteCartesianPosition(i),
+                        mtraj->siteCartesianPosition(i));
+                TS_ASSERT_EQUALS("Ni", mtraj->siteAtomType(i));
+            }
+            TS_ASSERT_THROWS(mtraj->setFrame(NFRAMES), out_of_range);
+            // clones keep their frame
+            StructureAdapterPtr c3 = mtraj->clone();
+            mtraj->setFrame(4);
+            TS_ASSERT_EQUALS(a3->siteCartesianPosition(4),
+                    c3->siteCartesianPosition(4));
+            // side-by-side difference lists the moved atoms
+            StructureDifference sd = c3->diff(mtraj);
+            TS_ASSERT_EQUALS(StructureDifference::Method::SIDEBYSIDE,
+                    sd.diffmethod);
+            TS_ASSERT_EQUALS(2u, sd.pop0.size());
+            TS_ASSERT_EQUALS(sd.pop0, sd.add1);
+            TS_ASSERT(mtraj->diff(mtraj->clone()).pop0.empty());
+            // serialization stores the current frame
+            TrajectoryStructureAdapterPtr t1 = dumpandload(mtraj);
+            TS_ASSERT_EQUALS(mtraj->siteCartesianPosition(4),
+                    t1->siteCartesianPosition(4));
+            TS_ASSERT_THROWS(t1->setFrame(0), logic_error);
+            // invalid input
+            TrajectoryFilePtr tf = mtraj->getTrajectory();
+            AtomicStructureAdapterPtr a1(new AtomicStructureAdapter);
+            TS_ASSERT_THROWS(TrajectoryStructureAdapter(tf, a1),
+                    invalid_argument);
+            vector<double> xyz(5);
+            TS_ASSERT_THROWS(TrajectoryFile::create(mfilename, 2, xyz),
+                    invalid_argument);
+            TS_ASSERT_THROWS(TrajectoryFile("/tmp/nonexistent/trajectory"),
+                    runtime_error);
+            // header counts that overflow the frame size or int
+            const uint64_t two61 = uint64_t(1) << 61;
+            const uint64_t two32 = uint64_t(1) << 32;
+            this->writeRawTrajectory(1, two61 + 1, 24);
+            TS_ASSERT_THROWS(TrajectoryFile tf1(mfilename), runtime_error);
+            this->writeRawTrajectory(two32 + 1, two61, 0);
+            TS_ASSERT_THROWS(TrajectoryFile tf2(mfilename), runtime_error);
+            this->writeRawTrajectory(two32 + 1, 1, 24);
+            TS_ASSERT_THROWS(TrajectoryFile tf3(mfilename), runtime_error);
+            this->writeRawTrajectory(0, 5, 0);
+            TS_ASSERT_THROWS(TrajectoryFile tf4(mfilename), runtime_error);
+            this->writeRawTrajectory(1, 1, 24);
+            TS_ASSERT_EQUALS(1, TrajectoryFile(mfilename).countFrames());
+        }
+
+
+        void test_optimized_frames()
+        {
+            PDFCalculator pdfc0, pdfc1;
+            pdfc1.setEvaluatorType(OPTIMIZED);
+            pdfc1.setStatisticsEnabled(true);
+            for (int f = 0; f < NFRAMES; ++f)
+            {
+                mtraj->setFrame(f);
+                QuantityType g1 = pdfc1.eval(mtraj);
+                QuantityType g0 = pdfc0.eval(this->frameAtoms(f));
+                TS_ASSERT_EQUALS(g0.size(), g1.size());
+                for (size_t i = 0; i < g0.size(); ++i)
+                {
+                    TS_ASSERT_DELTA(g0[i], g1[i], 1e-8);
+                }
+            }
+            TS_ASSERT_EQUALS(NFRAMES - 1,
+                    pdfc1.getStatistics().fastupdates);
+            // changes of the template do not affect the adapter
+            QuantityType g1 = pdfc1.getPDF();
+            for (int i = 0; i < NATOMS; ++i)
+            {
+                matoms->at(i).uij_cartn = R3::identity() * 0.03;
+            }
+            TS_ASSERT_EQUALS(0.005, mtraj->siteCartesianUij(0)(0, 0));
+            pdfc1.eval(mtraj);
+            TS_ASSERT_EQUALS(g1, pdfc1.getPDF());
+            // new adapter with the changed template is fully evaluated
+            TrajectoryStructureAdapterPtr traj2(
+                    new TrajectoryStructureAdapter(
+                        mtraj->getTrajectory(), matoms));
+            traj2->setFrame(NFRAMES - 1);
+            pdfc1.eval(traj2);
+            QuantityType g2 = pdfc1.getPDF();
+            pdfc0.eval(traj2);
+            QuantityType g0 = pdfc0.getPDF();
+            TS_ASSERT_EQUALS(g0.size(), g2.size());
+            double dgmax = 0.0;
+            for (size_t i = 0; i < g0.size(); ++i)
+            {
+                dgmax = max(dgmax, fabs(g0[i] - g2[i]));
+            }
+            TS_ASSERT_DELTA(0.0, dgmax, 1e-8);
+            TS_ASSERT_DIFFERS(g1, g2);
+        }
+
+
+        void test_average()
+        {
+            PDFCalculator pdfc;
+            pdfc.setEvaluatorType(OPTIMIZED);
+            TrajectoryAverager::ResultFunction getpdf =
+                [](const PairQuantity& pq) {
+                    return static_cast<const PDFCalculator&>(pq).getPDF();
+                };
+            TrajectoryAverager avg;
+            avg.setFrameRange(1, -1);
+            avg.setStride(2);
+            avg.eval(pdfc, *mtraj, getpdf);
+            TS_ASSERT_EQUALS(3, avg.countFrames());
+            // direct average of frames 1, 3, 5
+            PDFCalculator pdfc0;
+            vector<QuantityType> g;
+            for (int f = 1; f < NFRAMES; f += 2)
+            {
+                pdfc0.eval(this->frameAtoms(f));
+                g.push_back(pdfc0.getPDF());
+            }
+            const QuantityType& gm = avg.mean();
+            QuantityType gv = avg.variance();
+            TS_ASSERT_EQUALS(g[0].size(), gm.size());
+            for (size_t i = 0; i < gm.size(); ++i)
+            {
+                const double m = (g[0][i] + g[1][i] + g[2][i]) / 3;
+                const double v = (pow(g[0][i] - m, 2) +
+                        pow(g[1][i] - m, 2) + pow(g[2][i] - m, 2)) / 3;
+                TS_ASSERT_DELTA(m, gm[i], 1e-8);
+                TS_ASSERT_DELTA(v, gv[i], 1e-8);
+            }
+            // parallel blocks give the same statistics
+            avg.setBlocks(2);
+            avg.eval(pdfc, *mtraj, getpdf);
+            TS_ASSERT_EQUALS(3, avg.countFrames());
+            for (size_t i = 0; i < gm.size(); ++i)
+            {
+                TS_ASSERT_DELTA(gm[i], avg.mean()[i], 1e-10);
+                TS_ASSERT_DELTA(gv[i], avg.variance()[i], 1e-10);
+            }
+            TS_ASSERT_THROWS(avg.setStride(0), invalid_argument);
+            TS_ASSERT_THROWS(avg.setBlocks(0), invalid_argument);
+        }
+
+};  // class TestTrajectoryStructureAdapter
+
+// End of file
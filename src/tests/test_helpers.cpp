@@ -19,6 +19,9 @@
 #include <fstream>
 #include <sstream>
 #include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <boost/make_shared.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
@@ -138,4 +141,67 @@ diffpy::srreal::StructureAdapterPtr
     return pstru;
 }
 
+// Structures used in several tests -----------------------------------------
+
+diffpy::srreal::PeriodicStructureAdapterPtr
+    makeNickelStructure(double uiso)
+{
+    using namespace diffpy::srreal;
+    PeriodicStructureAdapterPtr rv =
+        boost::make_shared<PeriodicStructureAdapter>();
+    rv->setLatPar(3.52, 3.52, 3.52, 90, 90, 90);
+    const double fcc[4][3] = {
+        {0, 0, 0}, {0.5, 0.5, 0}, {0.5, 0, 0.5}, {0, 0.5, 0.5}};
+    for (int i = 0; i < 4; ++i)
+    {
+        Atom a;
+        a.atomtype = "Ni";
+        a.xyz_cartn = R3::Vector(fcc[i][0], fcc[i][1], fcc[i][2]);
+        a.uij_cartn = R3::identity();
+        a.uij_cartn *= uiso;
+        rv->toCartesian(a);
+        rv->append(a);
+    }
+    return rv;
+}
+
+
+diffpy::srreal::PeriodicStructureAdapterPtr
+    expandToP1(const diffpy::srreal::CrystalStructureAdapter& cstru)
+{
+    using namespace diffpy::srreal;
+    PeriodicStructureAdapterPtr rv =
+        boost::make_shared<PeriodicStructureAdapter>();
+    const Lattice& L = cstru.getLattice();
+    rv->setLatPar(L.a(), L.b(), L.c(), L.alpha(), L.beta(), L.gamma());
+    for (int i = 0; i < cstru.countSites(); ++i)
+    {
+        const CrystalStructureAdapter::AtomVector& eq =
+            cstru.getEquivalentAtoms(i);
+        rv->insert(rv->end(), eq.begin(), eq.end());
+    }
+    return rv;
+}
+
+// Array comparisons ---------------------------------------------------------
+
+double maxAbsValue(const diffpy::srreal::QuantityType& y)
+{
+    double rv = 0.0;
+    for (size_t i = 0; i < y.size(); ++i)  rv = std::max(rv, fabs(y[i]));
+    return rv;
+}
+
+
+double maxAbsDifference(const diffpy::srreal::QuantityType& y0,
+        const diffpy::srreal::QuantityType& y1)
+{
+    double rv = 0.0;
+    for (size_t i = 0; i < y0.size() && i < y1.size(); ++i)
+    {
+        rv = std::max(rv, fabs(y1[i] - y0[i]));
+    }
+    return rv;
+}
+
 // End of test_helpers.cpp
@@ -21,6 +21,8 @@
 
 #include <string>
 #include <diffpy/srreal/forwardtypes.hpp>
+#include <diffpy/srreal/CrystalStructureAdapter.hpp>
+#include <diffpy/srreal/QuantityType.hpp>
 
 std::string prepend_tests_dir(const std::string& f);
 std::string prepend_testdata_dir(const std::string& f);
@@ -28,4 +30,19 @@ std::string prepend_testdata_dir(const std::string& f);
 diffpy::srreal::StructureAdapterPtr
     loadTestPeriodicStructure(const std::string& tailname);
 
+/// fcc nickel in a 3.52 A cubic cell with isotropic displacements uiso
+diffpy::srreal::PeriodicStructureAdapterPtr
+    makeNickelStructure(double uiso);
+
+/// P1 structure with all symmetry images of the crystal sites
+diffpy::srreal::PeriodicStructureAdapterPtr
+    expandToP1(const diffpy::srreal::CrystalStructureAdapter& cstru);
+
+/// largest absolute value in the array
+double maxAbsValue(const diffpy::srreal::QuantityType& y);
+
+/// largest absolute difference over the common length of two arrays
+double maxAbsDifference(const diffpy::srreal::QuantityType& y0,
+        const diffpy::srreal::QuantityType& y1);
+
 #endif  // TEST_HELPERS_HPP_INCLUDED